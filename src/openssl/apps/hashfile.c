@@ -0,0 +1,92 @@
+/*
+ * Copyright 2020 The OpenSSL Project Authors. All Rights Reserved.
+ *
+ * Licensed under the OpenSSL license (the "License").  You may not use
+ * this file except in compliance with the License.  You can obtain a copy
+ * in the file LICENSE in the source distribution or at
+ * https://www.openssl.org/source/license.html
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include "apps.h"
+#include "progs.h"
+#include <openssl/err.h>
+#include <openssl/x509.h>
+#include <openssl/x509_vfy.h>
+
+typedef enum OPTION_choice {
+    OPT_ERR = -1, OPT_EOF = 0, OPT_HELP,
+    OPT_INFORM, OPT_OUT, OPT_VERBOSE
+} OPTION_CHOICE;
+
+const OPTIONS hashfile_options[] = {
+    {OPT_HELP_STR, 1, '-', "Usage: %s [options] [cert-file...]\n"},
+    {OPT_HELP_STR, 1, '-', "Valid options are:\n"},
+    {"help", OPT_HELP, '-', "Display this summary"},
+    {"inform", OPT_INFORM, 'F', "Input format - default PEM (DER or PEM)"},
+    {"out", OPT_OUT, '>', "Output file"},
+    {"verbose", OPT_VERBOSE, '-', "Print the number of certificates written"},
+    {NULL}
+};
+
+int hashfile_main(int argc, char **argv)
+{
+    BIO *out = NULL;
+    STACK_OF(X509) *certs = NULL;
+    OPTION_CHOICE o;
+    int informat = FORMAT_PEM, verbose = 0, ret = 1, i;
+    char *outfile = NULL, *prog;
+
+    prog = opt_init(argc, argv, hashfile_options);
+    while ((o = opt_next()) != OPT_EOF) {
+        switch (o) {
+        case OPT_EOF:
+        case OPT_ERR:
+            BIO_printf(bio_err, "%s: Use -help for summary.\n", prog);
+            goto end;
+        case OPT_HELP:
+            ret = 0;
+            opt_help(hashfile_options);
+            goto end;
+        case OPT_INFORM:
+            if (!opt_format(opt_arg(), OPT_FMT_PEMDER, &informat))
+                goto end;
+            break;
+        case OPT_OUT:
+            outfile = opt_arg();
+            break;
+        case OPT_VERBOSE:
+            verbose = 1;
+            break;
+        }
+    }
+    argc = opt_num_rest();
+    argv = opt_rest();
+
+    if (argc == 0) {
+        if (!load_certs(NULL, &certs, informat, NULL, "certificates"))
+            goto end;
+    } else {
+        for (i = 0; i < argc; i++)
+            if (!load_certs(argv[i], &certs, informat, NULL, "certificates"))
+                goto end;
+    }
+
+    out = bio_open_default(outfile, 'w', FORMAT_BINARY);
+    if (out == NULL)
+        goto end;
+    if (!X509_hash_file_write_bio(out, certs)) {
+        BIO_printf(bio_err, "%s: Error writing hashed certificate file\n",
+                   prog);
+        ERR_print_errors(bio_err);
+        goto end;
+    }
+    if (verbose)
+        BIO_printf(bio_err, "%d certificates written\n", sk_X509_num(certs));
+    ret = 0;
+ end:
+    BIO_free_all(out);
+    sk_X509_pop_free(certs, X509_free);
+    return ret;
+}
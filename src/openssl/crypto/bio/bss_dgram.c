@@ -7,12 +7,23 @@
  * https://www.openssl.org/source/license.html
  */
 
+#ifndef _GNU_SOURCE
+# define _GNU_SOURCE            /* for recvmmsg() and sendmmsg() */
+#endif
+
 #include <stdio.h>
 #include <errno.h>
 
 #include "bio_local.h"
 #ifndef OPENSSL_NO_DGRAM
 
+# if defined(OPENSSL_SYS_LINUX) && defined(MSG_WAITFORONE)
+#  define OPENSSL_DGRAM_MMSG
+#  include <netinet/udp.h>
+/* Largest UDP payload, which bounds a batch sent with UDP GSO too */
+#  define DGRAM_BATCH_BUFSIZE     65507
+# endif
+
 # ifndef OPENSSL_NO_SCTP
 #  include <netinet/sctp.h>
 #  include <fcntl.h>
@@ -99,6 +110,25 @@ static const BIO_METHOD methods_dgramp_sctp = {
 };
 # endif
 
+# ifdef OPENSSL_DGRAM_MMSG
+/*
+ * Datagrams moved by a single recvmmsg() or sendmmsg() call.  Received
+ * datagrams each have a slot of |buflen| / |num| bytes, datagrams waiting to
+ * be sent are packed back to back in |buf|, |used| bytes in all.
+ */
+typedef struct bio_dgram_batch_st {
+    unsigned char *buf;
+    size_t buflen;
+    size_t used;
+    struct mmsghdr *msg;
+    struct iovec *iov;
+    BIO_ADDR *addr;
+    unsigned int num;
+    unsigned int first;         /* next datagram to read or send */
+    unsigned int count;         /* datagrams held from |first| on */
+} bio_dgram_batch;
+# endif
+
 typedef struct bio_dgram_data_st {
     BIO_ADDR peer;
     unsigned int connected;
@@ -107,6 +137,12 @@ typedef struct bio_dgram_data_st {
     struct timeval next_timeout;
     struct timeval socket_timeout;
     unsigned int peekmode;
+# ifdef OPENSSL_DGRAM_MMSG
+    unsigned int batch;         /* datagrams per system call, 0 for one */
+    bio_dgram_batch rx;
+    bio_dgram_batch tx;
+    int gso;                    /* UDP GSO: 1 usable, -1 not, 0 unknown */
+# endif
 } bio_dgram_data;
 
 # ifndef OPENSSL_NO_SCTP
@@ -160,6 +196,35 @@ static int dgram_new(BIO *bi)
     return 1;
 }
 
+# ifdef OPENSSL_DGRAM_MMSG
+static void dgram_batch_free(bio_dgram_batch *batch)
+{
+    OPENSSL_free(batch->buf);
+    OPENSSL_free(batch->msg);
+    OPENSSL_free(batch->iov);
+    OPENSSL_free(batch->addr);
+    memset(batch, 0, sizeof(*batch));
+}
+
+static int dgram_batch_alloc(bio_dgram_batch *batch, unsigned int num,
+                             size_t buflen)
+{
+    dgram_batch_free(batch);
+    batch->buf = OPENSSL_malloc(buflen);
+    batch->msg = OPENSSL_zalloc(num * sizeof(*batch->msg));
+    batch->iov = OPENSSL_malloc(num * sizeof(*batch->iov));
+    batch->addr = OPENSSL_zalloc(num * sizeof(*batch->addr));
+    if (batch->buf == NULL || batch->msg == NULL || batch->iov == NULL
+            || batch->addr == NULL) {
+        dgram_batch_free(batch);
+        return 0;
+    }
+    batch->buflen = buflen;
+    batch->num = num;
+    return 1;
+}
+# endif
+
 static int dgram_free(BIO *a)
 {
     bio_dgram_data *data;
@@ -170,6 +235,10 @@ static int dgram_free(BIO *a)
         return 0;
 
     data = (bio_dgram_data *)a->ptr;
+# ifdef OPENSSL_DGRAM_MMSG
+    dgram_batch_free(&data->rx);
+    dgram_batch_free(&data->tx);
+# endif
     OPENSSL_free(data);
 
     return 1;
@@ -294,6 +363,66 @@ static void dgram_reset_rcv_timeout(BIO *b)
 # endif
 }
 
+# ifdef OPENSSL_DGRAM_MMSG
+/*
+ * Receive up to |batch| datagrams of up to |outl| bytes each with one
+ * recvmmsg() call and hand them out one per read.
+ */
+static int dgram_read_batch(BIO *b, char *out, int outl)
+{
+    bio_dgram_data *data = (bio_dgram_data *)b->ptr;
+    bio_dgram_batch *rx = &data->rx;
+    size_t slot;
+    unsigned int i;
+    int ret;
+
+    BIO_clear_retry_flags(b);
+    if (rx->count == 0) {
+        slot = rx->num > 0 ? rx->buflen / rx->num : 0;
+        if (slot < (size_t)outl
+                && !dgram_batch_alloc(rx, data->batch,
+                                      (size_t)outl * data->batch))
+            return -1;
+        slot = rx->buflen / rx->num;
+        for (i = 0; i < rx->num; i++) {
+            rx->iov[i].iov_base = rx->buf + i * slot;
+            rx->iov[i].iov_len = slot;
+            memset(&rx->msg[i], 0, sizeof(rx->msg[i]));
+            rx->msg[i].msg_hdr.msg_iov = &rx->iov[i];
+            rx->msg[i].msg_hdr.msg_iovlen = 1;
+            rx->msg[i].msg_hdr.msg_name = BIO_ADDR_sockaddr_noconst(&rx->addr[i]);
+            rx->msg[i].msg_hdr.msg_namelen = sizeof(rx->addr[i]);
+        }
+
+        clear_socket_error();
+        dgram_adjust_rcv_timeout(b);
+        ret = recvmmsg(b->num, rx->msg, rx->num, MSG_WAITFORONE, NULL);
+        dgram_reset_rcv_timeout(b);
+        if (ret <= 0) {
+            if (BIO_dgram_should_retry(ret)) {
+                BIO_set_retry_read(b);
+                data->_errno = get_last_socket_error();
+            }
+            return ret;
+        }
+        rx->first = 0;
+        rx->count = ret;
+    }
+
+    i = rx->first;
+    ret = rx->msg[i].msg_len < (unsigned int)outl ? (int)rx->msg[i].msg_len
+                                                   : outl;
+    memcpy(out, rx->iov[i].iov_base, ret);
+    if (!data->connected)
+        BIO_ctrl(b, BIO_CTRL_DGRAM_SET_PEER, 0, &rx->addr[i]);
+    if (!data->peekmode) {
+        rx->first++;
+        rx->count--;
+    }
+    return ret;
+}
+# endif
+
 static int dgram_read(BIO *b, char *out, int outl)
 {
     int ret = 0;
@@ -303,6 +432,11 @@ static int dgram_read(BIO *b, char *out, int outl)
     BIO_ADDR peer;
     socklen_t len = sizeof(peer);
 
+# ifdef OPENSSL_DGRAM_MMSG
+    if (out != NULL && data->batch > 0)
+        return dgram_read_batch(b, out, outl);
+# endif
+
     if (out != NULL) {
         clear_socket_error();
         memset(&peer, 0, sizeof(peer));
@@ -328,10 +462,188 @@ static int dgram_read(BIO *b, char *out, int outl)
     return ret;
 }
 
+# ifdef OPENSSL_DGRAM_MMSG
+#  ifdef UDP_SEGMENT
+/* Can the socket send several datagrams at once with UDP GSO? */
+static int dgram_gso_usable(BIO *b, bio_dgram_data *data)
+{
+#   ifdef SO_PROTOCOL
+    int proto = 0;
+    socklen_t len = sizeof(proto);
+
+    /* The cmsg is silently ignored by other protocols, so check it's UDP */
+    if (data->gso == 0)
+        data->gso = getsockopt(b->num, SOL_SOCKET, SO_PROTOCOL, &proto, &len)
+                    == 0 && proto == IPPROTO_UDP ? 1 : -1;
+    return data->gso > 0;
+#   else
+    return 0;
+#   endif
+}
+
+/*
+ * Send a run of queued datagrams for the same peer with a single sendmsg()
+ * and let the kernel split it.  All of them except the last must have the
+ * same size, and the last can't be larger.  Returns the number of datagrams
+ * sent, 0 if there is no such run or -1 on error.
+ */
+static int dgram_send_gso(BIO *b, bio_dgram_data *data)
+{
+    bio_dgram_batch *tx = &data->tx;
+    struct msghdr *first = &tx->msg[tx->first].msg_hdr, *next;
+    size_t seg = tx->iov[tx->first].iov_len, total = seg;
+    union {
+        char buf[CMSG_SPACE(sizeof(uint16_t))];
+        struct cmsghdr align;
+    } cbuf;
+    struct cmsghdr *cmsg;
+    struct msghdr msg;
+    struct iovec iov;
+    unsigned int n;
+    int err;
+
+    if (tx->count < 2 || !dgram_gso_usable(b, data))
+        return 0;
+    for (n = 1; n < tx->count; n++) {
+        next = &tx->msg[tx->first + n].msg_hdr;
+        if (next->msg_iov[0].iov_len > seg
+                || next->msg_namelen != first->msg_namelen
+                || (first->msg_name != NULL
+                    && memcmp(next->msg_name, first->msg_name,
+                              first->msg_namelen) != 0))
+            break;
+        total += next->msg_iov[0].iov_len;
+        if (next->msg_iov[0].iov_len < seg) {
+            n++;
+            break;
+        }
+    }
+    if (n < 2)
+        return 0;
+
+    iov.iov_base = first->msg_iov[0].iov_base;
+    iov.iov_len = total;
+    memset(&msg, 0, sizeof(msg));
+    msg.msg_name = first->msg_name;
+    msg.msg_namelen = first->msg_namelen;
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = cbuf.buf;
+    msg.msg_controllen = sizeof(cbuf.buf);
+    memset(&cbuf, 0, sizeof(cbuf));
+    cmsg = CMSG_FIRSTHDR(&msg);
+    cmsg->cmsg_level = IPPROTO_UDP;
+    cmsg->cmsg_type = UDP_SEGMENT;
+    cmsg->cmsg_len = CMSG_LEN(sizeof(uint16_t));
+    *(uint16_t *)CMSG_DATA(cmsg) = (uint16_t)seg;
+
+    if (sendmsg(b->num, &msg, 0) >= 0)
+        return n;
+    err = get_last_socket_error();
+    if (BIO_dgram_non_fatal_error(err))
+        return -1;
+    /*
+     * Let sendmmsg() report errors about the datagrams themselves.  Anything
+     * else means the kernel or the device can't do GSO.
+     */
+    if (err != EMSGSIZE)
+        data->gso = -1;
+    return 0;
+}
+#  endif
+
+/*
+ * Send the queued datagrams.  A datagram the kernel refuses is dropped, as
+ * it would be if it got lost on the way.
+ */
+static int dgram_flush_batch(BIO *b)
+{
+    bio_dgram_data *data = (bio_dgram_data *)b->ptr;
+    bio_dgram_batch *tx = &data->tx;
+    int ret;
+
+    BIO_clear_retry_flags(b);
+    while (tx->count > 0) {
+        clear_socket_error();
+#  ifdef UDP_SEGMENT
+        ret = dgram_send_gso(b, data);
+        if (ret == 0)
+#  endif
+            ret = sendmmsg(b->num, &tx->msg[tx->first], tx->count, 0);
+        if (ret <= 0) {
+            data->_errno = get_last_socket_error();
+            if (BIO_dgram_should_retry(ret)) {
+                BIO_set_retry_write(b);
+                return -1;
+            }
+            tx->first++;
+            if (--tx->count == 0) {
+                tx->first = 0;
+                tx->used = 0;
+            }
+            return 0;
+        }
+        tx->first += ret;
+        tx->count -= ret;
+    }
+    tx->first = 0;
+    tx->used = 0;
+    return 1;
+}
+
+/* Queue a datagram to be sent by the next sendmmsg() */
+static int dgram_write_batch(BIO *b, const char *in, int inl)
+{
+    bio_dgram_data *data = (bio_dgram_data *)b->ptr;
+    bio_dgram_batch *tx = &data->tx;
+    struct msghdr *msg;
+    unsigned int i;
+
+    if (tx->buf == NULL
+            && !dgram_batch_alloc(tx, data->batch, DGRAM_BATCH_BUFSIZE))
+        return -1;
+    /* A datagram dropped by the flush doesn't fail this write */
+    while (tx->first + tx->count == tx->num || tx->used + inl > tx->buflen) {
+        if (dgram_flush_batch(b) < 0)
+            return -1;
+    }
+
+    i = tx->first + tx->count;
+    memcpy(tx->buf + tx->used, in, inl);
+    tx->iov[i].iov_base = tx->buf + tx->used;
+    tx->iov[i].iov_len = inl;
+    msg = &tx->msg[i].msg_hdr;
+    memset(msg, 0, sizeof(*msg));
+    msg->msg_iov = &tx->iov[i];
+    msg->msg_iovlen = 1;
+    if (!data->connected) {
+        tx->addr[i] = data->peer;
+        msg->msg_name = BIO_ADDR_sockaddr_noconst(&tx->addr[i]);
+        msg->msg_namelen = BIO_ADDR_sockaddr_size(&tx->addr[i]);
+    }
+    tx->used += inl;
+    tx->count++;
+    BIO_clear_retry_flags(b);
+    return inl;
+}
+# endif
+
 static int dgram_write(BIO *b, const char *in, int inl)
 {
     int ret;
     bio_dgram_data *data = (bio_dgram_data *)b->ptr;
+
+# ifdef OPENSSL_DGRAM_MMSG
+    if (data->batch > 0) {
+        if (inl <= DGRAM_BATCH_BUFSIZE)
+            return dgram_write_batch(b, in, inl);
+        /* Too large to queue, send it on its own after the queued ones */
+        while (data->tx.count > 0) {
+            if (dgram_flush_batch(b) < 0)
+                return -1;
+        }
+    }
+# endif
     clear_socket_error();
 
     if (data->connected)
@@ -421,6 +733,13 @@ static long dgram_ctrl(BIO *b, int cmd, long num, void *ptr)
         b->num = *((int *)ptr);
         b->shutdown = (int)num;
         b->init = 1;
+# ifdef OPENSSL_DGRAM_MMSG
+        /* Whatever was queued belongs to the old socket */
+        data->rx.first = data->rx.count = 0;
+        data->tx.first = data->tx.count = 0;
+        data->tx.used = 0;
+        data->gso = 0;
+# endif
         break;
     case BIO_C_GET_FD:
         if (b->init) {
@@ -438,13 +757,32 @@ static long dgram_ctrl(BIO *b, int cmd, long num, void *ptr)
         b->shutdown = (int)num;
         break;
     case BIO_CTRL_PENDING:
+        ret = 0;
+# ifdef OPENSSL_DGRAM_MMSG
+        {
+            unsigned int i;
+
+            for (i = 0; i < data->rx.count; i++)
+                ret += data->rx.msg[data->rx.first + i].msg_len;
+        }
+# endif
+        break;
     case BIO_CTRL_WPENDING:
+        /*
+         * Queued datagrams are sent as they are, they don't take room from
+         * the next one.  dtls1_do_write() relies on this.
+         */
         ret = 0;
         break;
     case BIO_CTRL_DUP:
-    case BIO_CTRL_FLUSH:
         ret = 1;
         break;
+    case BIO_CTRL_FLUSH:
+# ifdef OPENSSL_DGRAM_MMSG
+        if (data->tx.count > 0)
+            ret = dgram_flush_batch(b);
+# endif
+        break;
     case BIO_CTRL_DGRAM_CONNECT:
         BIO_ADDR_make(&data->peer, BIO_ADDR_sockaddr((BIO_ADDR *)ptr));
         break;
@@ -778,6 +1116,28 @@ static long dgram_ctrl(BIO *b, int cmd, long num, void *ptr)
     case BIO_CTRL_DGRAM_GET_MTU_OVERHEAD:
         ret = dgram_get_mtu_overhead(data);
         break;
+    case BIO_CTRL_DGRAM_SET_BATCH:
+# ifdef OPENSSL_DGRAM_MMSG
+        /* Received datagrams can't be dropped, queued ones are sent first */
+        if (num < 0 || num > BIO_DGRAM_MAX_BATCH || data->rx.count > 0
+                || (data->tx.count > 0 && dgram_flush_batch(b) <= 0)) {
+            ret = 0;
+            break;
+        }
+        dgram_batch_free(&data->rx);
+        dgram_batch_free(&data->tx);
+        data->batch = (unsigned int)num;
+# else
+        ret = num == 0;
+# endif
+        break;
+    case BIO_CTRL_DGRAM_GET_BATCH:
+# ifdef OPENSSL_DGRAM_MMSG
+        ret = data->batch;
+# else
+        ret = 0;
+# endif
+        break;
 
     /*
      * BIO_CTRL_DGRAM_SCTP_SET_IN_HANDSHAKE is used here for compatibility
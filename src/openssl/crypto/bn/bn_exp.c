@@ -1126,6 +1126,191 @@ int BN_mod_exp_mont_consttime(BIGNUM *rr, const BIGNUM *a, const BIGNUM *p,
     return ret;
 }
 
+/*
+ * Fixed-base exponentiation with the comb method of Lim and Lee.  An
+ * exponent of up to |bits| bits is written as BN_COMB_ROWS rows of |cols|
+ * bits each, and for every five rows a table holds the 32 products of the
+ * powers of g that those rows stand for.  g^p then takes |cols| squarings
+ * and BN_COMB_TABLES * |cols| multiplications, whatever the base.  The
+ * tables have the layout of the window 5 table of
+ * BN_mod_exp_mont_consttime() and are read in the same constant-time way;
+ * they are not written to after bn_comb_ctx_new(), so one BN_COMB_CTX can
+ * be used by many threads at once.
+ */
+#define BN_COMB_TABLES  4
+#define BN_COMB_ROWS    (5 * BN_COMB_TABLES)
+
+struct bn_comb_ctx_st {
+    BN_MONT_CTX *mont;
+    int top;
+    int bits;                   /* longest exponent, BN_COMB_ROWS * cols */
+    int cols;
+    size_t tablelen;            /* bytes in each table */
+    unsigned char *tables;
+    unsigned char *tablesFree;  /* |tables| before alignment */
+};
+
+void bn_comb_ctx_free(BN_COMB_CTX *comb)
+{
+    if (comb == NULL)
+        return;
+    BN_MONT_CTX_free(comb->mont);
+    OPENSSL_free(comb->tablesFree);
+    OPENSSL_free(comb);
+}
+
+BN_COMB_CTX *bn_comb_ctx_new(const BIGNUM *g, const BIGNUM *m, int bits,
+                             BN_CTX *ctx)
+{
+    BN_COMB_CTX *comb;
+    BIGNUM *base[5], *t;
+    unsigned char *table;
+    int i, j, k, e;
+
+    if (!BN_is_odd(m)) {
+        BNerr(BN_F_BN_COMB_CTX_NEW, BN_R_CALLED_WITH_EVEN_MODULUS);
+        return NULL;
+    }
+    if (bits <= 0) {
+        BNerr(BN_F_BN_COMB_CTX_NEW, BN_R_INVALID_LENGTH);
+        return NULL;
+    }
+
+    if ((comb = OPENSSL_zalloc(sizeof(*comb))) == NULL) {
+        BNerr(BN_F_BN_COMB_CTX_NEW, ERR_R_MALLOC_FAILURE);
+        return NULL;
+    }
+    comb->top = m->top;
+    comb->cols = (bits + BN_COMB_ROWS - 1) / BN_COMB_ROWS;
+    comb->bits = comb->cols * BN_COMB_ROWS;
+    comb->tablelen = (size_t)comb->top * sizeof(BN_ULONG) * 32;
+    /* MOD_EXP_CTIME_COPY_TO_PREBUF() needs the tables zeroed */
+    comb->tablesFree = OPENSSL_zalloc(BN_COMB_TABLES * comb->tablelen
+                                      + MOD_EXP_CTIME_MIN_CACHE_LINE_WIDTH);
+    if (comb->tablesFree == NULL) {
+        BNerr(BN_F_BN_COMB_CTX_NEW, ERR_R_MALLOC_FAILURE);
+        OPENSSL_free(comb);
+        return NULL;
+    }
+    comb->tables = MOD_EXP_CTIME_ALIGN(comb->tablesFree);
+
+    BN_CTX_start(ctx);
+    for (i = 0; i < 5; i++)
+        base[i] = BN_CTX_get(ctx);
+    t = BN_CTX_get(ctx);
+    if (t == NULL
+            || (comb->mont = BN_MONT_CTX_new()) == NULL
+            || !BN_MONT_CTX_set(comb->mont, m, ctx)
+            || !BN_nnmod(t, g, m, ctx)
+            || !bn_to_mont_fixed_top(base[4], t, comb->mont, ctx))
+        goto err;
+
+    for (k = 0; k < BN_COMB_TABLES; k++) {
+        table = comb->tables + k * comb->tablelen;
+
+        /* base[i] = g^(2^((5 * k + i) * cols)), following on from base[4] */
+        for (i = 0; i < 5; i++) {
+            if (!BN_copy(base[i], base[(i + 4) % 5]))
+                goto err;
+            if (k == 0 && i == 0)
+                continue;
+            for (j = 0; j < comb->cols; j++)
+                if (!bn_mul_mont_fixed_top(base[i], base[i], base[i],
+                                           comb->mont, ctx))
+                    goto err;
+        }
+
+        /* Entry e is the product of the base[i] with bit i set in e */
+        if (!bn_to_mont_fixed_top(t, BN_value_one(), comb->mont, ctx)
+                || !MOD_EXP_CTIME_COPY_TO_PREBUF(t, comb->top, table, 0, 5))
+            goto err;
+        for (e = 1; e < 32; e++) {
+            for (i = 0; !(e & (1 << i)); i++)
+                continue;
+            if ((e & (e - 1)) == 0) {
+                if (!MOD_EXP_CTIME_COPY_TO_PREBUF(base[i], comb->top, table,
+                                                  e, 5))
+                    goto err;
+                continue;
+            }
+            if (!MOD_EXP_CTIME_COPY_FROM_PREBUF(t, comb->top, table,
+                                                e & (e - 1), 5)
+                    || !bn_mul_mont_fixed_top(t, t, base[i], comb->mont, ctx)
+                    || !MOD_EXP_CTIME_COPY_TO_PREBUF(t, comb->top, table, e,
+                                                     5))
+                goto err;
+        }
+    }
+
+    BN_CTX_end(ctx);
+    return comb;
+ err:
+    BN_CTX_end(ctx);
+    bn_comb_ctx_free(comb);
+    return NULL;
+}
+
+/*
+ * r = g^p mod m with the tables in |comb|, taking the same time for all |p|
+ * of up to the number of bits |comb| was made for.
+ */
+int bn_mod_exp_comb(BIGNUM *rr, const BIGNUM *p, const BN_COMB_CTX *comb,
+                    BN_CTX *ctx)
+{
+    BIGNUM *r, *x, *t;
+    BN_ULONG *xd;
+    int top = comb->top, cols = comb->cols, col, k, i, idx, pos;
+    int ret = 0;
+
+    if (BN_is_negative(p) || BN_num_bits(p) > comb->bits) {
+        BNerr(BN_F_BN_MOD_EXP_COMB, BN_R_BIGNUM_TOO_LONG);
+        return 0;
+    }
+
+    BN_CTX_start(ctx);
+    r = BN_CTX_get(ctx);
+    x = BN_CTX_get(ctx);
+    t = BN_CTX_get(ctx);
+    if (t == NULL
+            || bn_wexpand(x, (comb->bits + BN_BITS2 - 1) / BN_BITS2) == NULL
+            || !bn_copy_words(x->d, p, (comb->bits + BN_BITS2 - 1) / BN_BITS2))
+        goto err;
+    xd = x->d;
+
+    for (col = cols - 1; col >= 0; col--) {
+        if (col != cols - 1
+                && !bn_mul_mont_fixed_top(r, r, r, comb->mont, ctx))
+            goto err;
+        for (k = 0; k < BN_COMB_TABLES; k++) {
+            for (idx = 0, i = 0; i < 5; i++) {
+                pos = (5 * k + i) * cols + col;
+                idx |= (int)((xd[pos / BN_BITS2] >> (pos % BN_BITS2)) & 1)
+                       << i;
+            }
+            if (col == cols - 1 && k == 0) {
+                if (!MOD_EXP_CTIME_COPY_FROM_PREBUF(r, top, comb->tables,
+                                                    idx, 5))
+                    goto err;
+                continue;
+            }
+            if (!MOD_EXP_CTIME_COPY_FROM_PREBUF(t, top,
+                                                comb->tables
+                                                + k * comb->tablelen,
+                                                idx, 5)
+                    || !bn_mul_mont_fixed_top(r, r, t, comb->mont, ctx))
+                goto err;
+        }
+    }
+
+    if (!BN_from_montgomery(rr, r, comb->mont, ctx))
+        goto err;
+    ret = 1;
+ err:
+    BN_clear(x);
+    BN_CTX_end(ctx);
+    return ret;
+}
+
 int BN_mod_exp_mont_word(BIGNUM *rr, BN_ULONG a, const BIGNUM *p,
                          const BIGNUM *m, BN_CTX *ctx, BN_MONT_CTX *in_mont)
 {
@@ -9,8 +9,11 @@
 
 #include <stdio.h>
 #include "internal/cryptlib.h"
+#include "internal/thread_once.h"
 #include "dh_local.h"
 #include "crypto/bn.h"
+#include "crypto/bn_dh.h"
+#include "crypto/dh.h"
 
 static int generate_key(DH *dh);
 static int compute_key(unsigned char *key, const BIGNUM *pub_key, DH *dh);
@@ -73,6 +76,84 @@ const DH_METHOD *DH_get_default_method(void)
     return default_DH_method;
 }
 
+/*
+ * Tables for g = 2 in the RFC 7919 groups, for exponents of the length that
+ * DH_new_by_nid() gives them.  Each is built the first time a key is
+ * generated in its group and is then shared by all threads.
+ */
+static struct {
+    const BIGNUM *p;
+    int bits;
+    BN_COMB_CTX *comb;
+} dh_named_combs[] = {
+    { &_bignum_ffdhe2048_p, 225, NULL },
+    { &_bignum_ffdhe3072_p, 275, NULL },
+    { &_bignum_ffdhe4096_p, 325, NULL },
+    { &_bignum_ffdhe6144_p, 375, NULL },
+    { &_bignum_ffdhe8192_p, 400, NULL }
+};
+
+static CRYPTO_ONCE dh_comb_once = CRYPTO_ONCE_STATIC_INIT;
+static CRYPTO_RWLOCK *dh_comb_lock = NULL;
+
+DEFINE_RUN_ONCE_STATIC(do_dh_comb_init)
+{
+    /* make sure dh_cleanup_int() gets called */
+    if (!OPENSSL_init_crypto(0, NULL))
+        return 0;
+    dh_comb_lock = CRYPTO_THREAD_lock_new();
+    return dh_comb_lock != NULL;
+}
+
+void dh_cleanup_int(void)
+{
+    size_t i;
+
+    for (i = 0; i < OSSL_NELEM(dh_named_combs); i++) {
+        bn_comb_ctx_free(dh_named_combs[i].comb);
+        dh_named_combs[i].comb = NULL;
+    }
+    CRYPTO_THREAD_lock_free(dh_comb_lock);
+    dh_comb_lock = NULL;
+}
+
+/*
+ * Return the table for computing g^priv_key in the group of |dh|, or NULL if
+ * it is not a named group or |priv_key| is longer than the table allows for.
+ */
+static const BN_COMB_CTX *dh_named_comb(const DH *dh, const BIGNUM *priv_key,
+                                        BN_CTX *ctx)
+{
+    BN_COMB_CTX *comb;
+    size_t i;
+
+    if (!BN_is_word(dh->g, DH_GENERATOR_2))
+        return NULL;
+    for (i = 0; i < OSSL_NELEM(dh_named_combs); i++)
+        if (BN_cmp(dh->p, dh_named_combs[i].p) == 0)
+            break;
+    if (i == OSSL_NELEM(dh_named_combs)
+            || BN_num_bits(priv_key) > dh_named_combs[i].bits
+            || !RUN_ONCE(&dh_comb_once, do_dh_comb_init))
+        return NULL;
+
+    CRYPTO_THREAD_read_lock(dh_comb_lock);
+    comb = dh_named_combs[i].comb;
+    CRYPTO_THREAD_unlock(dh_comb_lock);
+    if (comb != NULL)
+        return comb;
+
+    /* Failing to build the table only means doing without it */
+    ERR_set_mark();
+    CRYPTO_THREAD_write_lock(dh_comb_lock);
+    if ((comb = dh_named_combs[i].comb) == NULL)
+        comb = dh_named_combs[i].comb =
+            bn_comb_ctx_new(dh->g, dh->p, dh_named_combs[i].bits, ctx);
+    CRYPTO_THREAD_unlock(dh_comb_lock);
+    ERR_pop_to_mark();
+    return comb;
+}
+
 static int generate_key(DH *dh)
 {
     int ok = 0;
@@ -80,6 +161,7 @@ static int generate_key(DH *dh)
     unsigned l;
     BN_CTX *ctx = NULL;
     BN_MONT_CTX *mont = NULL;
+    const BN_COMB_CTX *comb;
     BIGNUM *pub_key = NULL, *priv_key = NULL;
 
     if (BN_num_bits(dh->p) > OPENSSL_DH_MAX_MODULUS_BITS) {
@@ -139,12 +221,20 @@ static int generate_key(DH *dh)
 
     {
         BIGNUM *prk = BN_new();
+        int rv;
 
         if (prk == NULL)
             goto err;
         BN_with_flags(prk, priv_key, BN_FLG_CONSTTIME);
 
-        if (!dh->meth->bn_mod_exp(dh, pub_key, dh->g, prk, dh->p, ctx, mont)) {
+        /* Named groups have a fixed-base table, unless bn_mod_exp is custom */
+        if (dh->meth->bn_mod_exp == dh_bn_mod_exp
+                && (comb = dh_named_comb(dh, prk, ctx)) != NULL)
+            rv = bn_mod_exp_comb(pub_key, prk, comb, ctx);
+        else
+            rv = dh->meth->bn_mod_exp(dh, pub_key, dh->g, prk, dh->p, ctx,
+                                      mont);
+        if (!rv) {
             BN_clear_free(prk);
             goto err;
         }
@@ -78,6 +78,7 @@ open OUT,"| \"$^X\" \"$xlate\" $flavour \"$output\"";
 if (`$ENV{CC} -Wa,-v -c -o /dev/null -x assembler /dev/null 2>&1`
 		=~ /GNU assembler version ([2-9]\.[0-9]+)/) {
 	$addx = ($1>=2.23);
+	$ifma = ($1>=2.26);
 }
 
 if (!$addx && $win64 && ($flavour =~ /nasm/ || $ENV{ASM} =~ /nasm/) &&
@@ -906,6 +907,355 @@ x25519_fe64_tobytes:
 .size	x25519_fe64_mul,.-x25519_fe64_mul
 ___
 }
+########################################################################
+# Eight independent ladders side by side, one in each 64-bit lane of the
+# ZMM registers, with AVX512IFMA.
+#
+# Field elements are five limbs in radix 2^52, the last one holding the
+# remaining 47 bits, each limb being a row of eight lanes.  Products are
+# reduced with 2^260 = 608 mod 2^255-19, and after every operation the
+# limbs are carried to below 2^52, and the last one to a bit above 2^47,
+# as vpmadd52[lh]uq only see the low 52 bits of their inputs.  The
+# caller lays out the eight points and scalars, and gets back the
+# affine x-coordinates, see x25519_scalar_mult_multi() in curve25519.c.
+#
+if ($ifma) {
+my $ctx="%rdi";
+my ($dst,$a,$b,$cnt)=map("%r$_",(8..11));
+my @A=map("%zmm$_",(16..25));
+my ($F,$L,$H,$M52,$M47,$C608)=map("%zmm$_",(26..31));
+my ($C19,$ONE,$PREV,$T0,$T1,$T2)=map("%zmm$_",(0..5));
+# offsets of the elements and the scalars in the context
+my ($X1,$X2,$Z2,$X3,$Z3,$TT0,$TT1,$K)=map(320*$_,(0..7));
+my $label=0;
+
+sub fe_op {
+my ($op,$d,$x,$y)=@_;
+$code.=<<___;
+	lea	$d($ctx),$dst
+	lea	$x($ctx),$a
+	lea	$y($ctx),$b
+	call	__fe52x8_$op
+___
+}
+
+# $d = $x^(2^$n)
+sub fe_sqrn {
+my ($d,$x,$n)=@_;
+	&fe_op("mul",$d,$x,$x);
+	return if ($n==1);
+	$label++;
+$code.=<<___;
+	mov	\$`$n-1`,$cnt
+.Lsqrn_$label:
+___
+	&fe_op("mul",$d,$d,$d);
+$code.=<<___;
+	dec	$cnt
+	jnz	.Lsqrn_$label
+___
+}
+
+$code.=<<___;
+.extern	OPENSSL_ia32cap_P
+.globl	x25519_ifma_eligible
+.type	x25519_ifma_eligible,\@abi-omnipotent
+.align	32
+x25519_ifma_eligible:
+.cfi_startproc
+	mov	OPENSSL_ia32cap_P+8(%rip),%ecx
+	xor	%eax,%eax
+	and	\$`1<<21|1<<16`,%ecx	# AVX512IFMA and AVX512F
+	cmp	\$`1<<21|1<<16`,%ecx
+	cmove	%ecx,%eax
+	ret
+.cfi_endproc
+.size	x25519_ifma_eligible,.-x25519_ifma_eligible
+
+.align	64
+.Lfe52x8_2p:				# 2*(2^255-19)
+	.quad	0x1fffffffffffda,0x1fffffffffffda,0x1fffffffffffda,0x1fffffffffffda
+	.quad	0x1fffffffffffda,0x1fffffffffffda,0x1fffffffffffda,0x1fffffffffffda
+	.quad	0x1ffffffffffffe,0x1ffffffffffffe,0x1ffffffffffffe,0x1ffffffffffffe
+	.quad	0x1ffffffffffffe,0x1ffffffffffffe,0x1ffffffffffffe,0x1ffffffffffffe
+	.quad	0x1ffffffffffffe,0x1ffffffffffffe,0x1ffffffffffffe,0x1ffffffffffffe
+	.quad	0x1ffffffffffffe,0x1ffffffffffffe,0x1ffffffffffffe,0x1ffffffffffffe
+	.quad	0x1ffffffffffffe,0x1ffffffffffffe,0x1ffffffffffffe,0x1ffffffffffffe
+	.quad	0x1ffffffffffffe,0x1ffffffffffffe,0x1ffffffffffffe,0x1ffffffffffffe
+	.quad	0xfffffffffffe,0xfffffffffffe,0xfffffffffffe,0xfffffffffffe
+	.quad	0xfffffffffffe,0xfffffffffffe,0xfffffffffffe,0xfffffffffffe
+
+# ($dst) = ($a) * ($b), may be called with any of them the same
+.type	__fe52x8_mul,\@abi-omnipotent
+.align	32
+__fe52x8_mul:
+.cfi_startproc
+___
+for (my $i=0; $i<10; $i++) {
+$code.=<<___;
+	vpxorq	@A[$i],@A[$i],@A[$i]
+___
+}
+for (my $i=0; $i<5; $i++) {
+$code.=<<___;
+	vmovdqu64	64*$i($a),$F
+___
+	for (my $j=0; $j<5; $j++) {
+$code.=<<___;
+	vpmadd52luq	64*$j($b),$F,@A[$i+$j]
+	vpmadd52huq	64*$j($b),$F,@A[$i+$j+1]
+___
+	}
+}
+$code.=<<___;
+	vpxorq	$T0,$T0,$T0
+___
+# fold limbs 5 to 9 into 0 to 4, position 5 collecting in $T0
+for (my $k=0; $k<5; $k++) {
+my $up = $k<4 ? @A[$k+1] : $T0;
+$code.=<<___;
+	vpsrlq	\$52,@A[$k+5],$H
+	vpandq	$M52,@A[$k+5],$L
+	vpmadd52luq	$C608,$L,@A[$k]
+	vpmadd52huq	$C608,$L,$up
+	vpmadd52luq	$C608,$H,$up
+___
+}
+$code.=<<___;
+	vpmadd52luq	$C608,$T0,@A[0]
+	jmp	__fe52x8_norm
+.cfi_endproc
+.size	__fe52x8_mul,.-__fe52x8_mul
+
+# ($dst) = ($a) * 121666
+.type	__fe52x8_mul121666,\@abi-omnipotent
+.align	32
+__fe52x8_mul121666:
+.cfi_startproc
+	mov	\$121666,%eax
+	vpbroadcastq	%rax,$F
+___
+for (my $i=0; $i<6; $i++) {
+$code.=<<___;
+	vpxorq	@A[$i],@A[$i],@A[$i]
+___
+}
+for (my $i=0; $i<5; $i++) {
+$code.=<<___;
+	vpmadd52luq	64*$i($a),$F,@A[$i]
+	vpmadd52huq	64*$i($a),$F,@A[$i+1]
+___
+}
+$code.=<<___;
+	vpmadd52luq	$C608,@A[5],@A[0]
+	jmp	__fe52x8_norm
+.cfi_endproc
+.size	__fe52x8_mul121666,.-__fe52x8_mul121666
+
+# ($dst) = ($a) + ($b)
+.type	__fe52x8_add,\@abi-omnipotent
+.align	32
+__fe52x8_add:
+.cfi_startproc
+___
+for (my $i=0; $i<5; $i++) {
+$code.=<<___;
+	vmovdqu64	64*$i($a),@A[$i]
+	vpaddq	64*$i($b),@A[$i],@A[$i]
+___
+}
+$code.=<<___;
+	jmp	__fe52x8_norm
+.cfi_endproc
+.size	__fe52x8_add,.-__fe52x8_add
+
+# ($dst) = ($a) - ($b), computed as ($a) + 2*p - ($b)
+.type	__fe52x8_sub,\@abi-omnipotent
+.align	32
+__fe52x8_sub:
+.cfi_startproc
+	lea	.Lfe52x8_2p(%rip),%rax
+___
+for (my $i=0; $i<5; $i++) {
+$code.=<<___;
+	vmovdqu64	64*$i($a),@A[$i]
+	vpaddq	64*$i(%rax),@A[$i],@A[$i]
+	vpsubq	64*$i($b),@A[$i],@A[$i]
+___
+}
+$code.=<<___;
+	jmp	__fe52x8_norm
+.cfi_endproc
+.size	__fe52x8_sub,.-__fe52x8_sub
+
+# Carry @A[0..4], each below 2^63, and store them at ($dst).  Starting
+# with the top limb leaves all of the limbs below 2^52.
+.type	__fe52x8_norm,\@abi-omnipotent
+.align	32
+__fe52x8_norm:
+.cfi_startproc
+	vpsrlq	\$47,@A[4],$H
+	vpandq	$M47,@A[4],@A[4]
+	vpmadd52luq	$C19,$H,@A[0]
+___
+for (my $i=0; $i<4; $i++) {
+$code.=<<___;
+	vpsrlq	\$52,@A[$i],$H
+	vpandq	$M52,@A[$i],@A[$i]
+	vpaddq	$H,@A[$i+1],@A[$i+1]
+___
+}
+for (my $i=0; $i<5; $i++) {
+$code.=<<___;
+	vmovdqu64	@A[$i],64*$i($dst)
+___
+}
+$code.=<<___;
+	ret
+.cfi_endproc
+.size	__fe52x8_norm,.-__fe52x8_norm
+
+.globl	x25519_scalar_mult_ifma
+.type	x25519_scalar_mult_ifma,\@function,1
+.align	32
+x25519_scalar_mult_ifma:
+.cfi_startproc
+	mov	\$0xfffffffffffff,%rax
+	vpbroadcastq	%rax,$M52
+	mov	\$0x7fffffffffff,%rax
+	vpbroadcastq	%rax,$M47
+	mov	\$608,%eax
+	vpbroadcastq	%rax,$C608
+	mov	\$19,%eax
+	vpbroadcastq	%rax,$C19
+	mov	\$1,%eax
+	vpbroadcastq	%rax,$ONE
+	vpxorq	$PREV,$PREV,$PREV
+
+	# x2 = 1, z2 = 0, x3 = x1, z3 = 1
+	vpxorq	$T0,$T0,$T0
+	vmovdqu64	$ONE,$X2($ctx)
+	vmovdqu64	$T0,$Z2($ctx)
+	vmovdqu64	$ONE,$Z3($ctx)
+___
+for (my $i=0; $i<5; $i++) {
+$code.=<<___	if ($i);
+	vmovdqu64	$T0,$X2+64*$i($ctx)
+	vmovdqu64	$T0,$Z2+64*$i($ctx)
+	vmovdqu64	$T0,$Z3+64*$i($ctx)
+___
+$code.=<<___;
+	vmovdqu64	$X1+64*$i($ctx),$T1
+	vmovdqu64	$T1,$X3+64*$i($ctx)
+___
+}
+$code.=<<___;
+
+	mov	\$254,%ecx
+.align	32
+.Loop_ifma:
+	# bit |pos| of each scalar, and whether it differs from the last one
+	mov	%ecx,%eax
+	shr	\$6,%eax
+	shl	\$6,%eax
+	mov	%ecx,%edx
+	and	\$63,%edx
+	vmovdqu64	$K($ctx,%rax),$T0
+	vmovq	%rdx,%xmm4		# low half of $T1
+	vpsrlq	%xmm4,$T0,$T0
+	vpandq	$ONE,$T0,$T0
+	vpxorq	$T0,$PREV,$T2
+	vmovdqa64	$T0,$PREV
+	vptestmq	$T2,$T2,%k1
+___
+foreach my $pair ([$X2,$X3],[$Z2,$Z3]) {
+	for (my $i=0; $i<5; $i++) {
+$code.=<<___;
+	vmovdqu64	$$pair[0]+64*$i($ctx),$T0
+	vmovdqu64	$$pair[1]+64*$i($ctx),$T1
+	vpblendmq	$T1,$T0,$T2\{%k1\}
+	vpblendmq	$T0,$T1,$T1\{%k1\}
+	vmovdqu64	$T2,$$pair[0]+64*$i($ctx)
+	vmovdqu64	$T1,$$pair[1]+64*$i($ctx)
+___
+	}
+}
+	&fe_op("sub",$TT0,$X3,$Z3);
+	&fe_op("sub",$TT1,$X2,$Z2);
+	&fe_op("add",$X2,$X2,$Z2);
+	&fe_op("add",$Z2,$X3,$Z3);
+	&fe_op("mul",$Z3,$X2,$TT0);
+	&fe_op("mul",$Z2,$Z2,$TT1);
+	&fe_op("mul",$TT0,$TT1,$TT1);
+	&fe_op("mul",$TT1,$X2,$X2);
+	&fe_op("add",$X3,$Z3,$Z2);
+	&fe_op("sub",$Z2,$Z3,$Z2);
+	&fe_op("mul",$X2,$TT1,$TT0);
+	&fe_op("sub",$TT1,$TT1,$TT0);
+	&fe_op("mul",$Z2,$Z2,$Z2);
+	&fe_op("mul121666",$Z3,$TT1,$TT1);
+	&fe_op("mul",$X3,$X3,$X3);
+	&fe_op("add",$TT0,$TT0,$Z3);
+	&fe_op("mul",$Z3,$X1,$Z2);
+	&fe_op("mul",$Z2,$TT1,$TT0);
+$code.=<<___;
+	dec	%ecx
+	jns	.Loop_ifma
+
+	# x2 = x2 / z2, with 1 / z2 = z2^(2^255 - 21)
+___
+	&fe_sqrn($TT0,$Z2,1);			# z^2
+	&fe_sqrn($TT1,$TT0,2);			# z^8
+	&fe_op("mul",$TT1,$Z2,$TT1);		# z^9
+	&fe_op("mul",$TT0,$TT0,$TT1);		# z^11
+	&fe_sqrn($X3,$TT0,1);			# z^22
+	&fe_op("mul",$TT1,$TT1,$X3);		# z^(2^5 - 1)
+	&fe_sqrn($X3,$TT1,5);
+	&fe_op("mul",$TT1,$X3,$TT1);		# z^(2^10 - 1)
+	&fe_sqrn($X3,$TT1,10);
+	&fe_op("mul",$X3,$X3,$TT1);		# z^(2^20 - 1)
+	&fe_sqrn($Z3,$X3,20);
+	&fe_op("mul",$X3,$Z3,$X3);		# z^(2^40 - 1)
+	&fe_sqrn($X3,$X3,10);
+	&fe_op("mul",$TT1,$X3,$TT1);		# z^(2^50 - 1)
+	&fe_sqrn($X3,$TT1,50);
+	&fe_op("mul",$X3,$X3,$TT1);		# z^(2^100 - 1)
+	&fe_sqrn($Z3,$X3,100);
+	&fe_op("mul",$X3,$Z3,$X3);		# z^(2^200 - 1)
+	&fe_sqrn($X3,$X3,50);
+	&fe_op("mul",$TT1,$X3,$TT1);		# z^(2^250 - 1)
+	&fe_sqrn($TT1,$TT1,5);
+	&fe_op("mul",$TT1,$TT1,$TT0);		# z^(2^255 - 21)
+	&fe_op("mul",$X2,$X2,$TT1);
+$code.=<<___;
+
+	vzeroupper
+	ret
+.cfi_endproc
+.size	x25519_scalar_mult_ifma,.-x25519_scalar_mult_ifma
+___
+} else {
+$code.=<<___;
+.globl	x25519_ifma_eligible
+.type	x25519_ifma_eligible,\@abi-omnipotent
+.align	32
+x25519_ifma_eligible:
+.cfi_startproc
+	xor	%eax,%eax
+	ret
+.cfi_endproc
+.size	x25519_ifma_eligible,.-x25519_ifma_eligible
+
+.globl	x25519_scalar_mult_ifma
+.type	x25519_scalar_mult_ifma,\@abi-omnipotent
+x25519_scalar_mult_ifma:
+.cfi_startproc
+	.byte	0x0f,0x0b	# ud2
+	ret
+.cfi_endproc
+.size	x25519_scalar_mult_ifma,.-x25519_scalar_mult_ifma
+___
+}
 $code.=<<___;
 .asciz	"X25519 primitives for x86_64, CRYPTOGAMS by <appro\@openssl.org>"
 ___
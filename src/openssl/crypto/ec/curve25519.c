@@ -9,6 +9,7 @@
 
 #include <string.h>
 #include "ec_local.h"
+#include <openssl/rand.h>
 #include <openssl/sha.h>
 
 #if defined(X25519_ASM) && (defined(__x86_64) || defined(__x86_64__) || \
@@ -249,6 +250,80 @@ static void x25519_scalar_mulx(uint8_t out[32], const uint8_t scalar[32],
 
     OPENSSL_cleanse(e, sizeof(e));
 }
+
+/*
+ * x25519_scalar_mult_ifma runs eight ladders at once, one in each lane of
+ * the AVX512 registers, with field elements as five rows of radix 2^52
+ * limbs.  It takes the u-coordinates in |x1| and the clamped scalars in |k|
+ * and leaves the results, partially reduced, in |x2|.  The other elements
+ * are its scratch space.
+ */
+# define X25519_MULTI_IMPLEMENTED
+# define X25519_MULTI_LANES 8
+# define X25519_MULTI_MIN   2
+
+typedef struct {
+    uint64_t x1[5][X25519_MULTI_LANES];
+    uint64_t x2[5][X25519_MULTI_LANES];
+    uint64_t z2[5][X25519_MULTI_LANES];
+    uint64_t x3[5][X25519_MULTI_LANES];
+    uint64_t z3[5][X25519_MULTI_LANES];
+    uint64_t tmp0[5][X25519_MULTI_LANES];
+    uint64_t tmp1[5][X25519_MULTI_LANES];
+    uint64_t k[4][X25519_MULTI_LANES];
+} X25519_MULTI_CTX;
+
+int x25519_ifma_eligible(void);
+void x25519_scalar_mult_ifma(X25519_MULTI_CTX *ctx);
+
+static const uint64_t MASK52 = 0xfffffffffffff;
+
+/* Computes out[i] = scalar[i] * point[i] for the first |num| lanes */
+static void x25519_scalar_mult_multi(uint8_t *const *out,
+                                     const uint8_t *const *scalar,
+                                     const uint8_t *const *point, size_t num)
+{
+    unsigned char storage[sizeof(X25519_MULTI_CTX) + 64];
+    X25519_MULTI_CTX *ctx;
+    fe64 w;
+    uint8_t e[32];
+    size_t l;
+
+    ctx = (X25519_MULTI_CTX *)(storage + 64 - ((size_t)storage % 64));
+    memset(ctx, 0, sizeof(*ctx));
+
+    for (l = 0; l < num; l++) {
+        fe64_frombytes(w, point[l]);
+        ctx->x1[0][l] = w[0] & MASK52;
+        ctx->x1[1][l] = ((w[0] >> 52) | (w[1] << 12)) & MASK52;
+        ctx->x1[2][l] = ((w[1] >> 40) | (w[2] << 24)) & MASK52;
+        ctx->x1[3][l] = ((w[2] >> 28) | (w[3] << 36)) & MASK52;
+        ctx->x1[4][l] = w[3] >> 16;
+
+        memcpy(e, scalar[l], 32);
+        e[0]  &= 0xf8;
+        e[31] &= 0x7f;
+        e[31] |= 0x40;
+        ctx->k[0][l] = load_8(e);
+        ctx->k[1][l] = load_8(e + 8);
+        ctx->k[2][l] = load_8(e + 16);
+        ctx->k[3][l] = load_8(e + 24);
+    }
+
+    x25519_scalar_mult_ifma(ctx);
+
+    for (l = 0; l < num; l++) {
+        w[0] = ctx->x2[0][l] | (ctx->x2[1][l] << 52);
+        w[1] = (ctx->x2[1][l] >> 12) | (ctx->x2[2][l] << 40);
+        w[2] = (ctx->x2[2][l] >> 24) | (ctx->x2[3][l] << 28);
+        w[3] = (ctx->x2[3][l] >> 36) | (ctx->x2[4][l] << 16);
+        fe64_tobytes(out[l], w);
+    }
+
+    OPENSSL_cleanse(storage, sizeof(storage));
+    OPENSSL_cleanse(w, sizeof(w));
+    OPENSSL_cleanse(e, sizeof(e));
+}
 #endif
 
 #if defined(X25519_ASM) \
@@ -5473,33 +5548,22 @@ int ED25519_sign(uint8_t *out_sig, const uint8_t *message, size_t message_len,
 
 static const char allzeroes[15];
 
-int ED25519_verify(const uint8_t *message, size_t message_len,
-                   const uint8_t signature[64], const uint8_t public_key[32])
+/*
+ * Check 0 <= s < L where L = 2^252 + 27742317777372353535851937790883648493
+ *
+ * If not the signature is publicly invalid. Since it's public we can do the
+ * check in variable time.
+ */
+static int ed25519_s_is_valid(const uint8_t *s)
 {
     int i;
-    ge_p3 A;
-    const uint8_t *r, *s;
-    SHA512_CTX hash_ctx;
-    ge_p2 R;
-    uint8_t rcheck[32];
-    uint8_t h[SHA512_DIGEST_LENGTH];
     /* 27742317777372353535851937790883648493 in little endian format */
     const uint8_t l_low[16] = {
         0xED, 0xD3, 0xF5, 0x5C, 0x1A, 0x63, 0x12, 0x58, 0xD6, 0x9C, 0xF7, 0xA2,
         0xDE, 0xF9, 0xDE, 0x14
     };
 
-    r = signature;
-    s = signature + 32;
-
-    /*
-     * Check 0 <= s < L where L = 2^252 + 27742317777372353535851937790883648493
-     *
-     * If not the signature is publicly invalid. Since it's public we can do the
-     * check in variable time.
-     *
-     * First check the most significant byte
-     */
+    /* First check the most significant byte */
     if (s[31] > 0x10)
         return 0;
     if (s[31] == 0x10) {
@@ -5518,13 +5582,15 @@ int ED25519_verify(const uint8_t *message, size_t message_len,
         if (i < 0)
             return 0;
     }
+    return 1;
+}
 
-    if (ge_frombytes_vartime(&A, public_key) != 0) {
-        return 0;
-    }
-
-    fe_neg(A.X, A.X);
-    fe_neg(A.T, A.T);
+/* h = SHA512(R || A || M) mod L */
+static void ed25519_hram(uint8_t h[SHA512_DIGEST_LENGTH], const uint8_t *r,
+                         const uint8_t *public_key, const uint8_t *message,
+                         size_t message_len)
+{
+    SHA512_CTX hash_ctx;
 
     SHA512_Init(&hash_ctx);
     SHA512_Update(&hash_ctx, r, 32);
@@ -5533,6 +5599,31 @@ int ED25519_verify(const uint8_t *message, size_t message_len,
     SHA512_Final(h, &hash_ctx);
 
     x25519_sc_reduce(h);
+}
+
+int ED25519_verify(const uint8_t *message, size_t message_len,
+                   const uint8_t signature[64], const uint8_t public_key[32])
+{
+    ge_p3 A;
+    const uint8_t *r, *s;
+    ge_p2 R;
+    uint8_t rcheck[32];
+    uint8_t h[SHA512_DIGEST_LENGTH];
+
+    r = signature;
+    s = signature + 32;
+
+    if (!ed25519_s_is_valid(s))
+        return 0;
+
+    if (ge_frombytes_vartime(&A, public_key) != 0) {
+        return 0;
+    }
+
+    fe_neg(A.X, A.X);
+    fe_neg(A.T, A.T);
+
+    ed25519_hram(h, r, public_key, message, message_len);
 
     ge_double_scalarmult_vartime(&R, h, &A, s);
 
@@ -5541,6 +5632,402 @@ int ED25519_verify(const uint8_t *message, size_t message_len,
     return CRYPTO_memcmp(rcheck, r, sizeof(rcheck)) == 0;
 }
 
+/*
+ * The multiples j * 256^i * -A, j = 1..8, i = 0..31, of a public key A, laid
+ * out as k25519Precomp is for the base point.  With them a verification is
+ * two fixed-base multiplications and needs only four doublings.
+ */
+struct ed25519_table_st {
+    ge_precomp t[32][8];
+};
+
+ED25519_TABLE *ED25519_table_new(const uint8_t public_key[32])
+{
+    ED25519_TABLE *table = NULL;
+    ge_p3 *p = NULL, base;
+    ge_cached c;
+    ge_p1p1 t;
+    ge_p2 q;
+    fe *zinv = NULL, inv, x, y;
+    uint8_t b[32];
+    int i, j;
+
+    if (ge_frombytes_vartime(&base, public_key) != 0)
+        return NULL;
+    fe_neg(base.X, base.X);
+    fe_neg(base.T, base.T);
+
+    if ((table = OPENSSL_malloc(sizeof(*table))) == NULL
+            || (p = OPENSSL_malloc(256 * sizeof(*p))) == NULL
+            || (zinv = OPENSSL_malloc(256 * sizeof(*zinv))) == NULL) {
+        OPENSSL_free(table);
+        table = NULL;
+        goto err;
+    }
+
+    for (i = 0; i < 32; i++) {
+        p[8 * i] = base;
+        ge_p3_to_cached(&c, &base);
+        for (j = 1; j < 8; j++) {
+            ge_add(&t, &p[8 * i + j - 1], &c);
+            ge_p1p1_to_p3(&p[8 * i + j], &t);
+        }
+        ge_p3_to_p2(&q, &base);
+        for (j = 0; j < 7; j++) {
+            ge_p2_dbl(&t, &q);
+            ge_p1p1_to_p2(&q, &t);
+        }
+        ge_p2_dbl(&t, &q);
+        ge_p1p1_to_p3(&base, &t);
+    }
+
+    /* Make the points affine with a single inversion */
+    fe_copy(zinv[0], p[0].Z);
+    for (i = 1; i < 256; i++)
+        fe_mul(zinv[i], zinv[i - 1], p[i].Z);
+    fe_invert(inv, zinv[255]);
+    for (i = 255; i > 0; i--) {
+        fe_mul(zinv[i], inv, zinv[i - 1]);
+        fe_mul(inv, inv, p[i].Z);
+    }
+    fe_copy(zinv[0], inv);
+
+    for (i = 0; i < 256; i++) {
+        ge_precomp *e = &table->t[i / 8][i % 8];
+
+        fe_mul(x, p[i].X, zinv[i]);
+        fe_mul(y, p[i].Y, zinv[i]);
+        /* Reduce the sums, they are multiplied without further carries */
+        fe_add(e->yplusx, y, x);
+        fe_tobytes(b, e->yplusx);
+        fe_frombytes(e->yplusx, b);
+        fe_sub(e->yminusx, y, x);
+        fe_tobytes(b, e->yminusx);
+        fe_frombytes(e->yminusx, b);
+        fe_mul(e->xy2d, x, y);
+        fe_mul(e->xy2d, e->xy2d, d2);
+    }
+
+ err:
+    OPENSSL_free(p);
+    OPENSSL_free(zinv);
+    return table;
+}
+
+void ED25519_table_free(ED25519_TABLE *table)
+{
+    OPENSSL_free(table);
+}
+
+/* Signed radix 16 digits of |a|, each between -8 and 8.  a[31] <= 127. */
+static void ge_radix16(signed char e[64], const uint8_t *a)
+{
+    signed char carry;
+    int i;
+
+    for (i = 0; i < 32; ++i) {
+        e[2 * i + 0] = (a[i] >> 0) & 15;
+        e[2 * i + 1] = (a[i] >> 4) & 15;
+    }
+    carry = 0;
+    for (i = 0; i < 63; ++i) {
+        e[i] += carry;
+        carry = e[i] + 8;
+        carry >>= 4;
+        e[i] -= carry << 4;
+    }
+    e[63] += carry;
+}
+
+/* h += b * row[0], row being one row of a table as k25519Precomp */
+static void ge_madd_digit_vartime(ge_p3 *h, const ge_precomp *row,
+                                  signed char b)
+{
+    ge_p1p1 t;
+
+    if (b > 0) {
+        ge_madd(&t, h, &row[b - 1]);
+        ge_p1p1_to_p3(h, &t);
+    } else if (b < 0) {
+        ge_msub(&t, h, &row[-b - 1]);
+        ge_p1p1_to_p3(h, &t);
+    }
+}
+
+/*
+ * r = a * A + b * B, as ge_double_scalarmult_vartime() but with A given by
+ * its table.
+ */
+static void ge_double_scalarmult_table_vartime(ge_p2 *r, const uint8_t *a,
+                                               const ED25519_TABLE *A,
+                                               const uint8_t *b)
+{
+    signed char ea[64], eb[64];
+    ge_p1p1 t;
+    ge_p2 s;
+    ge_p3 h;
+    int i;
+
+    ge_radix16(ea, a);
+    ge_radix16(eb, b);
+
+    ge_p3_0(&h);
+    for (i = 1; i < 64; i += 2) {
+        ge_madd_digit_vartime(&h, A->t[i / 2], ea[i]);
+        ge_madd_digit_vartime(&h, k25519Precomp[i / 2], eb[i]);
+    }
+
+    ge_p3_dbl(&t, &h);
+    ge_p1p1_to_p2(&s, &t);
+    ge_p2_dbl(&t, &s);
+    ge_p1p1_to_p2(&s, &t);
+    ge_p2_dbl(&t, &s);
+    ge_p1p1_to_p2(&s, &t);
+    ge_p2_dbl(&t, &s);
+    ge_p1p1_to_p3(&h, &t);
+
+    for (i = 0; i < 64; i += 2) {
+        ge_madd_digit_vartime(&h, A->t[i / 2], ea[i]);
+        ge_madd_digit_vartime(&h, k25519Precomp[i / 2], eb[i]);
+    }
+    ge_p3_to_p2(r, &h);
+}
+
+int ED25519_verify_table(const uint8_t *message, size_t message_len,
+                         const uint8_t signature[64],
+                         const uint8_t public_key[32],
+                         const ED25519_TABLE *table)
+{
+    const uint8_t *r = signature, *s = signature + 32;
+    ge_p2 R;
+    uint8_t rcheck[32];
+    uint8_t h[SHA512_DIGEST_LENGTH];
+
+    if (!ed25519_s_is_valid(s))
+        return 0;
+
+    ed25519_hram(h, r, public_key, message, message_len);
+
+    ge_double_scalarmult_table_vartime(&R, h, table, s);
+
+    ge_tobytes(rcheck, &R);
+
+    return CRYPTO_memcmp(rcheck, r, sizeof(rcheck)) == 0;
+}
+
+/*
+ * Is |s| the encoding ge_tobytes() gives for the point it decodes to?  y
+ * must be below p, and x = 0, i.e. y = 1 or y = -1, must not be marked as
+ * negative.
+ */
+static int ge_encoding_is_canonical(const uint8_t *s)
+{
+    /* p - 1 in little endian format */
+    static const uint8_t pm1[32] = {
+        0xEC, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+        0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+        0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0x7F
+    };
+    static const uint8_t one[32] = { 1 };
+    uint8_t y[32];
+    int i;
+
+    memcpy(y, s, sizeof(y));
+    y[31] &= 0x7f;
+    for (i = 31; i > 0 && y[i] == pm1[i]; i--)
+        continue;
+    if (y[i] > pm1[i])
+        return 0;
+    if ((s[31] & 0x80) != 0
+            && (memcmp(y, pm1, sizeof(y)) == 0 || memcmp(y, one, sizeof(y)) == 0))
+        return 0;
+    return 1;
+}
+
+/*
+ * Batch verification.  With random 128-bit z_i, the signatures (R_i, s_i)
+ * of a batch are checked at once with
+ *
+ *   (sum z_i s_i) B - sum z_i R_i - sum (z_i h_i) A_i == 0
+ *
+ * which is one multi-scalar multiplication (Straus' method, sharing the
+ * doublings between all points).  Signatures by the same key share a single
+ * A_i term.  If the check fails each signature of the batch is verified on
+ * its own to find the bad ones.
+ */
+#define ED25519_BATCH_MAX   64
+
+typedef struct {
+    /* odd multiples P, 3P, ... 15P of each point and their scalars */
+    ge_cached pts[2 * ED25519_BATCH_MAX][8];
+    signed char slides[2 * ED25519_BATCH_MAX + 1][256];
+    uint8_t z[ED25519_BATCH_MAX][16];
+    uint8_t hz[ED25519_BATCH_MAX][32];
+    const uint8_t *keys[ED25519_BATCH_MAX];
+    int idx[ED25519_BATCH_MAX];
+} ED25519_BATCH;
+
+static void ge_p3_odd_multiples(ge_cached Ai[8], const ge_p3 *A)
+{
+    ge_p1p1 t;
+    ge_p3 u, A2;
+    int i;
+
+    ge_p3_to_cached(&Ai[0], A);
+    ge_p3_dbl(&t, A);
+    ge_p1p1_to_p3(&A2, &t);
+    for (i = 1; i < 8; i++) {
+        ge_add(&t, &A2, &Ai[i - 1]);
+        ge_p1p1_to_p3(&u, &t);
+        ge_p3_to_cached(&Ai[i], &u);
+    }
+}
+
+/* Verify |num| <= ED25519_BATCH_MAX signatures, setting their |status| */
+static void ed25519_verify_batch_int(ED25519_BATCH *b,
+                                     const uint8_t *const *message,
+                                     const size_t *message_len,
+                                     const uint8_t *const *signature,
+                                     const uint8_t *const *public_key,
+                                     size_t num, int *status)
+{
+    uint8_t h[SHA512_DIGEST_LENGTH], z[32], sb[32];
+    ge_p3 P;
+    ge_p2 r;
+    ge_p1p1 t;
+    ge_p3 u;
+    fe check;
+    size_t i;
+    int n = 0, nkeys = 0, npts, k, j, top;
+
+    if (RAND_bytes(&b->z[0][0], (int)(num * sizeof(b->z[0]))) <= 0)
+        goto single;
+
+    memset(sb, 0, sizeof(sb));
+    memset(z, 0, sizeof(z));
+    for (i = 0; i < num; i++) {
+        const uint8_t *R = signature[i], *s = signature[i] + 32;
+
+        /* Anything that ED25519_verify() rejects up front is left out */
+        status[i] = 0;
+        if (!ed25519_s_is_valid(s) || !ge_encoding_is_canonical(R)
+                || ge_frombytes_vartime(&P, R) != 0)
+            continue;
+        for (k = 0; k < nkeys; k++)
+            if (memcmp(b->keys[k], public_key[i], 32) == 0)
+                break;
+        if (k == nkeys) {
+            if (ge_frombytes_vartime(&u, public_key[i]) != 0)
+                continue;
+            fe_neg(u.X, u.X);
+            fe_neg(u.T, u.T);
+            ge_p3_odd_multiples(b->pts[ED25519_BATCH_MAX + k], &u);
+            b->keys[k] = public_key[i];
+            memset(b->hz[k], 0, sizeof(b->hz[k]));
+            nkeys++;
+        }
+        status[i] = -1;
+        b->idx[n] = (int)i;
+
+        /* -z_i R_i */
+        fe_neg(P.X, P.X);
+        fe_neg(P.T, P.T);
+        ge_p3_odd_multiples(b->pts[n], &P);
+        memcpy(z, b->z[i], sizeof(b->z[i]));
+        slide(b->slides[n], z);
+        n++;
+
+        /* z_i s_i B and -(z_i h_i) A_i */
+        ed25519_hram(h, R, public_key[i], message[i], message_len[i]);
+        sc_muladd(sb, z, s, sb);
+        sc_muladd(b->hz[k], z, h, b->hz[k]);
+    }
+    if (n == 0)
+        return;
+
+    /* Move the key terms down next to the R terms */
+    for (k = 0; k < nkeys; k++) {
+        if (n != ED25519_BATCH_MAX)
+            memcpy(b->pts[n + k], b->pts[ED25519_BATCH_MAX + k],
+                   sizeof(b->pts[0]));
+        slide(b->slides[n + k], b->hz[k]);
+    }
+    npts = n + nkeys;
+    slide(b->slides[npts], sb);
+
+    for (top = 255; top >= 0; top--) {
+        for (j = 0; j <= npts && b->slides[j][top] == 0; j++)
+            continue;
+        if (j <= npts)
+            break;
+    }
+    ge_p2_0(&r);
+    for (; top >= 0; top--) {
+        ge_p2_dbl(&t, &r);
+        for (j = 0; j < npts; j++) {
+            signed char digit = b->slides[j][top];
+
+            if (digit > 0) {
+                ge_p1p1_to_p3(&u, &t);
+                ge_add(&t, &u, &b->pts[j][digit / 2]);
+            } else if (digit < 0) {
+                ge_p1p1_to_p3(&u, &t);
+                ge_sub(&t, &u, &b->pts[j][-digit / 2]);
+            }
+        }
+        if (b->slides[npts][top] > 0) {
+            ge_p1p1_to_p3(&u, &t);
+            ge_madd(&t, &u, &Bi[b->slides[npts][top] / 2]);
+        } else if (b->slides[npts][top] < 0) {
+            ge_p1p1_to_p3(&u, &t);
+            ge_msub(&t, &u, &Bi[-b->slides[npts][top] / 2]);
+        }
+        ge_p1p1_to_p2(&r, &t);
+    }
+
+    /* The identity is (0 : Z : Z) */
+    fe_sub(check, r.Y, r.Z);
+    if (!fe_isnonzero(r.X) && !fe_isnonzero(check)) {
+        for (j = 0; j < n; j++)
+            status[b->idx[j]] = 1;
+        return;
+    }
+
+ single:
+    for (i = 0; i < num; i++)
+        status[i] = ED25519_verify(message[i], message_len[i], signature[i],
+                                   public_key[i]);
+}
+
+int ED25519_verify_batch(const uint8_t *const *message,
+                         const size_t *message_len,
+                         const uint8_t *const *signature,
+                         const uint8_t *const *public_key, size_t num,
+                         int *status)
+{
+    ED25519_BATCH *b;
+    size_t i, n;
+    int ret = 1;
+
+    if ((b = OPENSSL_malloc(sizeof(*b))) == NULL) {
+        for (i = 0; i < num; i++)
+            status[i] = ED25519_verify(message[i], message_len[i],
+                                       signature[i], public_key[i]);
+    } else {
+        for (i = 0; i < num; i += n) {
+            n = num - i < ED25519_BATCH_MAX ? num - i : ED25519_BATCH_MAX;
+            ed25519_verify_batch_int(b, message + i, message_len + i,
+                                     signature + i, public_key + i, n,
+                                     status + i);
+        }
+        OPENSSL_free(b);
+    }
+    for (i = 0; i < num; i++)
+        if (status[i] != 1)
+            ret = 0;
+    return ret;
+}
+
 void ED25519_public_from_private(uint8_t out_public_key[32],
                                  const uint8_t private_key[32])
 {
@@ -5568,6 +6055,45 @@ int X25519(uint8_t out_shared_key[32], const uint8_t private_key[32],
     return CRYPTO_memcmp(kZeros, out_shared_key, 32) != 0;
 }
 
+/*
+ * Computes X25519(out_shared_key[i], private_key[i], peer_public_value[i])
+ * for |num| keys, setting status[i] to its return value.  Returns 1 if all
+ * of the shared keys are good.
+ */
+int X25519_multi(uint8_t *const *out_shared_key,
+                 const uint8_t *const *private_key,
+                 const uint8_t *const *peer_public_value, size_t num,
+                 int *status)
+{
+    static const uint8_t kZeros[32] = {0};
+    size_t i = 0, n;
+    int ret = 1;
+
+#ifdef X25519_MULTI_IMPLEMENTED
+    if (x25519_ifma_eligible()) {
+        /*
+         * A pass of the kernel takes a little less time than two ladders
+         * done one at a time, so a lone key left over is done singly.
+         */
+        for (; num - i >= X25519_MULTI_MIN; i += n) {
+            n = num - i < X25519_MULTI_LANES ? num - i : X25519_MULTI_LANES;
+            x25519_scalar_mult_multi(out_shared_key + i, private_key + i,
+                                     peer_public_value + i, n);
+        }
+        for (n = 0; n < i; n++) {
+            status[n] = CRYPTO_memcmp(kZeros, out_shared_key[n], 32) != 0;
+            ret &= status[n];
+        }
+    }
+#endif
+    for (; i < num; i++) {
+        status[i] = X25519(out_shared_key[i], private_key[i],
+                           peer_public_value[i]);
+        ret &= status[i];
+    }
+    return ret;
+}
+
 void X25519_public_from_private(uint8_t out_public_value[32],
                                 const uint8_t private_key[32])
 {
@@ -5595,3 +6121,32 @@ void X25519_public_from_private(uint8_t out_public_value[32],
 
     OPENSSL_cleanse(e, sizeof(e));
 }
+
+/*
+ * Computes X25519_public_from_private(out_public_value[i], private_key[i])
+ * for |num| keys.  Going up the ladder from the base point is slower than
+ * ge_scalarmult_base() for one key, but not for eight at a time.
+ */
+void X25519_public_from_private_multi(uint8_t *const *out_public_value,
+                                      const uint8_t *const *private_key,
+                                      size_t num)
+{
+    size_t i = 0;
+#ifdef X25519_MULTI_IMPLEMENTED
+    static const uint8_t kBasePoint[32] = {9};
+    const uint8_t *point[X25519_MULTI_LANES];
+    size_t n;
+
+    if (x25519_ifma_eligible()) {
+        for (n = 0; n < X25519_MULTI_LANES; n++)
+            point[n] = kBasePoint;
+        for (; num - i >= X25519_MULTI_MIN; i += n) {
+            n = num - i < X25519_MULTI_LANES ? num - i : X25519_MULTI_LANES;
+            x25519_scalar_mult_multi(out_public_value + i, private_key + i,
+                                     point, n);
+        }
+    }
+#endif
+    for (; i < num; i++)
+        X25519_public_from_private(out_public_value[i], private_key[i]);
+}
@@ -519,6 +519,9 @@ static int ec_pkey_ctrl(EVP_PKEY *pkey, int op, long arg1, void *arg2)
         return EC_KEY_key2buf(EVP_PKEY_get0_EC_KEY(pkey),
                               POINT_CONVERSION_UNCOMPRESSED, arg2, NULL);
 
+    case ASN1_PKEY_CTRL_SET_PUB_PRECOMPUTE:
+        return EC_KEY_set_pub_precompute(EVP_PKEY_get0_EC_KEY(pkey), (int)arg1);
+
     default:
         return -2;
 
@@ -64,6 +64,7 @@ void EC_KEY_free(EC_KEY *r)
     CRYPTO_free_ex_data(CRYPTO_EX_INDEX_EC_KEY, r, &r->ex_data);
     CRYPTO_THREAD_lock_free(r->lock);
     EC_GROUP_free(r->group);
+    EC_GROUP_free(r->pub_group);
     EC_POINT_free(r->pub_key);
     BN_clear_free(r->priv_key);
 
@@ -100,6 +101,9 @@ EC_KEY *EC_KEY_copy(EC_KEY *dest, const EC_KEY *src)
 
         /*  copy the public key */
         if (src->pub_key != NULL) {
+            EC_GROUP_free(dest->pub_group);
+            dest->pub_group = NULL;
+            dest->pub_uses = 0;
             EC_POINT_free(dest->pub_key);
             dest->pub_key = EC_POINT_new(src->group);
             if (dest->pub_key == NULL)
@@ -128,6 +132,7 @@ EC_KEY *EC_KEY_copy(EC_KEY *dest, const EC_KEY *src)
     dest->conv_form = src->conv_form;
     dest->version = src->version;
     dest->flags = src->flags;
+    dest->pub_precomp_uses = src->pub_precomp_uses;
     if (!CRYPTO_dup_ex_data(CRYPTO_EX_INDEX_EC_KEY,
                             &dest->ex_data, &src->ex_data))
         return NULL;
@@ -406,6 +411,9 @@ int EC_KEY_set_group(EC_KEY *key, const EC_GROUP *group)
         return 0;
     EC_GROUP_free(key->group);
     key->group = EC_GROUP_dup(group);
+    EC_GROUP_free(key->pub_group);
+    key->pub_group = NULL;
+    key->pub_uses = 0;
     return (key->group == NULL) ? 0 : 1;
 }
 
@@ -441,6 +449,9 @@ int EC_KEY_set_public_key(EC_KEY *key, const EC_POINT *pub_key)
         return 0;
     EC_POINT_free(key->pub_key);
     key->pub_key = EC_POINT_dup(pub_key, key->group);
+    EC_GROUP_free(key->pub_group);
+    key->pub_group = NULL;
+    key->pub_uses = 0;
     return (key->pub_key == NULL) ? 0 : 1;
 }
 
@@ -479,6 +490,120 @@ int EC_KEY_precompute_mult(EC_KEY *key, BN_CTX *ctx)
     return EC_GROUP_precompute_mult(key->group, ctx);
 }
 
+int EC_KEY_set_pub_precompute(EC_KEY *key, int uses)
+{
+    if (uses < 0)
+        return 0;
+    key->pub_precomp_uses = uses;
+    key->pub_uses = 0;
+    return 1;
+}
+
+/*
+ * Tables only pay off where the fixed-base multiplication of the group does
+ * not fall back to the ladder, which the GF(2^m) code does.
+ */
+static int ec_key_pub_precompute_capable(const EC_GROUP *group)
+{
+    return group->meth->mul == NULL || group->meth->precompute_mult != NULL;
+}
+
+/* A copy of the group of |key| with pub_key as its precomputed generator */
+static EC_GROUP *ec_key_pub_group_new(const EC_KEY *key, BN_CTX *ctx)
+{
+    EC_GROUP *pub_group = EC_GROUP_dup(key->group);
+
+    if (pub_group == NULL
+            || !EC_GROUP_set_generator(pub_group, key->pub_key,
+                                       key->group->order, key->group->cofactor)
+            || !EC_GROUP_precompute_mult(pub_group, ctx)) {
+        EC_GROUP_free(pub_group);
+        return NULL;
+    }
+    EC_GROUP_set_curve_name(pub_group, NID_undef);
+    return pub_group;
+}
+
+static int ec_point_mul_generator_public(const EC_GROUP *group, EC_POINT *r,
+                                         const BIGNUM *scalar, BN_CTX *ctx)
+{
+    if (group->meth->mul == NULL)
+        return ec_wNAF_mul_public(group, r, scalar, 0, NULL, NULL, ctx);
+    return EC_POINT_mul(group, r, scalar, NULL, NULL, ctx);
+}
+
+/*-
+ * r := g_scalar * generator + p_scalar * pub_key, for scalars that are not
+ * secret such as those of signature verification.  Once the key has been
+ * used as often as set with EC_KEY_set_pub_precompute(), multiples of
+ * pub_key are precomputed as they are for the generator, and p_scalar *
+ * pub_key becomes a fixed-base multiplication too.
+ */
+int ec_key_public_mul(EC_KEY *key, EC_POINT *r, const BIGNUM *g_scalar,
+                      const BIGNUM *p_scalar, BN_CTX *ctx)
+{
+    const EC_GROUP *group = key->group;
+    const EC_GROUP *pub_group = NULL;
+    const EC_POINT *points[1];
+    const BIGNUM *scalars[1];
+    EC_GROUP *table;
+    EC_POINT *t;
+    int uses, ret;
+
+    if (key->pub_precomp_uses > 0 && ec_key_pub_precompute_capable(group)) {
+        if (!CRYPTO_THREAD_read_lock(key->lock))
+            return 0;
+        pub_group = key->pub_group;
+        CRYPTO_THREAD_unlock(key->lock);
+
+        /* The use that reaches the threshold builds the table */
+        if (pub_group == NULL
+                && CRYPTO_atomic_add(&key->pub_uses, 1, &uses, key->lock)
+                && uses == key->pub_precomp_uses
+                && (table = ec_key_pub_group_new(key, ctx)) != NULL) {
+            if (!CRYPTO_THREAD_write_lock(key->lock)) {
+                EC_GROUP_free(table);
+                return 0;
+            }
+            if (key->pub_group == NULL) {
+                key->pub_group = table;
+                table = NULL;
+            }
+            pub_group = key->pub_group;
+            CRYPTO_THREAD_unlock(key->lock);
+            EC_GROUP_free(table);
+        }
+
+        /* pub_key may have been replaced without EC_KEY_set_public_key() */
+        if (pub_group != NULL
+                && EC_POINT_cmp(group, key->pub_key,
+                                EC_GROUP_get0_generator(pub_group), ctx) != 0)
+            pub_group = NULL;
+    }
+
+    if (pub_group == NULL)
+        return EC_POINT_mul(group, r, g_scalar, key->pub_key, p_scalar, ctx);
+
+    /*
+     * Without multiples of the generator, share the doublings of both
+     * products instead.
+     */
+    if (group->meth->mul == NULL && !EC_GROUP_have_precompute_mult(group)) {
+        points[0] = EC_GROUP_get0_generator(group);
+        scalars[0] = g_scalar;
+        return ec_wNAF_mul_public(pub_group, r, p_scalar, 1, points, scalars,
+                                  ctx);
+    }
+
+    if ((t = EC_POINT_new(group)) == NULL)
+        return 0;
+    ret = ec_point_mul_generator_public(group, r, g_scalar, ctx)
+          && ec_point_mul_generator_public(pub_group, t, p_scalar, ctx)
+          && EC_POINT_add(group, r, r, t, ctx);
+    EC_POINT_free(t);
+    return ret;
+}
+
 int EC_KEY_get_flags(const EC_KEY *key)
 {
     return key->flags;
@@ -288,6 +288,10 @@ struct ec_key_st {
     int flags;
     CRYPTO_EX_DATA ex_data;
     CRYPTO_RWLOCK *lock;
+    /* Multiples of pub_key, see EC_KEY_set_pub_precompute() */
+    int pub_precomp_uses;
+    int pub_uses;
+    EC_GROUP *pub_group;
 };
 
 struct ec_point_st {
@@ -339,6 +343,10 @@ void EC_ec_pre_comp_free(EC_PRE_COMP *);
 int ec_wNAF_mul(const EC_GROUP *group, EC_POINT *r, const BIGNUM *scalar,
                 size_t num, const EC_POINT *points[], const BIGNUM *scalars[],
                 BN_CTX *);
+int ec_wNAF_mul_public(const EC_GROUP *group, EC_POINT *r,
+                       const BIGNUM *scalar, size_t num,
+                       const EC_POINT *points[], const BIGNUM *scalars[],
+                       BN_CTX *ctx);
 int ec_wNAF_precompute_mult(EC_GROUP *group, BN_CTX *);
 int ec_wNAF_have_precompute_mult(const EC_GROUP *group);
 
@@ -649,8 +657,14 @@ ECDSA_SIG *ossl_ecdsa_sign_sig(const unsigned char *dgst, int dgst_len,
                                EC_KEY *eckey);
 int ossl_ecdsa_verify(int type, const unsigned char *dgst, int dgst_len,
                       const unsigned char *sigbuf, int sig_len, EC_KEY *eckey);
+int ec_key_public_mul(EC_KEY *key, EC_POINT *r, const BIGNUM *g_scalar,
+                      const BIGNUM *p_scalar, BN_CTX *ctx);
+
 int ossl_ecdsa_verify_sig(const unsigned char *dgst, int dgst_len,
                           const ECDSA_SIG *sig, EC_KEY *eckey);
+int ossl_ecdsa_verify_batch(const unsigned char *const *dgst,
+                            const int *dgst_len, const ECDSA_SIG *const *sig,
+                            EC_KEY *const *eckey, size_t num, int *status);
 
 int ED25519_sign(uint8_t *out_sig, const uint8_t *message, size_t message_len,
                  const uint8_t public_key[32], const uint8_t private_key[32]);
@@ -658,11 +672,30 @@ int ED25519_verify(const uint8_t *message, size_t message_len,
                    const uint8_t signature[64], const uint8_t public_key[32]);
 void ED25519_public_from_private(uint8_t out_public_key[32],
                                  const uint8_t private_key[32]);
+typedef struct ed25519_table_st ED25519_TABLE;
+ED25519_TABLE *ED25519_table_new(const uint8_t public_key[32]);
+void ED25519_table_free(ED25519_TABLE *table);
+int ED25519_verify_table(const uint8_t *message, size_t message_len,
+                         const uint8_t signature[64],
+                         const uint8_t public_key[32],
+                         const ED25519_TABLE *table);
+int ED25519_verify_batch(const uint8_t *const *message,
+                         const size_t *message_len,
+                         const uint8_t *const *signature,
+                         const uint8_t *const *public_key, size_t num,
+                         int *status);
 
 int X25519(uint8_t out_shared_key[32], const uint8_t private_key[32],
            const uint8_t peer_public_value[32]);
+int X25519_multi(uint8_t *const *out_shared_key,
+                 const uint8_t *const *private_key,
+                 const uint8_t *const *peer_public_value, size_t num,
+                 int *status);
 void X25519_public_from_private(uint8_t out_public_value[32],
                                 const uint8_t private_key[32]);
+void X25519_public_from_private_multi(uint8_t *const *out_public_value,
+                                      const uint8_t *const *private_key,
+                                      size_t num);
 
 /*-
  * This functions computes a single point multiplication over the EC group,
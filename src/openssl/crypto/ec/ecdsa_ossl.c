@@ -314,10 +314,28 @@ int ossl_ecdsa_verify(int type, const unsigned char *dgst, int dgst_len,
     return ret;
 }
 
+static int ecdsa_digest_to_bn(BIGNUM *m, const unsigned char *dgst,
+                              int dgst_len, const BIGNUM *order)
+{
+    int i = BN_num_bits(order);
+
+    /*
+     * Need to truncate digest if it is too long: first truncate whole bytes.
+     */
+    if (8 * dgst_len > i)
+        dgst_len = (i + 7) / 8;
+    if (!BN_bin2bn(dgst, dgst_len, m))
+        return 0;
+    /* If still too long truncate remaining bits with a shift */
+    if ((8 * dgst_len > i) && !BN_rshift(m, m, 8 - (i & 0x7)))
+        return 0;
+    return 1;
+}
+
 int ossl_ecdsa_verify_sig(const unsigned char *dgst, int dgst_len,
                           const ECDSA_SIG *sig, EC_KEY *eckey)
 {
-    int ret = -1, i;
+    int ret = -1;
     BN_CTX *ctx;
     const BIGNUM *order;
     BIGNUM *u1, *u2, *m, *X;
@@ -371,18 +389,7 @@ int ossl_ecdsa_verify_sig(const unsigned char *dgst, int dgst_len,
         goto err;
     }
     /* digest -> m */
-    i = BN_num_bits(order);
-    /*
-     * Need to truncate digest if it is too long: first truncate whole bytes.
-     */
-    if (8 * dgst_len > i)
-        dgst_len = (i + 7) / 8;
-    if (!BN_bin2bn(dgst, dgst_len, m)) {
-        ECerr(EC_F_OSSL_ECDSA_VERIFY_SIG, ERR_R_BN_LIB);
-        goto err;
-    }
-    /* If still too long truncate remaining bits with a shift */
-    if ((8 * dgst_len > i) && !BN_rshift(m, m, 8 - (i & 0x7))) {
+    if (!ecdsa_digest_to_bn(m, dgst, dgst_len, order)) {
         ECerr(EC_F_OSSL_ECDSA_VERIFY_SIG, ERR_R_BN_LIB);
         goto err;
     }
@@ -401,7 +408,7 @@ int ossl_ecdsa_verify_sig(const unsigned char *dgst, int dgst_len,
         ECerr(EC_F_OSSL_ECDSA_VERIFY_SIG, ERR_R_MALLOC_FAILURE);
         goto err;
     }
-    if (!EC_POINT_mul(group, point, u1, pub_key, u2, ctx)) {
+    if (!ec_key_public_mul(eckey, point, u1, u2, ctx)) {
         ECerr(EC_F_OSSL_ECDSA_VERIFY_SIG, ERR_R_EC_LIB);
         goto err;
     }
@@ -423,3 +430,149 @@ int ossl_ecdsa_verify_sig(const unsigned char *dgst, int dgst_len,
     EC_POINT_free(point);
     return ret;
 }
+
+/*-
+ * Verify |num| signatures made with keys that all have the group of
+ * eckey[0].  Each one is checked exactly as ossl_ecdsa_verify_sig() would,
+ * the difference being that the inversions of that function are shared:
+ * the s values are inverted together with Montgomery's trick and the
+ * points u1*G + u2*Q are converted to affine form together.
+ * status[i] receives the result for signature i.
+ */
+int ossl_ecdsa_verify_batch(const unsigned char *const *dgst,
+                            const int *dgst_len, const ECDSA_SIG *const *sig,
+                            EC_KEY *const *eckey, size_t num, int *status)
+{
+    int ret = -1;
+    BN_CTX *ctx = NULL;
+    const BIGNUM *order;
+    BIGNUM *u1, *u2, *m, *X, *inv, **w = NULL;
+    EC_POINT **points = NULL;
+    size_t *todo = NULL, i, k, n = 0;
+    const EC_GROUP *group = EC_KEY_get0_group(eckey[0]);
+
+    for (i = 0; i < num; i++)
+        status[i] = -1;
+
+    if (!EC_KEY_can_sign(eckey[0])) {
+        ECerr(EC_F_OSSL_ECDSA_VERIFY_BATCH,
+              EC_R_CURVE_DOES_NOT_SUPPORT_SIGNING);
+        return -1;
+    }
+
+    if ((ctx = BN_CTX_new()) == NULL) {
+        ECerr(EC_F_OSSL_ECDSA_VERIFY_BATCH, ERR_R_MALLOC_FAILURE);
+        return -1;
+    }
+    BN_CTX_start(ctx);
+    if ((w = OPENSSL_malloc(num * sizeof(*w))) == NULL
+            || (points = OPENSSL_zalloc(num * sizeof(*points))) == NULL
+            || (todo = OPENSSL_malloc(num * sizeof(*todo))) == NULL) {
+        ECerr(EC_F_OSSL_ECDSA_VERIFY_BATCH, ERR_R_MALLOC_FAILURE);
+        goto err;
+    }
+    u1 = BN_CTX_get(ctx);
+    u2 = BN_CTX_get(ctx);
+    m = BN_CTX_get(ctx);
+    X = BN_CTX_get(ctx);
+    inv = BN_CTX_get(ctx);
+    if (inv == NULL) {
+        ECerr(EC_F_OSSL_ECDSA_VERIFY_BATCH, ERR_R_BN_LIB);
+        goto err;
+    }
+    order = EC_GROUP_get0_order(group);
+
+    for (i = 0; i < num; i++) {
+        if (sig[i] == NULL || EC_KEY_get0_public_key(eckey[i]) == NULL) {
+            ECerr(EC_F_OSSL_ECDSA_VERIFY_BATCH, EC_R_MISSING_PARAMETERS);
+            continue;
+        }
+        if (BN_is_zero(sig[i]->r) || BN_is_negative(sig[i]->r) ||
+            BN_ucmp(sig[i]->r, order) >= 0 || BN_is_zero(sig[i]->s) ||
+            BN_is_negative(sig[i]->s) || BN_ucmp(sig[i]->s, order) >= 0) {
+            ECerr(EC_F_OSSL_ECDSA_VERIFY_BATCH, EC_R_BAD_SIGNATURE);
+            status[i] = 0;      /* signature is invalid */
+            continue;
+        }
+        todo[n++] = i;
+    }
+
+    /* w[k] = s_0 * ... * s_k, then a single inversion gives every inv(s) */
+    for (k = 0; k < n; k++) {
+        if ((w[k] = BN_CTX_get(ctx)) == NULL
+                || (k == 0 && !BN_copy(w[k], sig[todo[k]]->s))
+                || (k > 0 && !BN_mod_mul(w[k], w[k - 1], sig[todo[k]]->s,
+                                         order, ctx))) {
+            ECerr(EC_F_OSSL_ECDSA_VERIFY_BATCH, ERR_R_BN_LIB);
+            goto err;
+        }
+    }
+    if (n > 0 && !ec_group_do_inverse_ord(group, inv, w[n - 1], ctx)) {
+        ECerr(EC_F_OSSL_ECDSA_VERIFY_BATCH, ERR_R_BN_LIB);
+        goto err;
+    }
+    for (k = n; k-- > 0; ) {
+        if ((k > 0 && !BN_mod_mul(w[k], inv, w[k - 1], order, ctx))
+                || (k == 0 && !BN_copy(w[k], inv))
+                || !BN_mod_mul(inv, inv, sig[todo[k]]->s, order, ctx)) {
+            ECerr(EC_F_OSSL_ECDSA_VERIFY_BATCH, ERR_R_BN_LIB);
+            goto err;
+        }
+    }
+
+    for (k = 0; k < n; k++) {
+        i = todo[k];
+        if (!ecdsa_digest_to_bn(m, dgst[i], dgst_len[i], order)
+                || !BN_mod_mul(u1, m, w[k], order, ctx)
+                || !BN_mod_mul(u2, sig[i]->r, w[k], order, ctx)) {
+            ECerr(EC_F_OSSL_ECDSA_VERIFY_BATCH, ERR_R_BN_LIB);
+            goto err;
+        }
+        if ((points[k] = EC_POINT_new(group)) == NULL) {
+            ECerr(EC_F_OSSL_ECDSA_VERIFY_BATCH, ERR_R_MALLOC_FAILURE);
+            goto err;
+        }
+        if (!ec_key_public_mul(eckey[i], points[k], u1, u2, ctx)) {
+            ECerr(EC_F_OSSL_ECDSA_VERIFY_BATCH, ERR_R_EC_LIB);
+            goto err;
+        }
+    }
+    if (!EC_POINTs_make_affine(group, n, points, ctx)) {
+        ECerr(EC_F_OSSL_ECDSA_VERIFY_BATCH, ERR_R_EC_LIB);
+        goto err;
+    }
+
+    for (k = 0; k < n; k++) {
+        i = todo[k];
+        if (!EC_POINT_get_affine_coordinates(group, points[k], X, NULL, ctx)) {
+            ECerr(EC_F_OSSL_ECDSA_VERIFY_BATCH, ERR_R_EC_LIB);
+            continue;
+        }
+        if (!BN_nnmod(u1, X, order, ctx)) {
+            ECerr(EC_F_OSSL_ECDSA_VERIFY_BATCH, ERR_R_BN_LIB);
+            goto err;
+        }
+        /*  if the signature is correct u1 is equal to sig->r */
+        status[i] = (BN_ucmp(u1, sig[i]->r) == 0);
+    }
+
+    ret = 1;
+    for (i = 0; i < num; i++) {
+        if (status[i] < 0) {
+            ret = -1;
+            break;
+        }
+        if (status[i] == 0)
+            ret = 0;
+    }
+ err:
+    if (points != NULL)
+        for (k = 0; k < n; k++)
+            EC_POINT_free(points[k]);
+    OPENSSL_free(points);
+    OPENSSL_free(todo);
+    OPENSSL_free(w);
+    BN_CTX_end(ctx);
+    BN_CTX_free(ctx);
+    return ret;
+}
@@ -26,6 +26,56 @@ int ECDSA_do_verify(const unsigned char *dgst, int dgst_len,
     return -1;
 }
 
+/*
+ * Keys can be verified in one batch if they use the built-in method and
+ * share a curve.
+ */
+static int ecdsa_batch_compat(const EC_KEY *eckey, const EC_GROUP *group)
+{
+    if (eckey->meth->verify_sig != ossl_ecdsa_verify_sig
+            || eckey->group == NULL)
+        return 0;
+    if (eckey->group == group)
+        return 1;
+    return EC_GROUP_get_curve_name(group) != NID_undef
+           && EC_GROUP_get_curve_name(eckey->group)
+              == EC_GROUP_get_curve_name(group)
+           && EC_GROUP_method_of(eckey->group) == EC_GROUP_method_of(group);
+}
+
+/*-
+ * returns
+ *      1: all signatures correct
+ *      0: at least one incorrect signature
+ *     -1: error
+ * and the result of ECDSA_do_verify() for each signature in |status|.
+ */
+int ECDSA_do_verify_batch(const unsigned char *const *dgst,
+                          const int *dgst_len, const ECDSA_SIG *const *sig,
+                          EC_KEY *const *eckey, size_t num, int *status)
+{
+    size_t i;
+    int ret = 1;
+
+    if (num == 0)
+        return 1;
+    for (i = 0; i < num; i++)
+        if (!ecdsa_batch_compat(eckey[i], eckey[0]->group))
+            break;
+    if (i == num)
+        return ossl_ecdsa_verify_batch(dgst, dgst_len, sig, eckey, num,
+                                       status);
+
+    for (i = 0; i < num; i++) {
+        status[i] = ECDSA_do_verify(dgst[i], dgst_len[i], sig[i], eckey[i]);
+        if (status[i] < 0)
+            ret = -1;
+        else if (status[i] == 0 && ret > 0)
+            ret = 0;
+    }
+    return ret;
+}
+
 /*-
  * returns
  *      1: correct signature
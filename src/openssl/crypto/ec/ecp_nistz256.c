@@ -1398,9 +1398,14 @@ __owur static int ecp_nistz256_get_affine(const EC_GROUP *group,
         return 0;
     }
 
-    ecp_nistz256_mod_inverse(z_inv3, point_z);
-    ecp_nistz256_sqr_mont(z_inv2, z_inv3);
-    ecp_nistz256_mul_mont(x_aff, z_inv2, point_x);
+    /* No inversion is needed after EC_POINTs_make_affine() */
+    if (point->Z_is_one) {
+        memcpy(x_aff, point_x, sizeof(x_aff));
+    } else {
+        ecp_nistz256_mod_inverse(z_inv3, point_z);
+        ecp_nistz256_sqr_mont(z_inv2, z_inv3);
+        ecp_nistz256_mul_mont(x_aff, z_inv2, point_x);
+    }
 
     if (x != NULL) {
         ecp_nistz256_from_mont(x_ret, x_aff);
@@ -1409,8 +1414,12 @@ __owur static int ecp_nistz256_get_affine(const EC_GROUP *group,
     }
 
     if (y != NULL) {
-        ecp_nistz256_mul_mont(z_inv3, z_inv3, z_inv2);
-        ecp_nistz256_mul_mont(y_aff, z_inv3, point_y);
+        if (point->Z_is_one) {
+            memcpy(y_aff, point_y, sizeof(y_aff));
+        } else {
+            ecp_nistz256_mul_mont(z_inv3, z_inv3, z_inv2);
+            ecp_nistz256_mul_mont(y_aff, z_inv3, point_y);
+        }
         ecp_nistz256_from_mont(y_ret, y_aff);
         if (!bn_set_words(y, y_ret, P256_LIMBS))
             return 0;
@@ -254,8 +254,10 @@ static int ecx_security_bits(const EVP_PKEY *pkey)
 
 static void ecx_free(EVP_PKEY *pkey)
 {
-    if (pkey->pkey.ecx != NULL)
+    if (pkey->pkey.ecx != NULL) {
         OPENSSL_secure_clear_free(pkey->pkey.ecx->privkey, KEYLEN(pkey));
+        ED25519_table_free(pkey->pkey.ecx->pub_table);
+    }
     OPENSSL_free(pkey->pkey.ecx);
 }
 
@@ -346,6 +348,14 @@ static int ecd_ctrl(EVP_PKEY *pkey, int op, long arg1, void *arg2)
         *(int *)arg2 = NID_undef;
         return 2;
 
+    case ASN1_PKEY_CTRL_SET_PUB_PRECOMPUTE:
+        if (pkey->ameth->pkey_id != EVP_PKEY_ED25519
+                || pkey->pkey.ecx == NULL || arg1 < 0)
+            return 0;
+        pkey->pkey.ecx->pub_precomp_uses = (int)arg1;
+        pkey->pkey.ecx->pub_uses = 0;
+        return 1;
+
     default:
         return -2;
 
@@ -735,6 +745,107 @@ const EVP_PKEY_METHOD ecx448_pkey_meth = {
     0
 };
 
+/*
+ * Generate X25519 keys into the |num| empty keys |pkey|, computing the
+ * public keys together.  On failure some of the keys may have been assigned,
+ * and the caller frees them all.
+ */
+int ecx_x25519_keygen_multi(EVP_PKEY *const *pkey, size_t num)
+{
+    const unsigned char **priv = NULL;
+    unsigned char **pub = NULL;
+    unsigned char *privkey;
+    ECX_KEY *key;
+    size_t i;
+    int ret = 0;
+
+    if ((priv = OPENSSL_malloc(num * sizeof(*priv))) == NULL
+            || (pub = OPENSSL_malloc(num * sizeof(*pub))) == NULL) {
+        ECerr(EC_F_ECX_X25519_KEYGEN_MULTI, ERR_R_MALLOC_FAILURE);
+        goto err;
+    }
+
+    for (i = 0; i < num; i++) {
+        if ((key = OPENSSL_zalloc(sizeof(*key))) == NULL) {
+            ECerr(EC_F_ECX_X25519_KEYGEN_MULTI, ERR_R_MALLOC_FAILURE);
+            goto err;
+        }
+        EVP_PKEY_assign(pkey[i], EVP_PKEY_X25519, key);
+        privkey = key->privkey = OPENSSL_secure_malloc(X25519_KEYLEN);
+        if (privkey == NULL) {
+            ECerr(EC_F_ECX_X25519_KEYGEN_MULTI, ERR_R_MALLOC_FAILURE);
+            goto err;
+        }
+        if (RAND_priv_bytes(privkey, X25519_KEYLEN) <= 0)
+            goto err;
+        privkey[0] &= 248;
+        privkey[X25519_KEYLEN - 1] &= 127;
+        privkey[X25519_KEYLEN - 1] |= 64;
+        priv[i] = privkey;
+        pub[i] = key->pubkey;
+    }
+    X25519_public_from_private_multi(pub, priv, num);
+    ret = 1;
+
+ err:
+    OPENSSL_free(priv);
+    OPENSSL_free(pub);
+    return ret;
+}
+
+/*
+ * Derive the shared secrets of the X25519 contexts among the |num| in |ctx|
+ * together, setting keylen[i] to 0 for those that fail.  The other contexts
+ * are left alone.
+ */
+int ecx_x25519_derive_multi(EVP_PKEY_CTX *const *ctx,
+                            unsigned char *const *key, size_t *keylen,
+                            size_t num)
+{
+    const unsigned char **priv = NULL, **pub = NULL;
+    unsigned char **out = NULL;
+    size_t *idx = NULL, i, n = 0;
+    int *status = NULL, ret = 0;
+
+    if ((priv = OPENSSL_malloc(num * sizeof(*priv))) == NULL
+            || (pub = OPENSSL_malloc(num * sizeof(*pub))) == NULL
+            || (out = OPENSSL_malloc(num * sizeof(*out))) == NULL
+            || (idx = OPENSSL_malloc(num * sizeof(*idx))) == NULL
+            || (status = OPENSSL_malloc(num * sizeof(*status))) == NULL) {
+        ECerr(EC_F_ECX_X25519_DERIVE_MULTI, ERR_R_MALLOC_FAILURE);
+        goto err;
+    }
+
+    for (i = 0; i < num; i++) {
+        if (ctx[i] == NULL || ctx[i]->pmeth != &ecx25519_pkey_meth
+                || ctx[i]->operation != EVP_PKEY_OP_DERIVE)
+            continue;
+        if (!validate_ecx_derive(ctx[i], key[i], &keylen[i], &priv[n],
+                                 &pub[n])) {
+            keylen[i] = 0;
+            continue;
+        }
+        keylen[i] = X25519_KEYLEN;
+        if (key[i] != NULL) {
+            out[n] = key[i];
+            idx[n++] = i;
+        }
+    }
+    X25519_multi(out, priv, pub, n, status);
+    for (i = 0; i < n; i++)
+        if (!status[i])
+            keylen[idx[i]] = 0;
+    ret = 1;
+
+ err:
+    OPENSSL_free(priv);
+    OPENSSL_free(pub);
+    OPENSSL_free(out);
+    OPENSSL_free(idx);
+    OPENSSL_free(status);
+    return ret;
+}
+
 static int pkey_ecd_digestsign25519(EVP_MD_CTX *ctx, unsigned char *sig,
                                     size_t *siglen, const unsigned char *tbs,
                                     size_t tbslen)
@@ -778,18 +889,116 @@ static int pkey_ecd_digestsign448(EVP_MD_CTX *ctx, unsigned char *sig,
     return 1;
 }
 
+/*
+ * The multiples of the public key of |pkey|, if it has been used as often as
+ * set with EVP_PKEY_set_pub_precompute().  The use that reaches the threshold
+ * builds them.
+ */
+static const ED25519_TABLE *ecd_pub_table(EVP_PKEY *pkey)
+{
+    ECX_KEY *edkey = pkey->pkey.ecx;
+    ED25519_TABLE *table;
+    const ED25519_TABLE *ret;
+    int uses;
+
+    if (edkey->pub_precomp_uses <= 0)
+        return NULL;
+
+    if (!CRYPTO_THREAD_read_lock(pkey->lock))
+        return NULL;
+    ret = edkey->pub_table;
+    CRYPTO_THREAD_unlock(pkey->lock);
+
+    if (ret == NULL
+            && CRYPTO_atomic_add(&edkey->pub_uses, 1, &uses, pkey->lock)
+            && uses == edkey->pub_precomp_uses
+            && (table = ED25519_table_new(edkey->pubkey)) != NULL) {
+        if (!CRYPTO_THREAD_write_lock(pkey->lock)) {
+            ED25519_table_free(table);
+            return NULL;
+        }
+        if (edkey->pub_table == NULL) {
+            edkey->pub_table = table;
+            table = NULL;
+        }
+        ret = edkey->pub_table;
+        CRYPTO_THREAD_unlock(pkey->lock);
+        ED25519_table_free(table);
+    }
+    return ret;
+}
+
 static int pkey_ecd_digestverify25519(EVP_MD_CTX *ctx, const unsigned char *sig,
                                       size_t siglen, const unsigned char *tbs,
                                       size_t tbslen)
 {
-    const ECX_KEY *edkey = EVP_MD_CTX_pkey_ctx(ctx)->pkey->pkey.ecx;
+    EVP_PKEY *pkey = EVP_MD_CTX_pkey_ctx(ctx)->pkey;
+    const ECX_KEY *edkey = pkey->pkey.ecx;
+    const ED25519_TABLE *table;
 
     if (siglen != ED25519_SIGSIZE)
         return 0;
 
+    if ((table = ecd_pub_table(pkey)) != NULL)
+        return ED25519_verify_table(tbs, tbslen, sig, edkey->pubkey, table);
     return ED25519_verify(tbs, tbslen, sig, edkey->pubkey);
 }
 
+/*
+ * EVP_DigestVerify_multi() for the entries whose key is an Ed25519 key, the
+ * others are left alone.  Precomputed tables are not used: signatures by the
+ * same key share their work in a batch, which is faster than the table.
+ */
+int ecx_ed25519_verify_multi(EVP_PKEY *const *pkey,
+                             const unsigned char *const *sig,
+                             const size_t *siglen,
+                             const unsigned char *const *tbs,
+                             const size_t *tbslen, size_t num, int *status)
+{
+    const unsigned char **bsig = NULL, **btbs = NULL, **bpub = NULL;
+    size_t *btbslen = NULL, *idx = NULL, i, n = 0;
+    int *bstatus = NULL, ret = 0;
+
+    if ((bsig = OPENSSL_malloc(num * sizeof(*bsig))) == NULL
+            || (btbs = OPENSSL_malloc(num * sizeof(*btbs))) == NULL
+            || (bpub = OPENSSL_malloc(num * sizeof(*bpub))) == NULL
+            || (btbslen = OPENSSL_malloc(num * sizeof(*btbslen))) == NULL
+            || (idx = OPENSSL_malloc(num * sizeof(*idx))) == NULL
+            || (bstatus = OPENSSL_malloc(num * sizeof(*bstatus))) == NULL) {
+        ECerr(EC_F_ECX_ED25519_VERIFY_MULTI, ERR_R_MALLOC_FAILURE);
+        goto err;
+    }
+
+    for (i = 0; i < num; i++) {
+        const ECX_KEY *edkey = pkey[i]->pkey.ecx;
+
+        if (pkey[i]->ameth != &ed25519_asn1_meth)
+            continue;
+        if (edkey == NULL || siglen[i] != ED25519_SIGSIZE) {
+            status[i] = 0;
+        } else {
+            bsig[n] = sig[i];
+            btbs[n] = tbs[i];
+            btbslen[n] = tbslen[i];
+            bpub[n] = edkey->pubkey;
+            idx[n++] = i;
+        }
+    }
+    ED25519_verify_batch(btbs, btbslen, bsig, bpub, n, bstatus);
+    for (i = 0; i < n; i++)
+        status[idx[i]] = bstatus[i];
+    ret = 1;
+
+ err:
+    OPENSSL_free(bsig);
+    OPENSSL_free(btbs);
+    OPENSSL_free(bpub);
+    OPENSSL_free(btbslen);
+    OPENSSL_free(idx);
+    OPENSSL_free(bstatus);
+    return ret;
+}
+
 static int pkey_ecd_digestverify448(EVP_MD_CTX *ctx, const unsigned char *sig,
                                     size_t siglen, const unsigned char *tbs,
                                     size_t tbslen)
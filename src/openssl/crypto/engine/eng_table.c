@@ -8,10 +8,27 @@
  */
 
 #include "internal/cryptlib.h"
+#include "internal/tsan_assist.h"
 #include <openssl/evp.h>
 #include <openssl/lhash.h>
+#include <openssl/objects.h>
 #include "eng_local.h"
 
+#ifdef tsan_ld_acq
+/*
+ * Each table keeps a dispatch array, indexed by nid, of what
+ * engine_table_select() returns for that nid: NULL if nothing is registered
+ * or nothing would initialise, the pile's default ENGINE, or
+ * PILE_UNRESOLVED if the pile has to be looked at under the lock.  Entries
+ * are only written with |global_engine_lock| held for writing, whenever the
+ * corresponding pile changes, so the common case of no ENGINE takes no lock
+ * at all and a cached default ENGINE only needs a read lock to take its
+ * functional reference.
+ */
+static int pile_unresolved;
+# define PILE_UNRESOLVED ((ENGINE *)&pile_unresolved)
+#endif
+
 /* The type of the items in the table */
 struct st_engine_pile {
     /* The 'nid' of this algorithm/mode */
@@ -24,11 +41,24 @@ struct st_engine_pile {
      * Zero if 'sk' is newer than the cached 'funct', non-zero otherwise
      */
     int uptodate;
+#ifdef tsan_ld_acq
+    /* This nid's entry in the table's dispatch array, if it has one */
+    ENGINE *TSAN_QUALIFIER *dispatch;
+#endif
 };
 
 /* The type exposed in eng_local.h */
 struct st_engine_table {
-    LHASH_OF(ENGINE_PILE) piles;
+    LHASH_OF(ENGINE_PILE) *piles;
+#ifdef tsan_ld_acq
+    /*
+     * Size of |dispatch|, read without the lock by engine_table_select() so
+     * it is only ever accessed atomically.  It stays 0 until |dispatch| is
+     * set up.
+     */
+    TSAN_QUALIFIER int num_dispatch;
+    ENGINE *TSAN_QUALIFIER *dispatch;
+#endif
 };                              /* ENGINE_TABLE */
 
 typedef struct st_engine_pile_doall {
@@ -63,18 +93,54 @@ static int engine_pile_cmp(const ENGINE_PILE *a, const ENGINE_PILE *b)
 
 static int int_table_check(ENGINE_TABLE **t, int create)
 {
-    LHASH_OF(ENGINE_PILE) *lh;
+    ENGINE_TABLE *table;
+#ifdef tsan_ld_acq
+    int n;
+#endif
 
     if (*t)
         return 1;
     if (!create)
         return 0;
-    if ((lh = lh_ENGINE_PILE_new(engine_pile_hash, engine_pile_cmp)) == NULL)
+    if ((table = OPENSSL_zalloc(sizeof(*table))) == NULL)
         return 0;
-    *t = (ENGINE_TABLE *)lh;
+    if ((table->piles = lh_ENGINE_PILE_new(engine_pile_hash,
+                                           engine_pile_cmp)) == NULL) {
+        OPENSSL_free(table);
+        return 0;
+    }
+#ifdef tsan_ld_acq
+    /*
+     * Cover the built-in nids; anything created at run time just goes
+     * through the lock.  All entries start out as "no ENGINE".
+     */
+    n = OBJ_new_nid(0);
+    table->dispatch = OPENSSL_zalloc(sizeof(*table->dispatch) * n);
+    if (table->dispatch != NULL)
+        tsan_st_rel(&table->num_dispatch, n);
+#endif
+    *t = table;
     return 1;
 }
 
+/*
+ * Record what engine_table_select() would return for |pile| in the dispatch
+ * array.  Must be called with |global_engine_lock| held for writing after any
+ * change to the pile.
+ */
+static void int_pile_dispatch(ENGINE_PILE *pile)
+{
+#ifdef tsan_ld_acq
+    ENGINE *e = pile->funct;
+
+    if (pile->dispatch == NULL)
+        return;
+    if (e == NULL && !pile->uptodate)
+        e = PILE_UNRESOLVED;
+    tsan_st_rel(pile->dispatch, e);
+#endif
+}
+
 /*
  * Privately exposed (via eng_local.h) functions for adding and/or removing
  * ENGINEs from the implementation table
@@ -95,7 +161,7 @@ int engine_table_register(ENGINE_TABLE **table, ENGINE_CLEANUP_CB *cleanup,
         engine_cleanup_add_first(cleanup);
     while (num_nids--) {
         tmplate.nid = *nids;
-        fnd = lh_ENGINE_PILE_retrieve(&(*table)->piles, &tmplate);
+        fnd = lh_ENGINE_PILE_retrieve((*table)->piles, &tmplate);
         if (!fnd) {
             fnd = OPENSSL_malloc(sizeof(*fnd));
             if (fnd == NULL)
@@ -108,8 +174,14 @@ int engine_table_register(ENGINE_TABLE **table, ENGINE_CLEANUP_CB *cleanup,
                 goto end;
             }
             fnd->funct = NULL;
-            (void)lh_ENGINE_PILE_insert(&(*table)->piles, fnd);
-            if (lh_ENGINE_PILE_retrieve(&(*table)->piles, &tmplate) != fnd) {
+#ifdef tsan_ld_acq
+            fnd->dispatch = NULL;
+            if (fnd->nid >= 0
+                    && fnd->nid < tsan_load(&(*table)->num_dispatch))
+                fnd->dispatch = &(*table)->dispatch[fnd->nid];
+#endif
+            (void)lh_ENGINE_PILE_insert((*table)->piles, fnd);
+            if (lh_ENGINE_PILE_retrieve((*table)->piles, &tmplate) != fnd) {
                 sk_ENGINE_free(fnd->sk);
                 OPENSSL_free(fnd);
                 goto end;
@@ -124,6 +196,7 @@ int engine_table_register(ENGINE_TABLE **table, ENGINE_CLEANUP_CB *cleanup,
             goto end;
         /* "touch" this ENGINE_PILE */
         fnd->uptodate = 0;
+        int_pile_dispatch(fnd);
         if (setdefault) {
             if (!engine_unlocked_init(e)) {
                 ENGINEerr(ENGINE_F_ENGINE_TABLE_REGISTER,
@@ -134,6 +207,7 @@ int engine_table_register(ENGINE_TABLE **table, ENGINE_CLEANUP_CB *cleanup,
                 engine_unlocked_finish(fnd->funct, 0);
             fnd->funct = e;
             fnd->uptodate = 1;
+            int_pile_dispatch(fnd);
         }
         nids++;
     }
@@ -155,6 +229,7 @@ static void int_unregister_cb(ENGINE_PILE *pile, ENGINE *e)
         engine_unlocked_finish(e, 0);
         pile->funct = NULL;
     }
+    int_pile_dispatch(pile);
 }
 
 IMPLEMENT_LHASH_DOALL_ARG(ENGINE_PILE, ENGINE);
@@ -163,7 +238,7 @@ void engine_table_unregister(ENGINE_TABLE **table, ENGINE *e)
 {
     CRYPTO_THREAD_write_lock(global_engine_lock);
     if (int_table_check(table, 0))
-        lh_ENGINE_PILE_doall_ENGINE(&(*table)->piles, int_unregister_cb, e);
+        lh_ENGINE_PILE_doall_ENGINE((*table)->piles, int_unregister_cb, e);
     CRYPTO_THREAD_unlock(global_engine_lock);
 }
 
@@ -181,8 +256,13 @@ void engine_table_cleanup(ENGINE_TABLE **table)
 {
     CRYPTO_THREAD_write_lock(global_engine_lock);
     if (*table) {
-        lh_ENGINE_PILE_doall(&(*table)->piles, int_cleanup_cb_doall);
-        lh_ENGINE_PILE_free(&(*table)->piles);
+        lh_ENGINE_PILE_doall((*table)->piles, int_cleanup_cb_doall);
+        lh_ENGINE_PILE_free((*table)->piles);
+#ifdef tsan_ld_acq
+        tsan_st_rel(&(*table)->num_dispatch, 0);
+        OPENSSL_free((void *)(*table)->dispatch);
+#endif
+        OPENSSL_free(*table);
         *table = NULL;
     }
     CRYPTO_THREAD_unlock(global_engine_lock);
@@ -207,6 +287,33 @@ ENGINE *engine_table_select_tmp(ENGINE_TABLE **table, int nid, const char *f,
 #endif
         return NULL;
     }
+#ifdef tsan_ld_acq
+    if (nid >= 0 && nid < tsan_ld_acq(&(*table)->num_dispatch)) {
+        ret = tsan_ld_acq(&(*table)->dispatch[nid]);
+        if (ret == NULL)
+            return NULL;
+        if (ret != PILE_UNRESOLVED) {
+            /*
+             * The pile holds a functional reference to its default ENGINE,
+             * which can't be dropped while we hold the lock, so we only have
+             * to bump the counts.  Writers are excluded by the lock, other
+             * readers only ever increment them.
+             */
+            CRYPTO_THREAD_read_lock(global_engine_lock);
+            if (int_table_check(table, 0)
+                    && tsan_load(&(*table)->dispatch[nid]) == ret) {
+                tsan_counter((TSAN_QUALIFIER int *)&ret->struct_ref);
+                tsan_counter((TSAN_QUALIFIER int *)&ret->funct_ref);
+                engine_ref_debug(ret, 0, 1);
+                engine_ref_debug(ret, 1, 1);
+                CRYPTO_THREAD_unlock(global_engine_lock);
+                return ret;
+            }
+            CRYPTO_THREAD_unlock(global_engine_lock);
+        }
+        ret = NULL;
+    }
+#endif
     ERR_set_mark();
     CRYPTO_THREAD_write_lock(global_engine_lock);
     /*
@@ -216,7 +323,7 @@ ENGINE *engine_table_select_tmp(ENGINE_TABLE **table, int nid, const char *f,
     if (!int_table_check(table, 0))
         goto end;
     tmplate.nid = nid;
-    fnd = lh_ENGINE_PILE_retrieve(&(*table)->piles, &tmplate);
+    fnd = lh_ENGINE_PILE_retrieve((*table)->piles, &tmplate);
     if (!fnd)
         goto end;
     if (fnd->funct && engine_unlocked_init(fnd->funct)) {
@@ -269,8 +376,10 @@ ENGINE *engine_table_select_tmp(ENGINE_TABLE **table, int nid, const char *f,
      * If it failed, it is unlikely to succeed again until some future
      * registrations have taken place. In all cases, we cache.
      */
-    if (fnd)
+    if (fnd) {
         fnd->uptodate = 1;
+        int_pile_dispatch(fnd);
+    }
 #ifdef ENGINE_TABLE_DEBUG
     if (ret)
         fprintf(stderr, "engine_table_dbg: %s:%d, nid=%d, caching "
@@ -304,5 +413,5 @@ void engine_table_doall(ENGINE_TABLE *table, engine_table_doall_cb *cb,
     dall.cb = cb;
     dall.arg = arg;
     if (table)
-        lh_ENGINE_PILE_doall_ENGINE_PILE_DOALL(&table->piles, int_dall, &dall);
+        lh_ENGINE_PILE_doall_ENGINE_PILE_DOALL(table->piles, int_dall, &dall);
 }
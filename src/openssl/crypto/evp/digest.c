@@ -13,6 +13,7 @@
 #include <openssl/evp.h>
 #include <openssl/engine.h>
 #include "crypto/evp.h"
+#include "crypto/sha.h"
 #include "evp_local.h"
 
 /* This call frees resources associated with the context */
@@ -289,6 +290,60 @@ int EVP_Digest(const void *data, size_t count,
     return ret;
 }
 
+int EVP_Digest_multi(const void *const *data, const size_t *count,
+                     size_t num, unsigned char *md, const EVP_MD *type,
+                     ENGINE *impl)
+{
+    int (*digest_multi)(const void *const *, const size_t *, size_t,
+                        unsigned char *) = NULL;
+#ifndef OPENSSL_NO_ENGINE
+    ENGINE *e;
+#endif
+    EVP_MD_CTX *ctx;
+    size_t i, mdsize = EVP_MD_size(type);
+    int ret = 1;
+
+    /*
+     * The built in SHA-1 and SHA-2 digests can hash several messages at a
+     * time, unless an ENGINE is to be used for them.
+     */
+    if (impl == NULL) {
+        if (type == EVP_sha1())
+            digest_multi = sha1_digest_multi;
+        else if (type == EVP_sha224())
+            digest_multi = sha224_digest_multi;
+        else if (type == EVP_sha256())
+            digest_multi = sha256_digest_multi;
+#ifndef OPENSSL_NO_ENGINE
+        if (digest_multi != NULL
+                && (e = ENGINE_get_digest_engine(type->type)) != NULL) {
+            ENGINE_finish(e);
+            digest_multi = NULL;
+        }
+#endif
+    }
+    if (digest_multi != NULL) {
+        if (!digest_multi(data, count, num, md)) {
+            EVPerr(EVP_F_EVP_DIGEST_MULTI, ERR_R_MALLOC_FAILURE);
+            return 0;
+        }
+        return 1;
+    }
+
+    if ((ctx = EVP_MD_CTX_new()) == NULL) {
+        EVPerr(EVP_F_EVP_DIGEST_MULTI, ERR_R_MALLOC_FAILURE);
+        return 0;
+    }
+    EVP_MD_CTX_set_flags(ctx, EVP_MD_CTX_FLAG_ONESHOT);
+    for (i = 0; ret && i < num; i++)
+        ret = EVP_DigestInit_ex(ctx, type, impl)
+            && EVP_DigestUpdate(ctx, data[i], count[i])
+            && EVP_DigestFinal_ex(ctx, md + i * mdsize, NULL);
+    EVP_MD_CTX_free(ctx);
+
+    return ret;
+}
+
 int EVP_MD_CTX_ctrl(EVP_MD_CTX *ctx, int cmd, int p1, void *p2)
 {
     if (ctx->digest && ctx->digest->md_ctrl) {
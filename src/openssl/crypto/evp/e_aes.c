@@ -12,6 +12,7 @@
 #include <openssl/evp.h>
 #include <openssl/err.h>
 #include <string.h>
+#include <limits.h>
 #include <assert.h>
 #include <openssl/aes.h>
 #include "crypto/evp.h"
@@ -2853,6 +2854,9 @@ static int aes_gcm_cleanup(EVP_CIPHER_CTX *c)
     return 1;
 }
 
+static int aes_gcm_multi(EVP_CIPHER_CTX *ctx, EVP_CTRL_AEAD_MULTI_PARAM *msg,
+                         size_t num);
+
 static int aes_gcm_ctrl(EVP_CIPHER_CTX *c, int type, int arg, void *ptr)
 {
     EVP_AES_GCM_CTX *gctx = EVP_C_DATA(EVP_AES_GCM_CTX,c);
@@ -2967,6 +2971,12 @@ static int aes_gcm_ctrl(EVP_CIPHER_CTX *c, int type, int arg, void *ptr)
         /* Extra padding: tag appended to record */
         return EVP_GCM_TLS_TAG_LEN;
 
+    case EVP_CTRL_AEAD_MULTI:
+        if (!gctx->key_set || gctx->tls_aad_len >= 0 || arg < 0
+                || (arg > 0 && ptr == NULL))
+            return 0;
+        return aes_gcm_multi(c, ptr, (size_t)arg);
+
     case EVP_CTRL_COPY:
         {
             EVP_CIPHER_CTX *out = ptr;
@@ -3317,6 +3327,183 @@ static int aes_gcm_cipher(EVP_CIPHER_CTX *ctx, unsigned char *out,
 
 }
 
+/*
+ * Batched GCM for many small messages under one key.  The counter blocks of
+ * a group of messages are encrypted together, so that the AES rounds of one
+ * message overlap with those of the next instead of each message paying for
+ * its own pipeline start-up, and each message is then hashed with a single
+ * GHASH pass over its AAD, text and lengths.
+ */
+# define GCM_MULTI_BLOCKS        128
+/* Longer messages are faster on the stitched code of aes_gcm_cipher() */
+# define GCM_MULTI_MAX_LEN       512
+
+static void aes_gcm_multi_ecb(EVP_AES_GCM_CTX *gctx, unsigned char *buf,
+                              size_t len)
+{
+    size_t i;
+
+# ifdef AESNI_CAPABLE
+    if (gctx->gcm.block == (block128_f)aesni_encrypt) {
+        aesni_ecb_encrypt(buf, buf, len, gctx->gcm.key, 1);
+        return;
+    }
+# endif
+    for (i = 0; i < len; i += 16)
+        (*gctx->gcm.block)(buf + i, buf + i, gctx->gcm.key);
+}
+
+static void aes_gcm_multi_ghash(GCM128_CONTEXT *gcm, const unsigned char *in,
+                                size_t len)
+{
+    unsigned char block[16];
+    size_t full = len & ~(size_t)15;
+
+    gcm128_ghash_blocks(gcm, in, full);
+    if (len > full) {
+        memset(block, 0, sizeof(block));
+        memcpy(block, in + full, len - full);
+        gcm128_ghash_blocks(gcm, block, sizeof(block));
+    }
+}
+
+static void aes_gcm_multi_xor(unsigned char *out, const unsigned char *in,
+                              const unsigned char *ks, size_t len)
+{
+    size_t i;
+
+    for (i = 0; i < len; i++)
+        out[i] = in[i] ^ ks[i];
+}
+
+/*
+ * Finish one message of a group given its encrypted counter blocks |ks|,
+ * starting with the one for the tag.  Plaintext is only released once the
+ * tag has been checked.
+ */
+static int aes_gcm_multi_finish(EVP_CIPHER_CTX *ctx, EVP_AES_GCM_CTX *gctx,
+                                EVP_CTRL_AEAD_MULTI_PARAM *m,
+                                const unsigned char *ks)
+{
+    GCM128_CONTEXT *gcm = &gctx->gcm;
+    unsigned char lens[16], tag[16];
+    uint64_t bits;
+    size_t i;
+
+    if (ctx->encrypt)
+        aes_gcm_multi_xor(m->out, m->inp, ks + 16, m->len);
+
+    gcm->Xi.u[0] = gcm->Xi.u[1] = 0;
+    aes_gcm_multi_ghash(gcm, m->aad, m->aadlen);
+    aes_gcm_multi_ghash(gcm, ctx->encrypt ? m->out : m->inp, m->len);
+    for (i = 0, bits = (uint64_t)m->aadlen << 3; i < 8; i++)
+        lens[i] = (unsigned char)(bits >> (56 - 8 * i));
+    for (i = 0, bits = (uint64_t)m->len << 3; i < 8; i++)
+        lens[8 + i] = (unsigned char)(bits >> (56 - 8 * i));
+    gcm128_ghash_blocks(gcm, lens, sizeof(lens));
+    for (i = 0; i < 16; i++)
+        tag[i] = gcm->Xi.c[i] ^ ks[i];
+
+    if (ctx->encrypt) {
+        memcpy(m->tag, tag, m->taglen);
+    } else {
+        if (CRYPTO_memcmp(tag, m->tag, m->taglen) != 0)
+            return m->verified = 0;
+        aes_gcm_multi_xor(m->out, m->inp, ks + 16, m->len);
+    }
+    return m->verified = 1;
+}
+
+/*
+ * A message that is not batched goes through the usual code.  When
+ * decrypting, the plaintext is kept in a buffer of its own until the tag has
+ * been checked, as |out| may be where the ciphertext is.
+ */
+static int aes_gcm_multi_one(EVP_CIPHER_CTX *ctx, EVP_AES_GCM_CTX *gctx,
+                             EVP_CTRL_AEAD_MULTI_PARAM *m)
+{
+    unsigned char *out = m->out;
+    int ok;
+
+    if (!ctx->encrypt && m->len > 0
+            && (out = OPENSSL_malloc(m->len)) == NULL) {
+        EVPerr(EVP_F_AES_GCM_CTRL, ERR_R_MALLOC_FAILURE);
+        return m->verified = 0;
+    }
+
+    CRYPTO_gcm128_setiv(&gctx->gcm, m->iv, m->ivlen);
+    gctx->iv_set = 1;
+    if (!ctx->encrypt) {
+        memcpy(ctx->buf, m->tag, m->taglen);
+        gctx->taglen = (int)m->taglen;
+    }
+    ok = (m->aadlen == 0 || aes_gcm_cipher(ctx, NULL, m->aad, m->aadlen) >= 0)
+        && (m->len == 0 || aes_gcm_cipher(ctx, out, m->inp, m->len) >= 0)
+        && aes_gcm_cipher(ctx, NULL, NULL, 0) >= 0;
+
+    if (ctx->encrypt) {
+        if (ok)
+            memcpy(m->tag, ctx->buf, m->taglen);
+    } else if (out != m->out) {
+        if (ok)
+            memcpy(m->out, out, m->len);
+        OPENSSL_clear_free(out, m->len);
+    }
+    return m->verified = ok;
+}
+
+static int aes_gcm_multi(EVP_CIPHER_CTX *ctx, EVP_CTRL_AEAD_MULTI_PARAM *msg,
+                         size_t num)
+{
+    EVP_AES_GCM_CTX *gctx = EVP_C_DATA(EVP_AES_GCM_CTX,ctx);
+    unsigned char ks[GCM_MULTI_BLOCKS * 16], *p;
+    size_t i, j, next, used, blocks, b;
+    int ret = 1;
+
+    for (i = 0; i < num; i++) {
+        if (msg[i].ivlen == 0 || msg[i].ivlen > INT_MAX
+                || msg[i].taglen == 0 || msg[i].taglen > 16
+                || msg[i].len > INT_MAX || msg[i].aadlen > INT_MAX)
+            return 0;
+    }
+
+    for (i = 0; i < num; i = next) {
+        if (msg[i].ivlen != 12 || msg[i].len > GCM_MULTI_MAX_LEN) {
+            ret &= aes_gcm_multi_one(ctx, gctx, &msg[i]);
+            next = i + 1;
+            continue;
+        }
+
+        /* Lay out J0, J0 + 1, ... for as many messages as fit */
+        for (next = i, used = 0; next < num; next++) {
+            if (msg[next].ivlen != 12 || msg[next].len > GCM_MULTI_MAX_LEN)
+                break;
+            blocks = 1 + (msg[next].len + 15) / 16;
+            if (used + blocks > GCM_MULTI_BLOCKS)
+                break;
+            for (b = 0, p = ks + used * 16; b < blocks; b++, p += 16) {
+                memcpy(p, msg[next].iv, 12);
+                p[12] = (unsigned char)((b + 1) >> 24);
+                p[13] = (unsigned char)((b + 1) >> 16);
+                p[14] = (unsigned char)((b + 1) >> 8);
+                p[15] = (unsigned char)(b + 1);
+            }
+            used += blocks;
+        }
+        aes_gcm_multi_ecb(gctx, ks, used * 16);
+
+        for (j = i, p = ks; j < next; j++) {
+            ret &= aes_gcm_multi_finish(ctx, gctx, &msg[j], p);
+            p += (1 + (msg[j].len + 15) / 16) * 16;
+        }
+    }
+
+    OPENSSL_cleanse(ks, sizeof(ks));
+    /* The context's own IV has been overwritten */
+    gctx->iv_set = 0;
+    return ret;
+}
+
 #define CUSTOM_FLAGS    (EVP_CIPH_FLAG_DEFAULT_ASN1 \
                 | EVP_CIPH_CUSTOM_IV | EVP_CIPH_FLAG_CUSTOM_CIPHER \
                 | EVP_CIPH_ALWAYS_CALL_INIT | EVP_CIPH_CTRL_INIT \
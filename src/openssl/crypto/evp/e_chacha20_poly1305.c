@@ -162,6 +162,35 @@ typedef struct {
 #  define aead_data(ctx)        ((EVP_CHACHA_AEAD_CTX *)(ctx)->cipher_data)
 #  define POLY1305_ctx(actx)    ((POLY1305 *)(actx + 1))
 
+/*
+ * Encrypt or decrypt |len| bytes of text and authenticate the ciphertext.
+ * Rather than making two passes over the whole text, the cipher and the MAC
+ * take turns on chunks small enough for the data to still be in the L1 cache
+ * when it is touched for the second time.
+ */
+#  define CHACHA20_POLY1305_CHUNK   (4 * 1024)
+
+static void chacha20_poly1305_crypt(EVP_CIPHER_CTX *ctx, unsigned char *out,
+                                    const unsigned char *in, size_t len)
+{
+    EVP_CHACHA_AEAD_CTX *actx = aead_data(ctx);
+    size_t n;
+
+    while (len > 0) {
+        n = len < CHACHA20_POLY1305_CHUNK ? len : CHACHA20_POLY1305_CHUNK;
+        if (ctx->encrypt) {
+            chacha_cipher(ctx, out, in, n);
+            Poly1305_Update(POLY1305_ctx(actx), out, n);
+        } else {
+            Poly1305_Update(POLY1305_ctx(actx), in, n);
+            chacha_cipher(ctx, out, in, n);
+        }
+        in += n;
+        out += n;
+        len -= n;
+    }
+}
+
 static int chacha20_poly1305_init_key(EVP_CIPHER_CTX *ctx,
                                       const unsigned char *inkey,
                                       const unsigned char *iv, int enc)
@@ -295,13 +324,7 @@ static int chacha20_poly1305_tls_cipher(EVP_CIPHER_CTX *ctx, unsigned char *out,
         actx->len.aad = EVP_AEAD_TLS1_AAD_LEN;
         actx->len.text = plen;
 
-        if (ctx->encrypt) {
-            ChaCha20_ctr32(out, in, plen, actx->key.key.d, actx->key.counter);
-            Poly1305_Update(POLY1305_ctx(actx), out, plen);
-        } else {
-            Poly1305_Update(POLY1305_ctx(actx), in, plen);
-            ChaCha20_ctr32(out, in, plen, actx->key.key.d, actx->key.counter);
-        }
+        chacha20_poly1305_crypt(ctx, out, in, plen);
 
         in += plen;
         out += plen;
@@ -409,19 +432,10 @@ static int chacha20_poly1305_cipher(EVP_CIPHER_CTX *ctx, unsigned char *out,
             else if (len != plen + POLY1305_BLOCK_SIZE)
                 return -1;
 
-            if (ctx->encrypt) {                 /* plaintext */
-                chacha_cipher(ctx, out, in, plen);
-                Poly1305_Update(POLY1305_ctx(actx), out, plen);
-                in += plen;
-                out += plen;
-                actx->len.text += plen;
-            } else {                            /* ciphertext */
-                Poly1305_Update(POLY1305_ctx(actx), in, plen);
-                chacha_cipher(ctx, out, in, plen);
-                in += plen;
-                out += plen;
-                actx->len.text += plen;
-            }
+            chacha20_poly1305_crypt(ctx, out, in, plen);
+            in += plen;
+            out += plen;
+            actx->len.text += plen;
         }
     }
     if (in == NULL                              /* explicit final */
@@ -12,6 +12,7 @@
 #include <openssl/evp.h>
 #include <openssl/objects.h>
 #include <openssl/x509.h>
+#include "crypto/asn1.h"
 #include "crypto/evp.h"
 #include "evp_local.h"
 
@@ -216,3 +217,53 @@ int EVP_DigestVerify(EVP_MD_CTX *ctx, const unsigned char *sigret,
         return -1;
     return EVP_DigestVerifyFinal(ctx, sigret, siglen);
 }
+
+int EVP_DigestVerify_multi(EVP_PKEY *const *pkey,
+                           const unsigned char *const *sig,
+                           const size_t *siglen,
+                           const unsigned char *const *tbs,
+                           const size_t *tbslen, size_t num, int *status)
+{
+    EVP_MD_CTX *ctx;
+    size_t i, ned = 0;
+    int ret = 1;
+
+    if ((ctx = EVP_MD_CTX_new()) == NULL) {
+        EVPerr(EVP_F_EVP_DIGESTVERIFY_MULTI, ERR_R_MALLOC_FAILURE);
+        return -1;
+    }
+
+    for (i = 0; i < num; i++) {
+#ifndef OPENSSL_NO_EC
+        /* Ed25519 signatures are verified together below */
+        if (pkey[i]->ameth == &ed25519_asn1_meth) {
+            status[i] = 0;
+            ned++;
+            continue;
+        }
+#endif
+        /* A malformed signature is just one that does not verify */
+        status[i] = 0;
+        if (EVP_DigestVerifyInit(ctx, NULL, NULL, NULL, pkey[i]) <= 0)
+            ret = -1;
+        else
+            status[i] = EVP_DigestVerify(ctx, sig[i], siglen[i], tbs[i],
+                                         tbslen[i]) == 1;
+        EVP_MD_CTX_reset(ctx);
+    }
+
+#ifndef OPENSSL_NO_EC
+    if (ned > 0
+            && !ecx_ed25519_verify_multi(pkey, sig, siglen, tbs, tbslen, num,
+                                         status))
+        ret = -1;
+#endif
+
+    EVP_MD_CTX_free(ctx);
+    if (ret < 0)
+        return -1;
+    for (i = 0; i < num; i++)
+        if (!status[i])
+            return 0;
+    return 1;
+}
@@ -683,6 +683,14 @@ int EVP_PKEY_set1_tls_encodedpoint(EVP_PKEY *pkey,
     return 1;
 }
 
+int EVP_PKEY_set_pub_precompute(EVP_PKEY *pkey, int uses)
+{
+    if (evp_pkey_asn1_ctrl(pkey, ASN1_PKEY_CTRL_SET_PUB_PRECOMPUTE, uses,
+                           NULL) <= 0)
+        return 0;
+    return 1;
+}
+
 size_t EVP_PKEY_get1_tls_encodedpoint(EVP_PKEY *pkey, unsigned char **ppt)
 {
     int rv;
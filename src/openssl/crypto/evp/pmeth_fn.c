@@ -295,3 +295,33 @@ int EVP_PKEY_derive(EVP_PKEY_CTX *ctx, unsigned char *key, size_t *pkeylen)
     M_check_autoarg(ctx, key, pkeylen, EVP_F_EVP_PKEY_DERIVE)
         return ctx->pmeth->derive(ctx, key, pkeylen);
 }
+
+int EVP_PKEY_derive_multi(EVP_PKEY_CTX *const *ctx, unsigned char *const *key,
+                          size_t *keylen, size_t num)
+{
+    size_t i, nx = 0;
+    int ret = 1;
+
+    for (i = 0; i < num; i++) {
+#ifndef OPENSSL_NO_EC
+        /* X25519 secrets are derived together below */
+        if (ctx[i] != NULL && ctx[i]->pmeth == &ecx25519_pkey_meth
+                && ctx[i]->operation == EVP_PKEY_OP_DERIVE) {
+            nx++;
+            continue;
+        }
+#endif
+        if (EVP_PKEY_derive(ctx[i], key[i], &keylen[i]) <= 0)
+            keylen[i] = 0;
+    }
+
+#ifndef OPENSSL_NO_EC
+    if (nx > 0 && !ecx_x25519_derive_multi(ctx, key, keylen, num))
+        return -1;
+#endif
+
+    for (i = 0; i < num; i++)
+        if (keylen[i] == 0)
+            ret = 0;
+    return ret;
+}
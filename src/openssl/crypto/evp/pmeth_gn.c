@@ -113,6 +113,50 @@ int EVP_PKEY_keygen(EVP_PKEY_CTX *ctx, EVP_PKEY **ppkey)
     return ret;
 }
 
+int EVP_PKEY_keygen_multi(EVP_PKEY_CTX *ctx, EVP_PKEY **ppkey, size_t num)
+{
+    size_t i;
+    int ret = 1;
+
+    if (!ctx || !ctx->pmeth || !ctx->pmeth->keygen) {
+        EVPerr(EVP_F_EVP_PKEY_KEYGEN_MULTI,
+               EVP_R_OPERATION_NOT_SUPPORTED_FOR_THIS_KEYTYPE);
+        return -2;
+    }
+    if (ctx->operation != EVP_PKEY_OP_KEYGEN) {
+        EVPerr(EVP_F_EVP_PKEY_KEYGEN_MULTI, EVP_R_OPERATON_NOT_INITIALIZED);
+        return -1;
+    }
+
+    for (i = 0; i < num; i++)
+        ppkey[i] = NULL;
+#ifndef OPENSSL_NO_EC
+    /* X25519 keys have their public halves computed together */
+    if (ctx->pmeth == &ecx25519_pkey_meth) {
+        for (i = 0; i < num; i++) {
+            if ((ppkey[i] = EVP_PKEY_new()) == NULL) {
+                ret = -1;
+                break;
+            }
+        }
+        if (ret > 0 && !ecx_x25519_keygen_multi(ppkey, num))
+            ret = 0;
+    } else
+#endif
+    {
+        for (i = 0; i < num && ret > 0; i++)
+            ret = EVP_PKEY_keygen(ctx, &ppkey[i]);
+    }
+
+    if (ret <= 0) {
+        for (i = 0; i < num; i++) {
+            EVP_PKEY_free(ppkey[i]);
+            ppkey[i] = NULL;
+        }
+    }
+    return ret;
+}
+
 void EVP_PKEY_CTX_set_cb(EVP_PKEY_CTX *ctx, EVP_PKEY_gen_cb *cb)
 {
     ctx->pkey_gencb = cb;
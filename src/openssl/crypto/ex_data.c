@@ -9,6 +9,7 @@
 
 #include "crypto/cryptlib.h"
 #include "internal/thread_once.h"
+#include "internal/tsan_assist.h"
 
 /*
  * Each structure type (sometimes called a class), that supports
@@ -23,11 +24,29 @@ struct ex_callback_st {
 };
 
 /*
- * The state for each class.  This could just be a typedef, but
- * a structure allows future changes.
+ * An immutable copy of a class's callbacks.  Objects are created and freed
+ * far more often than indexes are registered, so those paths work from the
+ * current snapshot instead of copying the callbacks under |ex_data_lock|.
+ * A new snapshot is published each time the callbacks change.  Since a
+ * reader may still be using the one it replaced, old snapshots are only
+ * freed by crypto_cleanup_all_ex_data_int().
+ */
+typedef struct ex_callbacks_snap_st EX_CALLBACKS_SNAP;
+struct ex_callbacks_snap_st {
+    int num;                    /* Number of entries in |funcs| */
+    int have_new;               /* Any |funcs| with a new_func? */
+    int have_free;              /* Any |funcs| with a free_func? */
+    EX_CALLBACK *funcs;
+    EX_CALLBACKS_SNAP *next;    /* Snapshot this one replaced */
+};
+
+/*
+ * The state for each class.  |meth| is only accessed with |ex_data_lock|
+ * held for writing, |snap| is NULL until the first index is registered.
  */
 typedef struct ex_callbacks_st {
     STACK_OF(EX_CALLBACK) *meth;
+    EX_CALLBACKS_SNAP *TSAN_QUALIFIER snap;
 } EX_CALLBACKS;
 
 static EX_CALLBACKS ex_data[CRYPTO_EX_INDEX__COUNT];
@@ -96,9 +115,18 @@ void crypto_cleanup_all_ex_data_int(void)
 
     for (i = 0; i < CRYPTO_EX_INDEX__COUNT; ++i) {
         EX_CALLBACKS *ip = &ex_data[i];
+        EX_CALLBACKS_SNAP *snap = ip->snap;
 
         sk_EX_CALLBACK_pop_free(ip->meth, cleanup_cb);
         ip->meth = NULL;
+        ip->snap = NULL;
+        while (snap != NULL) {
+            EX_CALLBACKS_SNAP *next = snap->next;
+
+            OPENSSL_free(snap->funcs);
+            OPENSSL_free(snap);
+            snap = next;
+        }
     }
 
     CRYPTO_THREAD_lock_free(ex_data_lock);
@@ -107,30 +135,76 @@ void crypto_cleanup_all_ex_data_int(void)
 
 
 /*
- * Unregister a new index by replacing the callbacks with no-ops.
- * Any in-use instances are leaked.
+ * Publish a new snapshot of |ip->meth|.  Must be called with |ex_data_lock|
+ * held for writing.
  */
-static void dummy_new(void *parent, void *ptr, CRYPTO_EX_DATA *ad, int idx,
-                     long argl, void *argp)
+static int publish_snapshot(EX_CALLBACKS *ip)
 {
-}
+    EX_CALLBACKS_SNAP *snap;
+    EX_CALLBACK *a;
+    int i, num = sk_EX_CALLBACK_num(ip->meth);
 
-static void dummy_free(void *parent, void *ptr, CRYPTO_EX_DATA *ad, int idx,
-                       long argl, void *argp)
-{
+    if ((snap = OPENSSL_zalloc(sizeof(*snap))) == NULL
+            || (snap->funcs = OPENSSL_zalloc(sizeof(*snap->funcs)
+                                             * num)) == NULL) {
+        OPENSSL_free(snap);
+        return 0;
+    }
+    snap->num = num;
+    for (i = 0; i < num; i++) {
+        if ((a = sk_EX_CALLBACK_value(ip->meth, i)) == NULL)
+            continue;
+        snap->funcs[i] = *a;
+        if (a->new_func != NULL)
+            snap->have_new = 1;
+        if (a->free_func != NULL)
+            snap->have_free = 1;
+    }
+    snap->next = tsan_load(&ip->snap);
+#ifdef tsan_st_rel
+    tsan_st_rel(&ip->snap, snap);
+#else
+    tsan_store(&ip->snap, snap);
+#endif
+    return 1;
 }
 
-static int dummy_dup(CRYPTO_EX_DATA *to, const CRYPTO_EX_DATA *from,
-                     void *from_d, int idx,
-                     long argl, void *argp)
+/*
+ * Return the current snapshot of callbacks for a given class in |*snap|,
+ * which is NULL if no index was ever registered for it.
+ */
+static int get_snapshot(int class_index, const EX_CALLBACKS_SNAP **snap)
 {
+    if (class_index < 0 || class_index >= CRYPTO_EX_INDEX__COUNT) {
+        CRYPTOerr(CRYPTO_F_GET_SNAPSHOT, ERR_R_PASSED_INVALID_ARGUMENT);
+        return 0;
+    }
+
+#ifdef tsan_ld_acq
+    *snap = tsan_ld_acq(&ex_data[class_index].snap);
+#else
+    if (!RUN_ONCE(&ex_data_init, do_ex_data_init)) {
+        CRYPTOerr(CRYPTO_F_GET_SNAPSHOT, ERR_R_MALLOC_FAILURE);
+        return 0;
+    }
+    /* See get_and_lock() */
+    if (ex_data_lock == NULL)
+        return 0;
+    CRYPTO_THREAD_read_lock(ex_data_lock);
+    *snap = ex_data[class_index].snap;
+    CRYPTO_THREAD_unlock(ex_data_lock);
+#endif
     return 1;
 }
 
+/*
+ * Unregister a new index by removing its callbacks.
+ * Any in-use instances are leaked.
+ */
 int CRYPTO_free_ex_index(int class_index, int idx)
 {
     EX_CALLBACKS *ip = get_and_lock(class_index);
-    EX_CALLBACK *a;
+    EX_CALLBACK *a, saved;
     int toret = 0;
 
     if (ip == NULL)
@@ -140,9 +214,15 @@ int CRYPTO_free_ex_index(int class_index, int idx)
     a = sk_EX_CALLBACK_value(ip->meth, idx);
     if (a == NULL)
         goto err;
-    a->new_func = dummy_new;
-    a->dup_func = dummy_dup;
-    a->free_func = dummy_free;
+    saved = *a;
+    a->new_func = NULL;
+    a->dup_func = NULL;
+    a->free_func = NULL;
+    if (!publish_snapshot(ip)) {
+        *a = saved;
+        CRYPTOerr(CRYPTO_F_CRYPTO_FREE_EX_INDEX, ERR_R_MALLOC_FAILURE);
+        goto err;
+    }
     toret = 1;
 err:
     CRYPTO_THREAD_unlock(ex_data_lock);
@@ -192,6 +272,12 @@ int CRYPTO_get_ex_new_index(int class_index, long argl, void *argp,
     }
     toret = sk_EX_CALLBACK_num(ip->meth) - 1;
     (void)sk_EX_CALLBACK_set(ip->meth, toret, a);
+    if (!publish_snapshot(ip)) {
+        CRYPTOerr(CRYPTO_F_CRYPTO_GET_EX_NEW_INDEX, ERR_R_MALLOC_FAILURE);
+        (void)sk_EX_CALLBACK_pop(ip->meth);
+        OPENSSL_free(a);
+        toret = -1;
+    }
 
  err:
     CRYPTO_THREAD_unlock(ex_data_lock);
@@ -201,48 +287,29 @@ int CRYPTO_get_ex_new_index(int class_index, long argl, void *argp,
 /*
  * Initialise a new CRYPTO_EX_DATA for use in a particular class - including
  * calling new() callbacks for each index in the class used by this variable
- * Thread-safe by copying a class's array of "EX_CALLBACK" entries
- * in the lock, then using them outside the lock. Note this only applies
- * to the global "ex_data" state (ie. class definitions), not 'ad' itself.
+ * Thread-safe by using a snapshot of the class's "EX_CALLBACK" entries,
+ * which is never changed once published. Note this only applies to the
+ * global "ex_data" state (ie. class definitions), not 'ad' itself.
  */
 int CRYPTO_new_ex_data(int class_index, void *obj, CRYPTO_EX_DATA *ad)
 {
-    int mx, i;
+    int i;
     void *ptr;
-    EX_CALLBACK **storage = NULL;
-    EX_CALLBACK *stack[10];
-    EX_CALLBACKS *ip = get_and_lock(class_index);
-
-    if (ip == NULL)
-        return 0;
+    const EX_CALLBACKS_SNAP *snap;
 
     ad->sk = NULL;
-
-    mx = sk_EX_CALLBACK_num(ip->meth);
-    if (mx > 0) {
-        if (mx < (int)OSSL_NELEM(stack))
-            storage = stack;
-        else
-            storage = OPENSSL_malloc(sizeof(*storage) * mx);
-        if (storage != NULL)
-            for (i = 0; i < mx; i++)
-                storage[i] = sk_EX_CALLBACK_value(ip->meth, i);
-    }
-    CRYPTO_THREAD_unlock(ex_data_lock);
-
-    if (mx > 0 && storage == NULL) {
-        CRYPTOerr(CRYPTO_F_CRYPTO_NEW_EX_DATA, ERR_R_MALLOC_FAILURE);
+    if (!get_snapshot(class_index, &snap))
         return 0;
-    }
-    for (i = 0; i < mx; i++) {
-        if (storage[i] != NULL && storage[i]->new_func != NULL) {
+    if (snap == NULL || !snap->have_new)
+        return 1;
+
+    for (i = 0; i < snap->num; i++) {
+        if (snap->funcs[i].new_func != NULL) {
             ptr = CRYPTO_get_ex_data(ad, i);
-            storage[i]->new_func(obj, ptr, ad, i,
-                                 storage[i]->argl, storage[i]->argp);
+            snap->funcs[i].new_func(obj, ptr, ad, i,
+                                    snap->funcs[i].argl, snap->funcs[i].argp);
         }
     }
-    if (storage != stack)
-        OPENSSL_free(storage);
     return 1;
 }
 
@@ -255,38 +322,22 @@ int CRYPTO_dup_ex_data(int class_index, CRYPTO_EX_DATA *to,
 {
     int mx, j, i;
     void *ptr;
-    EX_CALLBACK *stack[10];
-    EX_CALLBACK **storage = NULL;
-    EX_CALLBACKS *ip;
-    int toret = 0;
+    const EX_CALLBACKS_SNAP *snap;
 
     if (from->sk == NULL)
         /* Nothing to copy over */
         return 1;
-    if ((ip = get_and_lock(class_index)) == NULL)
+    if (!get_snapshot(class_index, &snap))
         return 0;
+    if (snap == NULL)
+        return 1;
 
-    mx = sk_EX_CALLBACK_num(ip->meth);
+    mx = snap->num;
     j = sk_void_num(from->sk);
     if (j < mx)
         mx = j;
-    if (mx > 0) {
-        if (mx < (int)OSSL_NELEM(stack))
-            storage = stack;
-        else
-            storage = OPENSSL_malloc(sizeof(*storage) * mx);
-        if (storage != NULL)
-            for (i = 0; i < mx; i++)
-                storage[i] = sk_EX_CALLBACK_value(ip->meth, i);
-    }
-    CRYPTO_THREAD_unlock(ex_data_lock);
-
     if (mx == 0)
         return 1;
-    if (storage == NULL) {
-        CRYPTOerr(CRYPTO_F_CRYPTO_DUP_EX_DATA, ERR_R_MALLOC_FAILURE);
-        return 0;
-    }
     /*
      * Make sure the ex_data stack is at least |mx| elements long to avoid
      * issues in the for loop that follows; so go get the |mx|'th element
@@ -295,21 +346,18 @@ int CRYPTO_dup_ex_data(int class_index, CRYPTO_EX_DATA *to,
      * proper size
      */
     if (!CRYPTO_set_ex_data(to, mx - 1, CRYPTO_get_ex_data(to, mx - 1)))
-        goto err;
+        return 0;
 
     for (i = 0; i < mx; i++) {
         ptr = CRYPTO_get_ex_data(from, i);
-        if (storage[i] != NULL && storage[i]->dup_func != NULL)
-            if (!storage[i]->dup_func(to, from, &ptr, i,
-                                      storage[i]->argl, storage[i]->argp))
-                goto err;
+        if (snap->funcs[i].dup_func != NULL)
+            if (!snap->funcs[i].dup_func(to, from, &ptr, i,
+                                         snap->funcs[i].argl,
+                                         snap->funcs[i].argp))
+                return 0;
         CRYPTO_set_ex_data(to, i, ptr);
     }
-    toret = 1;
- err:
-    if (storage != stack)
-        OPENSSL_free(storage);
-    return toret;
+    return 1;
 }
 
 
@@ -319,44 +367,21 @@ int CRYPTO_dup_ex_data(int class_index, CRYPTO_EX_DATA *to,
  */
 void CRYPTO_free_ex_data(int class_index, void *obj, CRYPTO_EX_DATA *ad)
 {
-    int mx, i;
-    EX_CALLBACKS *ip;
+    int i;
     void *ptr;
-    EX_CALLBACK *f;
-    EX_CALLBACK *stack[10];
-    EX_CALLBACK **storage = NULL;
+    const EX_CALLBACKS_SNAP *snap;
 
-    if ((ip = get_and_lock(class_index)) == NULL)
+    if (!get_snapshot(class_index, &snap) || snap == NULL || !snap->have_free)
         goto err;
 
-    mx = sk_EX_CALLBACK_num(ip->meth);
-    if (mx > 0) {
-        if (mx < (int)OSSL_NELEM(stack))
-            storage = stack;
-        else
-            storage = OPENSSL_malloc(sizeof(*storage) * mx);
-        if (storage != NULL)
-            for (i = 0; i < mx; i++)
-                storage[i] = sk_EX_CALLBACK_value(ip->meth, i);
-    }
-    CRYPTO_THREAD_unlock(ex_data_lock);
-
-    for (i = 0; i < mx; i++) {
-        if (storage != NULL)
-            f = storage[i];
-        else {
-            CRYPTO_THREAD_write_lock(ex_data_lock);
-            f = sk_EX_CALLBACK_value(ip->meth, i);
-            CRYPTO_THREAD_unlock(ex_data_lock);
-        }
-        if (f != NULL && f->free_func != NULL) {
+    for (i = 0; i < snap->num; i++) {
+        if (snap->funcs[i].free_func != NULL) {
             ptr = CRYPTO_get_ex_data(ad, i);
-            f->free_func(obj, ptr, ad, i, f->argl, f->argp);
+            snap->funcs[i].free_func(obj, ptr, ad, i,
+                                     snap->funcs[i].argl, snap->funcs[i].argp);
         }
     }
 
-    if (storage != stack)
-        OPENSSL_free(storage);
  err:
     sk_void_free(ad->sk);
     ad->sk = NULL;
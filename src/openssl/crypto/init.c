@@ -11,6 +11,8 @@
 #include "crypto/cryptlib.h"
 #include <openssl/err.h>
 #include "crypto/rand.h"
+#include "crypto/rsa.h"
+#include "crypto/dh.h"
 #include "internal/bio.h"
 #include <openssl/evp.h>
 #include "crypto/evp.h"
@@ -446,6 +448,16 @@ static void ossl_init_thread_stop(struct thread_local_inits_st *locals)
         drbg_delete_thread_state();
     }
 
+#ifndef OPENSSL_NO_RSA
+    if (locals->rsa) {
+# ifdef OPENSSL_INIT_DEBUG
+        fprintf(stderr, "OPENSSL_INIT: ossl_init_thread_stop: "
+                        "rsa_delete_thread_state()\n");
+# endif
+        rsa_delete_thread_state();
+    }
+#endif
+
     OPENSSL_free(locals);
 }
 
@@ -491,6 +503,14 @@ int ossl_init_thread_start(uint64_t opts)
         locals->rand = 1;
     }
 
+    if (opts & OPENSSL_INIT_THREAD_RSA) {
+#ifdef OPENSSL_INIT_DEBUG
+        fprintf(stderr, "OPENSSL_INIT: ossl_init_thread_start: "
+                        "marking thread for rsa\n");
+#endif
+        locals->rsa = 1;
+    }
+
     return 1;
 }
 
@@ -564,6 +584,10 @@ void OPENSSL_cleanup(void)
 #ifdef OPENSSL_INIT_DEBUG
     fprintf(stderr, "OPENSSL_INIT: OPENSSL_cleanup: "
                     "rand_cleanup_int()\n");
+    fprintf(stderr, "OPENSSL_INIT: OPENSSL_cleanup: "
+                    "rsa_cleanup_int()\n");
+    fprintf(stderr, "OPENSSL_INIT: OPENSSL_cleanup: "
+                    "dh_cleanup_int()\n");
     fprintf(stderr, "OPENSSL_INIT: OPENSSL_cleanup: "
                     "conf_modules_free_int()\n");
 #ifndef OPENSSL_NO_ENGINE
@@ -596,6 +620,12 @@ void OPENSSL_cleanup(void)
      */
     rand_cleanup_int();
     rand_drbg_cleanup_int();
+#ifndef OPENSSL_NO_RSA
+    rsa_cleanup_int();
+#endif
+#ifndef OPENSSL_NO_DH
+    dh_cleanup_int();
+#endif
     conf_modules_free_int();
 #ifndef OPENSSL_NO_ENGINE
     engine_cleanup_int();
@@ -978,6 +978,38 @@ int CRYPTO_gcm128_aad(GCM128_CONTEXT *ctx, const unsigned char *aad,
     return 0;
 }
 
+/*
+ * Hash |len| bytes at |in|, a multiple of the block size, into ctx->Xi.
+ * This is for callers that manage ctx->Xi themselves, such as the batched
+ * GCM in e_aes.c.
+ */
+void gcm128_ghash_blocks(GCM128_CONTEXT *ctx, const unsigned char *in,
+                         size_t len)
+{
+#ifdef GCM_FUNCREF_4BIT
+# ifdef GHASH
+    void (*gcm_ghash_p) (u64 Xi[2], const u128 Htable[16],
+                         const u8 *inp, size_t len) = ctx->ghash;
+# else
+    void (*gcm_gmult_p) (u64 Xi[2], const u128 Htable[16]) = ctx->gmult;
+# endif
+#endif
+#ifdef GHASH
+    if (len > 0)
+        GHASH(ctx, in, len);
+#else
+    size_t i;
+
+    while (len >= 16) {
+        for (i = 0; i < 16; ++i)
+            ctx->Xi.c[i] ^= in[i];
+        GCM_MUL(ctx);
+        in += 16;
+        len -= 16;
+    }
+#endif
+}
+
 int CRYPTO_gcm128_encrypt(GCM128_CONTEXT *ctx,
                           const unsigned char *in, unsigned char *out,
                           size_t len)
@@ -133,6 +133,9 @@ struct gcm128_context {
 #endif
 };
 
+void gcm128_ghash_blocks(GCM128_CONTEXT *ctx, const unsigned char *in,
+                         size_t len);
+
 struct xts128_context {
     void *key1, *key2;
     block128_f block1, block2;
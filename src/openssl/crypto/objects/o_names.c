@@ -17,6 +17,7 @@
 #include <openssl/safestack.h>
 #include <openssl/e_os2.h>
 #include "internal/thread_once.h"
+#include "internal/tsan_assist.h"
 #include "crypto/lhash.h"
 #include "obj_local.h"
 #include "e_os.h"
@@ -54,6 +55,45 @@ struct name_funcs_st {
 
 static STACK_OF(NAME_FUNCS) *name_funcs_stack;
 
+#ifdef tsan_ld_acq
+/*
+ * Digest and cipher names are looked up far more often than they change,
+ * so lookups for those two types are served from an immutable snapshot of
+ * the table: an open addressed hash with every alias chain already
+ * resolved.  The snapshot is built on the first lookup after a change and
+ * published with release semantics, so readers never take |obj_lock|.
+ * Any change to the table unpublishes it.  Since readers may still be
+ * using an unpublished snapshot it is only freed by OBJ_NAME_cleanup(-1).
+ *
+ * To bound the memory held by unpublished snapshots at most
+ * NAMES_SNAP_MAX_BUILDS of them are built.  A process that keeps adding or
+ * removing digest or cipher names after that many lookups have rebuilt the
+ * snapshot is served from the locked table from then on, as before the
+ * snapshot existed, until OBJ_NAME_cleanup(-1) starts over.  Names are
+ * normally all registered at start-up, before the first lookup, so this
+ * only affects applications that register them as they go.
+ */
+# define NAMES_SNAP_MAX_BUILDS  16
+
+typedef struct {
+    unsigned long hash;
+    int type;
+    char *name;
+    const char *value;
+} NAMES_SNAP_ENTRY;
+
+typedef struct names_snap_st NAMES_SNAP;
+struct names_snap_st {
+    size_t mask;
+    NAMES_SNAP_ENTRY *entries;
+    NAMES_SNAP *next;           /* on the retired list */
+};
+
+static NAMES_SNAP *TSAN_QUALIFIER names_snap = NULL;
+static NAMES_SNAP *retired_snaps = NULL;
+static int names_snap_builds = 0;
+#endif
+
 /*
  * The LHASH callbacks now use the raw "void *" prototypes and do
  * per-variable casting in the functions. This prevents function pointer
@@ -169,21 +209,169 @@ static unsigned long obj_name_hash(const OBJ_NAME *a)
     return ret;
 }
 
+#ifdef tsan_ld_acq
+static int names_snap_type(int type)
+{
+    return type == OBJ_NAME_TYPE_MD_METH || type == OBJ_NAME_TYPE_CIPHER_METH;
+}
+
+static void names_snap_free(NAMES_SNAP *snap)
+{
+    size_t i;
+
+    if (snap == NULL)
+        return;
+    if (snap->entries != NULL)
+        for (i = 0; i <= snap->mask; i++)
+            OPENSSL_free(snap->entries[i].name);
+    OPENSSL_free(snap->entries);
+    OPENSSL_free(snap);
+}
+
+/* Must be called with |obj_lock| held for writing */
+static void names_snap_retire(void)
+{
+    NAMES_SNAP *snap = tsan_load(&names_snap);
+
+    if (snap != NULL) {
+        tsan_st_rel(&names_snap, NULL);
+        snap->next = retired_snaps;
+        retired_snaps = snap;
+    }
+}
+
+struct names_snap_collect {
+    size_t n;
+    const OBJ_NAME **names;
+};
+
+static void names_snap_count_fn(const OBJ_NAME *name, void *arg)
+{
+    struct names_snap_collect *c = arg;
+
+    c->n++;
+}
+
+static void names_snap_collect_fn(const OBJ_NAME *name, void *arg)
+{
+    struct names_snap_collect *c = arg;
+
+    c->names[c->n++] = name;
+}
+
+/* Must be called with |obj_lock| held for writing */
+static void names_snap_build(void)
+{
+    NAMES_SNAP *snap = NULL;
+    NAMES_SNAP_ENTRY *ent;
+    struct names_snap_collect c;
+    const OBJ_NAME *onp, *target;
+    OBJ_NAME on;
+    unsigned long hash;
+    size_t i, j, size;
+    int num;
+
+    names_snap_builds++;
+
+    c.n = 0;
+    c.names = NULL;
+    OBJ_NAME_do_all(OBJ_NAME_TYPE_MD_METH, names_snap_count_fn, &c);
+    OBJ_NAME_do_all(OBJ_NAME_TYPE_CIPHER_METH, names_snap_count_fn, &c);
+    /* At most half full, so that misses terminate quickly */
+    for (size = 16; size < 2 * c.n; size <<= 1)
+        continue;
+    if ((c.names = OPENSSL_malloc(sizeof(*c.names) * (c.n + 1))) == NULL)
+        return;
+    c.n = 0;
+    OBJ_NAME_do_all(OBJ_NAME_TYPE_MD_METH, names_snap_collect_fn, &c);
+    OBJ_NAME_do_all(OBJ_NAME_TYPE_CIPHER_METH, names_snap_collect_fn, &c);
+
+    if ((snap = OPENSSL_zalloc(sizeof(*snap))) == NULL
+            || (snap->entries = OPENSSL_zalloc(sizeof(*snap->entries)
+                                               * size)) == NULL)
+        goto err;
+    snap->mask = size - 1;
+
+    for (i = 0; i < c.n; i++) {
+        onp = target = c.names[i];
+        on.type = onp->type;
+        for (num = 0; target != NULL && target->alias; num++) {
+            if (num == 10) {
+                target = NULL;
+                break;
+            }
+            on.name = target->data;
+            target = lh_OBJ_NAME_retrieve(names_lh, &on);
+        }
+        /* A dangling alias isn't found by OBJ_NAME_get() either */
+        if (target == NULL)
+            continue;
+
+        hash = openssl_lh_strcasehash(onp->name) ^ onp->type;
+        for (j = (size_t)hash & snap->mask; snap->entries[j].name != NULL;
+             j = (j + 1) & snap->mask)
+            continue;
+        ent = &snap->entries[j];
+        if ((ent->name = OPENSSL_strdup(onp->name)) == NULL)
+            goto err;
+        ent->hash = hash;
+        ent->type = onp->type;
+        ent->value = target->data;
+    }
+
+    OPENSSL_free(c.names);
+    tsan_st_rel(&names_snap, snap);
+    return;
+
+ err:
+    OPENSSL_free(c.names);
+    names_snap_free(snap);
+}
+
+static const char *names_snap_get(const NAMES_SNAP *snap, const char *name,
+                                  int type)
+{
+    const NAMES_SNAP_ENTRY *ent;
+    unsigned long hash = openssl_lh_strcasehash(name) ^ type;
+    size_t j;
+
+    for (j = (size_t)hash & snap->mask; ; j = (j + 1) & snap->mask) {
+        ent = &snap->entries[j];
+        if (ent->name == NULL)
+            return NULL;
+        if (ent->hash == hash && ent->type == type
+                && obj_strcasecmp(ent->name, name) == 0)
+            return ent->value;
+    }
+}
+#endif
+
 const char *OBJ_NAME_get(const char *name, int type)
 {
     OBJ_NAME on, *ret;
     int num = 0, alias;
     const char *value = NULL;
+#ifdef tsan_ld_acq
+    const NAMES_SNAP *snap;
+    int build = 0;
+#endif
 
     if (name == NULL)
         return NULL;
     if (!OBJ_NAME_init())
         return NULL;
-    CRYPTO_THREAD_read_lock(obj_lock);
 
     alias = type & OBJ_NAME_ALIAS;
     type &= ~OBJ_NAME_ALIAS;
 
+#ifdef tsan_ld_acq
+    if (!alias && names_snap_type(type)
+            && (snap = tsan_ld_acq(&names_snap)) != NULL)
+        return names_snap_get(snap, name, type);
+#endif
+
+    CRYPTO_THREAD_read_lock(obj_lock);
+
     on.name = name;
     on.type = type;
 
@@ -201,7 +389,21 @@ const char *OBJ_NAME_get(const char *name, int type)
         }
     }
 
+#ifdef tsan_ld_acq
+    build = !alias && names_snap_type(type)
+        && names_snap_builds < NAMES_SNAP_MAX_BUILDS;
+#endif
     CRYPTO_THREAD_unlock(obj_lock);
+
+#ifdef tsan_ld_acq
+    if (build) {
+        CRYPTO_THREAD_write_lock(obj_lock);
+        if (tsan_load(&names_snap) == NULL
+                && names_snap_builds < NAMES_SNAP_MAX_BUILDS)
+            names_snap_build();
+        CRYPTO_THREAD_unlock(obj_lock);
+    }
+#endif
     return value;
 }
 
@@ -229,6 +431,9 @@ int OBJ_NAME_add(const char *name, int type, const char *data)
 
     CRYPTO_THREAD_write_lock(obj_lock);
 
+#ifdef tsan_ld_acq
+    names_snap_retire();
+#endif
     ret = lh_OBJ_NAME_insert(names_lh, onp);
     if (ret != NULL) {
         /* free things */
@@ -273,6 +478,9 @@ int OBJ_NAME_remove(const char *name, int type)
     on.type = type;
     ret = lh_OBJ_NAME_delete(names_lh, &on);
     if (ret != NULL) {
+#ifdef tsan_ld_acq
+        names_snap_retire();
+#endif
         /* free things */
         if ((name_funcs_stack != NULL)
             && (sk_NAME_FUNCS_num(name_funcs_stack) > ret->type)) {
@@ -395,6 +603,17 @@ void OBJ_NAME_cleanup(int type)
 
     lh_OBJ_NAME_doall(names_lh, names_lh_free_doall);
     if (type < 0) {
+#ifdef tsan_ld_acq
+        NAMES_SNAP *snap;
+
+        names_snap_free(tsan_load(&names_snap));
+        names_snap = NULL;
+        while ((snap = retired_snaps) != NULL) {
+            retired_snaps = snap->next;
+            names_snap_free(snap);
+        }
+        names_snap_builds = 0;
+#endif
         lh_OBJ_NAME_free(names_lh);
         sk_NAME_FUNCS_pop_free(name_funcs_stack, name_funcs_free);
         CRYPTO_THREAD_lock_free(obj_lock);
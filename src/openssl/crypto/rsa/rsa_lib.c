@@ -11,12 +11,15 @@
 #include <openssl/crypto.h>
 #include "internal/cryptlib.h"
 #include "internal/refcount.h"
+#include "internal/tsan_assist.h"
 #include "crypto/bn.h"
 #include <openssl/engine.h>
 #include <openssl/evp.h>
 #include "crypto/evp.h"
 #include "rsa_local.h"
 
+static TSAN_QUALIFIER unsigned long rsa_serial = 1;
+
 RSA *RSA_new(void)
 {
     return RSA_new_method(NULL);
@@ -57,6 +60,7 @@ RSA *RSA_new_method(ENGINE *engine)
     }
 
     ret->references = 1;
+    ret->serial = tsan_counter(&rsa_serial);
     ret->lock = CRYPTO_THREAD_lock_new();
     if (ret->lock == NULL) {
         RSAerr(RSA_F_RSA_NEW_METHOD, ERR_R_MALLOC_FAILURE);
@@ -63,6 +63,8 @@ struct rsa_st {
     BN_BLINDING *blinding;
     BN_BLINDING *mt_blinding;
     CRYPTO_RWLOCK *lock;
+    /* unique per object, identifies the key in per-thread blinding caches */
+    unsigned long serial;
 };
 
 struct rsa_meth_st {
@@ -8,7 +8,10 @@
  */
 
 #include "internal/cryptlib.h"
+#include "internal/thread_once.h"
+#include "crypto/cryptlib.h"
 #include "crypto/bn.h"
+#include "crypto/rsa.h"
 #include "rsa_local.h"
 #include "internal/constant_time.h"
 
@@ -154,10 +157,130 @@ static int rsa_ossl_public_encrypt(int flen, const unsigned char *from,
     return r;
 }
 
+/*
+ * Each thread keeps a few BN_BLINDINGs of its own, keyed on the RSA object
+ * and its serial number, so that private key operations on a key shared
+ * between threads don't need to serialise on rsa->lock.  The serial number
+ * makes sure that an entry left behind by a freed key is never picked up by
+ * a new key that happens to be allocated at the same address.  Stale
+ * entries are simply recycled (BN_BLINDING keeps its own copy of the
+ * modulus and doesn't own |m_ctx|, so freeing them late is safe).
+ */
+#define RSA_THREAD_BLINDINGS    8
+
+typedef struct {
+    const RSA *rsa;
+    unsigned long serial;
+    BN_BLINDING *blinding;
+} RSA_THREAD_BLINDING;
+
+typedef struct {
+    RSA_THREAD_BLINDING ent[RSA_THREAD_BLINDINGS];
+    unsigned int next;
+} RSA_BLINDING_CACHE;
+
+static CRYPTO_ONCE blinding_cache_once = CRYPTO_ONCE_STATIC_INIT;
+static CRYPTO_THREAD_LOCAL blinding_cache_key;
+static int blinding_cache_inited = 0;
+
+DEFINE_RUN_ONCE_STATIC(do_blinding_cache_init)
+{
+    /* make sure rsa_cleanup_int() gets called */
+    if (!OPENSSL_init_crypto(0, NULL))
+        return 0;
+    if (!CRYPTO_THREAD_init_local(&blinding_cache_key, NULL))
+        return 0;
+    blinding_cache_inited = 1;
+    return 1;
+}
+
+static RSA_BLINDING_CACHE *blinding_cache_get(void)
+{
+    RSA_BLINDING_CACHE *cache;
+
+    if (!RUN_ONCE(&blinding_cache_once, do_blinding_cache_init)
+            || !blinding_cache_inited)
+        return NULL;
+
+    cache = CRYPTO_THREAD_get_local(&blinding_cache_key);
+    if (cache == NULL) {
+        if (!ossl_init_thread_start(OPENSSL_INIT_THREAD_RSA))
+            return NULL;
+        if ((cache = OPENSSL_zalloc(sizeof(*cache))) == NULL)
+            return NULL;
+        if (!CRYPTO_THREAD_set_local(&blinding_cache_key, cache)) {
+            OPENSSL_free(cache);
+            return NULL;
+        }
+    }
+    return cache;
+}
+
+static BN_BLINDING *blinding_cache_lookup(RSA_BLINDING_CACHE *cache,
+                                          RSA *rsa, BN_CTX *ctx)
+{
+    RSA_THREAD_BLINDING *ent;
+    BN_BLINDING *b;
+    int i;
+
+    for (i = 0; i < RSA_THREAD_BLINDINGS; i++) {
+        ent = &cache->ent[i];
+        if (ent->rsa == rsa && ent->serial == rsa->serial
+                && ent->blinding != NULL)
+            return ent->blinding;
+    }
+
+    if ((b = RSA_setup_blinding(rsa, ctx)) == NULL)
+        return NULL;
+
+    ent = &cache->ent[cache->next];
+    cache->next = (cache->next + 1) % RSA_THREAD_BLINDINGS;
+    BN_BLINDING_free(ent->blinding);
+    ent->rsa = rsa;
+    ent->serial = rsa->serial;
+    ent->blinding = b;
+    return b;
+}
+
+void rsa_delete_thread_state(void)
+{
+    RSA_BLINDING_CACHE *cache;
+    int i;
+
+    if (!blinding_cache_inited)
+        return;
+
+    cache = CRYPTO_THREAD_get_local(&blinding_cache_key);
+    if (cache == NULL)
+        return;
+    CRYPTO_THREAD_set_local(&blinding_cache_key, NULL);
+    for (i = 0; i < RSA_THREAD_BLINDINGS; i++)
+        BN_BLINDING_free(cache->ent[i].blinding);
+    OPENSSL_free(cache);
+}
+
+void rsa_cleanup_int(void)
+{
+    if (blinding_cache_inited) {
+        CRYPTO_THREAD_cleanup_local(&blinding_cache_key);
+        blinding_cache_inited = 0;
+    }
+}
+
 static BN_BLINDING *rsa_get_blinding(RSA *rsa, int *local, BN_CTX *ctx)
 {
+    RSA_BLINDING_CACHE *cache;
     BN_BLINDING *ret;
 
+    if ((cache = blinding_cache_get()) != NULL) {
+        *local = 1;
+        return blinding_cache_lookup(cache, rsa, ctx);
+    }
+
+    /*
+     * No thread local storage available: fall back to the blindings held
+     * in the RSA object itself.
+     */
     CRYPTO_THREAD_write_lock(rsa->lock);
 
     if (rsa->blinding == NULL) {
@@ -0,0 +1,364 @@
+/*
+ * Copyright 2020 The OpenSSL Project Authors. All Rights Reserved.
+ *
+ * Licensed under the OpenSSL license (the "License").  You may not use
+ * this file except in compliance with the License.  You can obtain a copy
+ * in the file LICENSE in the source distribution or at
+ * https://www.openssl.org/source/license.html
+ */
+
+#include <limits.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <openssl/crypto.h>
+#include <openssl/sha.h>
+#include "crypto/sha.h"
+
+#if defined(SHA1_ASM) && defined(SHA256_ASM) \
+    && !defined(OPENSSL_NO_MULTIBLOCK) && ( \
+        defined(__x86_64)       || defined(__x86_64__)  || \
+        defined(_M_AMD64)       || defined(_M_X64)      )
+# define SHA_MULTI_BLOCK
+#endif
+
+#ifdef SHA_MULTI_BLOCK
+
+/*
+ * The sha1-mb and sha256-mb kernels hash up to eight independent streams at
+ * once, lane i of the state being word i of each row.  SHA-1 only uses the
+ * first five rows.
+ */
+# define SHA_MB_LANES    8
+
+typedef struct {
+    unsigned int h[8][SHA_MB_LANES];
+} SHA_MB_CTX;
+
+typedef struct {
+    const unsigned char *ptr;
+    int blocks;
+} HASH_DESC;
+
+void sha1_multi_block(SHA_MB_CTX *, const HASH_DESC *, int);
+void sha256_multi_block(SHA_MB_CTX *, const HASH_DESC *, int);
+
+typedef struct {
+    int busy;
+    size_t msg;                 /* index of the message in this lane */
+    const unsigned char *ptr;   /* next block to hash */
+    size_t blocks;              /* number of blocks left at |ptr| */
+    int tail;                   /* |ptr| is in |buf| */
+    unsigned char buf[128];     /* the padded final block(s) */
+} SHA_MB_LANE;
+
+typedef struct {
+    size_t len;
+    size_t msg;
+} SHA_MB_JOB;
+
+typedef struct {
+    void (*multi_block)(SHA_MB_CTX *, const HASH_DESC *, int);
+    /* Finish the message in |lane| with the single stream code */
+    void (*finish)(const SHA_MB_CTX *ctx, int lane, const unsigned char *p,
+                   size_t len, size_t done, unsigned char *md);
+    unsigned int iv[8];
+    int words;
+    size_t mdsize;
+} SHA_MB_METHOD;
+
+static void sha1_mb_finish(const SHA_MB_CTX *ctx, int lane,
+                           const unsigned char *p, size_t len, size_t done,
+                           unsigned char *md)
+{
+    SHA_CTX c;
+
+    SHA1_Init(&c);
+    c.h0 = ctx->h[0][lane];
+    c.h1 = ctx->h[1][lane];
+    c.h2 = ctx->h[2][lane];
+    c.h3 = ctx->h[3][lane];
+    c.h4 = ctx->h[4][lane];
+    c.Nl = (SHA_LONG)(done << 3);
+    c.Nh = (SHA_LONG)(done >> 29);
+    SHA1_Update(&c, p, len);
+    SHA1_Final(md, &c);
+    OPENSSL_cleanse(&c, sizeof(c));
+}
+
+static void sha256_mb_finish(const SHA_MB_CTX *ctx, int lane,
+                             const unsigned char *p, size_t len, size_t done,
+                             unsigned char *md)
+{
+    SHA256_CTX c;
+    int i;
+
+    SHA256_Init(&c);
+    for (i = 0; i < 8; i++)
+        c.h[i] = ctx->h[i][lane];
+    c.Nl = (SHA_LONG)(done << 3);
+    c.Nh = (SHA_LONG)(done >> 29);
+    SHA256_Update(&c, p, len);
+    SHA256_Final(md, &c);
+    OPENSSL_cleanse(&c, sizeof(c));
+}
+
+static void sha224_mb_finish(const SHA_MB_CTX *ctx, int lane,
+                             const unsigned char *p, size_t len, size_t done,
+                             unsigned char *md)
+{
+    SHA256_CTX c;
+    int i;
+
+    SHA224_Init(&c);
+    for (i = 0; i < 8; i++)
+        c.h[i] = ctx->h[i][lane];
+    c.Nl = (SHA_LONG)(done << 3);
+    c.Nh = (SHA_LONG)(done >> 29);
+    SHA224_Update(&c, p, len);
+    SHA224_Final(md, &c);
+    OPENSSL_cleanse(&c, sizeof(c));
+}
+
+/* Longest first, so that lanes running side by side have similar lengths */
+static int sha_mb_job_cmp(const void *a, const void *b)
+{
+    const SHA_MB_JOB *ja = a, *jb = b;
+
+    if (ja->len != jb->len)
+        return ja->len < jb->len ? 1 : -1;
+    return ja->msg < jb->msg ? -1 : ja->msg > jb->msg;
+}
+
+/* Point |lane| at the padded final block(s) of its message */
+static void sha_mb_lane_tail(SHA_MB_LANE *lane, const unsigned char *data,
+                             size_t len)
+{
+    size_t rem = len % 64, padlen;
+    uint64_t bits = (uint64_t)len << 3;
+    unsigned char *p;
+    int i;
+
+    padlen = rem + 9 <= 64 ? 64 : 128;
+    memset(lane->buf, 0, padlen);
+    if (rem > 0)
+        memcpy(lane->buf, data + len - rem, rem);
+    lane->buf[rem] = 0x80;
+    /* The length in bits, as a 64-bit big-endian number */
+    p = lane->buf + padlen - 8;
+    for (i = 0; i < 8; i++)
+        p[i] = (unsigned char)(bits >> (56 - 8 * i));
+
+    lane->ptr = lane->buf;
+    lane->blocks = padlen / 64;
+    lane->tail = 1;
+}
+
+static void sha_mb_lane_start(const SHA_MB_METHOD *meth, SHA_MB_CTX *ctx,
+                              SHA_MB_LANE *lane, int l, size_t msg,
+                              const void *const *data, const size_t *count)
+{
+    int w;
+
+    for (w = 0; w < meth->words; w++)
+        ctx->h[w][l] = meth->iv[w];
+    lane->busy = 1;
+    lane->msg = msg;
+    lane->ptr = data[msg];
+    lane->blocks = count[msg] / 64;
+    lane->tail = 0;
+    if (lane->blocks == 0)
+        sha_mb_lane_tail(lane, data[msg], count[msg]);
+}
+
+static void sha_mb_lane_output(const SHA_MB_METHOD *meth,
+                               const SHA_MB_CTX *ctx, int l, unsigned char *md)
+{
+    size_t w;
+    unsigned int h;
+
+    for (w = 0; w < meth->mdsize / 4; w++) {
+        h = ctx->h[w][l];
+        *md++ = (unsigned char)(h >> 24);
+        *md++ = (unsigned char)(h >> 16);
+        *md++ = (unsigned char)(h >> 8);
+        *md++ = (unsigned char)h;
+    }
+}
+
+/*
+ * Hash |num| messages, keeping all lanes of the kernel busy: the messages
+ * are started longest first and whenever one finishes the next one takes
+ * its lane.  Every kernel call runs for as many blocks as the shortest lane
+ * has left so that no lane idles during a call.
+ */
+static int sha_mb_digest(const SHA_MB_METHOD *meth, const void *const *data,
+                         const size_t *count, size_t num, unsigned char *md)
+{
+    unsigned char storage[sizeof(SHA_MB_CTX) + 32];
+    SHA_MB_CTX *ctx;
+    SHA_MB_LANE lanes[SHA_MB_LANES];
+    HASH_DESC desc[SHA_MB_LANES];
+    SHA_MB_JOB *jobs;
+    SHA_MB_LANE *lane;
+    size_t next = 0, i, n, done;
+    int l, active = 0;
+
+    if (num == 0)
+        return 1;
+    if ((jobs = OPENSSL_malloc(num * sizeof(*jobs))) == NULL)
+        return 0;
+    for (i = 0; i < num; i++) {
+        jobs[i].len = count[i];
+        jobs[i].msg = i;
+    }
+    qsort(jobs, num, sizeof(*jobs), sha_mb_job_cmp);
+
+    ctx = (SHA_MB_CTX *)(storage + 32 - ((size_t)storage % 32)); /* align */
+    memset(lanes, 0, sizeof(lanes));
+
+    for (;;) {
+        for (l = 0; l < SHA_MB_LANES && next < num; l++) {
+            if (lanes[l].busy)
+                continue;
+            sha_mb_lane_start(meth, ctx, &lanes[l], l, jobs[next++].msg,
+                              data, count);
+            active++;
+        }
+        if (active == 0)
+            break;
+
+        /*
+         * A lone long message is faster on the single stream code, which
+         * can carry on from the state it has reached here.
+         */
+        if (active == 1) {
+            for (l = 0; !lanes[l].busy; l++)
+                continue;
+            lane = &lanes[l];
+            if (!lane->tail) {
+                done = lane->ptr - (const unsigned char *)data[lane->msg];
+                meth->finish(ctx, l, lane->ptr, count[lane->msg] - done, done,
+                             md + lane->msg * meth->mdsize);
+                break;
+            }
+        }
+
+        for (n = INT_MAX, l = 0; l < SHA_MB_LANES; l++)
+            if (lanes[l].busy && lanes[l].blocks < n)
+                n = lanes[l].blocks;
+        for (l = 0; l < SHA_MB_LANES; l++) {
+            /* A lane with no blocks to do is left alone by the kernel */
+            desc[l].ptr = lanes[l].ptr;
+            desc[l].blocks = lanes[l].busy ? (int)n : 0;
+        }
+        meth->multi_block(ctx, desc, SHA_MB_LANES / 4);
+
+        for (l = 0; l < SHA_MB_LANES; l++) {
+            lane = &lanes[l];
+            if (!lane->busy)
+                continue;
+            lane->ptr += n * 64;
+            if ((lane->blocks -= n) > 0)
+                continue;
+            if (!lane->tail) {
+                sha_mb_lane_tail(lane, data[lane->msg], count[lane->msg]);
+                continue;
+            }
+            sha_mb_lane_output(meth, ctx, l, md + lane->msg * meth->mdsize);
+            lane->busy = 0;
+            active--;
+        }
+    }
+
+    OPENSSL_cleanse(storage, sizeof(storage));
+    OPENSSL_cleanse(lanes, sizeof(lanes));
+    OPENSSL_free(jobs);
+    return 1;
+}
+
+int sha1_digest_multi(const void *const *data, const size_t *count,
+                      size_t num, unsigned char *md)
+{
+    SHA_MB_METHOD meth;
+    SHA_CTX c;
+
+    SHA1_Init(&c);
+    meth.multi_block = sha1_multi_block;
+    meth.finish = sha1_mb_finish;
+    meth.iv[0] = c.h0;
+    meth.iv[1] = c.h1;
+    meth.iv[2] = c.h2;
+    meth.iv[3] = c.h3;
+    meth.iv[4] = c.h4;
+    meth.words = 5;
+    meth.mdsize = SHA_DIGEST_LENGTH;
+    return sha_mb_digest(&meth, data, count, num, md);
+}
+
+static int sha256_224_digest_multi(const void *const *data,
+                                   const size_t *count, size_t num,
+                                   unsigned char *md, int is224)
+{
+    SHA_MB_METHOD meth;
+    SHA256_CTX c;
+    int i;
+
+    if (is224)
+        SHA224_Init(&c);
+    else
+        SHA256_Init(&c);
+    meth.multi_block = sha256_multi_block;
+    meth.finish = is224 ? sha224_mb_finish : sha256_mb_finish;
+    for (i = 0; i < 8; i++)
+        meth.iv[i] = c.h[i];
+    meth.words = 8;
+    meth.mdsize = c.md_len;
+    return sha_mb_digest(&meth, data, count, num, md);
+}
+
+int sha224_digest_multi(const void *const *data, const size_t *count,
+                        size_t num, unsigned char *md)
+{
+    return sha256_224_digest_multi(data, count, num, md, 1);
+}
+
+int sha256_digest_multi(const void *const *data, const size_t *count,
+                        size_t num, unsigned char *md)
+{
+    return sha256_224_digest_multi(data, count, num, md, 0);
+}
+
+#else
+
+int sha1_digest_multi(const void *const *data, const size_t *count,
+                      size_t num, unsigned char *md)
+{
+    size_t i;
+
+    for (i = 0; i < num; i++)
+        SHA1(data[i], count[i], md + i * SHA_DIGEST_LENGTH);
+    return 1;
+}
+
+int sha224_digest_multi(const void *const *data, const size_t *count,
+                        size_t num, unsigned char *md)
+{
+    size_t i;
+
+    for (i = 0; i < num; i++)
+        SHA224(data[i], count[i], md + i * SHA224_DIGEST_LENGTH);
+    return 1;
+}
+
+int sha256_digest_multi(const void *const *data, const size_t *count,
+                        size_t num, unsigned char *md)
+{
+    size_t i;
+
+    for (i = 0; i < num; i++)
+        SHA256(data[i], count[i], md + i * SHA256_DIGEST_LENGTH);
+    return 1;
+}
+
+#endif
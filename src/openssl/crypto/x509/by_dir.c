@@ -9,6 +9,7 @@
 
 #include "e_os.h"
 #include "internal/cryptlib.h"
+#include "internal/o_dir.h"
 #include <stdio.h>
 #include <time.h>
 #include <errno.h>
@@ -16,9 +17,13 @@
 
 #ifndef OPENSSL_NO_POSIX_IO
 # include <sys/stat.h>
+# ifdef _WIN32
+#  define stat _stat
+# endif
 #endif
 
 #include <openssl/x509.h>
+#include "crypto/ctype.h"
 #include "crypto/x509.h"
 #include "x509_local.h"
 
@@ -27,16 +32,30 @@ struct lookup_dir_hashes_st {
     int suffix;
 };
 
+struct lookup_dir_index_st {
+    unsigned long hash;
+    X509_LOOKUP_TYPE type;
+};
+
 struct lookup_dir_entry_st {
     char *dir;
     int dir_type;
     STACK_OF(BY_DIR_HASH) *hashes;
+    /*
+     * Hashed names present in the directory when it was last scanned, only
+     * maintained when the lookup has indexing enabled.
+     */
+    STACK_OF(BY_DIR_INDEX) *index;
+    time_t index_mtime;
+    time_t index_checked;
 };
 
 typedef struct lookup_dir_st {
     BUF_MEM *buffer;
     STACK_OF(BY_DIR_ENTRY) *dirs;
     CRYPTO_RWLOCK *lock;
+    int indexed;
+    long refresh;
 } BY_DIR;
 
 static int dir_ctrl(X509_LOOKUP *ctx, int cmd, const char *argp, long argl,
@@ -44,6 +63,7 @@ static int dir_ctrl(X509_LOOKUP *ctx, int cmd, const char *argp, long argl,
 static int new_dir(X509_LOOKUP *lu);
 static void free_dir(X509_LOOKUP *lu);
 static int add_cert_dir(BY_DIR *ctx, const char *dir, int type);
+static void set_dir_index(BY_DIR *ctx, long refresh);
 static int get_cert_by_subject(X509_LOOKUP *xl, X509_LOOKUP_TYPE type,
                                X509_NAME *name, X509_OBJECT *ret);
 static X509_LOOKUP_METHOD x509_dir_lookup = {
@@ -86,6 +106,10 @@ static int dir_ctrl(X509_LOOKUP *ctx, int cmd, const char *argp, long argl,
         } else
             ret = add_cert_dir(ld, argp, (int)argl);
         break;
+    case X509_L_DIR_INDEX:
+        set_dir_index(ld, argl);
+        ret = 1;
+        break;
     }
     return ret;
 }
@@ -104,6 +128,8 @@ static int new_dir(X509_LOOKUP *lu)
         goto err;
     }
     a->dirs = NULL;
+    a->indexed = 0;
+    a->refresh = 0;
     a->lock = CRYPTO_THREAD_lock_new();
     if (a->lock == NULL) {
         BUF_MEM_free(a->buffer);
@@ -133,10 +159,26 @@ static int by_dir_hash_cmp(const BY_DIR_HASH *const *a,
     return 0;
 }
 
+static void by_dir_index_free(BY_DIR_INDEX *idx)
+{
+    OPENSSL_free(idx);
+}
+
+static int by_dir_index_cmp(const BY_DIR_INDEX *const *a,
+                            const BY_DIR_INDEX *const *b)
+{
+    if ((*a)->hash > (*b)->hash)
+        return 1;
+    if ((*a)->hash < (*b)->hash)
+        return -1;
+    return (int)(*a)->type - (int)(*b)->type;
+}
+
 static void by_dir_entry_free(BY_DIR_ENTRY *ent)
 {
     OPENSSL_free(ent->dir);
     sk_BY_DIR_HASH_pop_free(ent->hashes, by_dir_hash_free);
+    sk_BY_DIR_INDEX_pop_free(ent->index, by_dir_index_free);
     OPENSSL_free(ent);
 }
 
@@ -192,6 +234,9 @@ static int add_cert_dir(BY_DIR *ctx, const char *dir, int type)
                 return 0;
             }
             ent->dir_type = type;
+            ent->index = NULL;
+            ent->index_mtime = 0;
+            ent->index_checked = 0;
             ent->hashes = sk_BY_DIR_HASH_new(by_dir_hash_cmp);
             ent->dir = OPENSSL_strndup(ss, len);
             if (ent->dir == NULL || ent->hashes == NULL) {
@@ -208,6 +253,150 @@ static int add_cert_dir(BY_DIR *ctx, const char *dir, int type)
     return 1;
 }
 
+/*
+ * Enable the in-memory index of hashed names.  Existing indexes are dropped
+ * so that the next lookup rescans each directory.  The directory is checked
+ * for modification at most once every |refresh| seconds, a negative value
+ * disables automatic rescanning altogether.
+ */
+static void set_dir_index(BY_DIR *ctx, long refresh)
+{
+    int i;
+
+    CRYPTO_THREAD_write_lock(ctx->lock);
+    ctx->indexed = 1;
+    ctx->refresh = refresh;
+    for (i = 0; i < sk_BY_DIR_ENTRY_num(ctx->dirs); i++) {
+        BY_DIR_ENTRY *ent = sk_BY_DIR_ENTRY_value(ctx->dirs, i);
+
+        sk_BY_DIR_INDEX_pop_free(ent->index, by_dir_index_free);
+        ent->index = NULL;
+    }
+    CRYPTO_THREAD_unlock(ctx->lock);
+}
+
+/*
+ * Parse a directory entry of the form hash.N or hash.rN.  Returns 1 and
+ * fills in |idx| if the name matches, 0 otherwise.
+ */
+static int parse_index_name(const char *name, BY_DIR_INDEX *idx)
+{
+    unsigned long h = 0;
+    int i;
+
+    for (i = 0; i < 8; i++) {
+        int v = OPENSSL_hexchar2int((unsigned char)name[i]);
+
+        if (v < 0)
+            return 0;
+        h = (h << 4) | (unsigned long)v;
+    }
+    if (name[i++] != '.')
+        return 0;
+    idx->type = X509_LU_X509;
+    if (name[i] == 'r') {
+        idx->type = X509_LU_CRL;
+        i++;
+    }
+    if (name[i] == '\0')
+        return 0;
+    for (; name[i] != '\0'; i++)
+        if (!ossl_isdigit(name[i]))
+            return 0;
+    idx->hash = h;
+    return 1;
+}
+
+/*
+ * Scan the directory of |ent| and replace its index.  Must be called with
+ * the write lock held.
+ */
+static int build_dir_index(BY_DIR_ENTRY *ent)
+{
+    STACK_OF(BY_DIR_INDEX) *index;
+    OPENSSL_DIR_CTX *d = NULL;
+    const char *name;
+    BY_DIR_INDEX tmp, *idx;
+
+    if ((index = sk_BY_DIR_INDEX_new(by_dir_index_cmp)) == NULL) {
+        X509err(X509_F_BUILD_DIR_INDEX, ERR_R_MALLOC_FAILURE);
+        return 0;
+    }
+    while ((name = OPENSSL_DIR_read(&d, ent->dir)) != NULL) {
+        if (!parse_index_name(name, &tmp))
+            continue;
+        if ((idx = OPENSSL_malloc(sizeof(*idx))) == NULL
+                || !sk_BY_DIR_INDEX_push(index, idx)) {
+            OPENSSL_free(idx);
+            OPENSSL_DIR_end(&d);
+            sk_BY_DIR_INDEX_pop_free(index, by_dir_index_free);
+            X509err(X509_F_BUILD_DIR_INDEX, ERR_R_MALLOC_FAILURE);
+            return 0;
+        }
+        *idx = tmp;
+    }
+    if (d == NULL) {
+        /* The directory could not be opened at all */
+        sk_BY_DIR_INDEX_free(index);
+        return 0;
+    }
+    OPENSSL_DIR_end(&d);
+    sk_BY_DIR_INDEX_sort(index);
+    sk_BY_DIR_INDEX_pop_free(ent->index, by_dir_index_free);
+    ent->index = index;
+    return 1;
+}
+
+/*
+ * Consult the index of |ent| for an object of |type| with hash |h|.
+ * Returns 1 if the directory may hold a match, 0 if it certainly does not
+ * and -1 if no index is available, in which case the caller falls back to
+ * probing the file system.
+ */
+static int dir_index_check(BY_DIR *ctx, BY_DIR_ENTRY *ent, unsigned long h,
+                           X509_LOOKUP_TYPE type)
+{
+    BY_DIR_INDEX tmp;
+    time_t now = time(NULL);
+    int ret;
+
+    tmp.hash = h;
+    tmp.type = type;
+
+    CRYPTO_THREAD_read_lock(ctx->lock);
+    if (ent->index != NULL
+            && (ctx->refresh < 0 || now - ent->index_checked < ctx->refresh)) {
+        ret = sk_BY_DIR_INDEX_find(ent->index, &tmp) >= 0;
+        CRYPTO_THREAD_unlock(ctx->lock);
+        return ret;
+    }
+    CRYPTO_THREAD_unlock(ctx->lock);
+
+    CRYPTO_THREAD_write_lock(ctx->lock);
+    /* Look again in case another thread refreshed the index first */
+    if (ent->index == NULL
+            || (ctx->refresh >= 0 && now - ent->index_checked >= ctx->refresh)) {
+        time_t mtime = 0;
+
+#ifndef OPENSSL_NO_POSIX_IO
+        struct stat st;
+
+        if (stat(ent->dir, &st) == 0)
+            mtime = st.st_mtime;
+#endif
+        if ((ent->index == NULL || mtime != ent->index_mtime)
+                && build_dir_index(ent))
+            ent->index_mtime = mtime;
+        ent->index_checked = now;
+    }
+    if (ent->index == NULL)
+        ret = -1;
+    else
+        ret = sk_BY_DIR_INDEX_find(ent->index, &tmp) >= 0;
+    CRYPTO_THREAD_unlock(ctx->lock);
+    return ret;
+}
+
 static int get_cert_by_subject(X509_LOOKUP *xl, X509_LOOKUP_TYPE type,
                                X509_NAME *name, X509_OBJECT *ret)
 {
@@ -217,7 +406,7 @@ static int get_cert_by_subject(X509_LOOKUP *xl, X509_LOOKUP_TYPE type,
         X509_CRL crl;
     } data;
     int ok = 0;
-    int i, j, k;
+    int i, j, k, indexed;
     unsigned long h;
     BUF_MEM *b = NULL;
     X509_OBJECT stmp, *tmp;
@@ -246,6 +435,9 @@ static int get_cert_by_subject(X509_LOOKUP *xl, X509_LOOKUP_TYPE type,
     }
 
     ctx = (BY_DIR *)xl->method_data;
+    CRYPTO_THREAD_read_lock(ctx->lock);
+    indexed = ctx->indexed;
+    CRYPTO_THREAD_unlock(ctx->lock);
 
     h = X509_NAME_hash(name);
     for (i = 0; i < sk_BY_DIR_ENTRY_num(ctx->dirs); i++) {
@@ -254,6 +446,9 @@ static int get_cert_by_subject(X509_LOOKUP *xl, X509_LOOKUP_TYPE type,
         BY_DIR_HASH htmp, *hent;
 
         ent = sk_BY_DIR_ENTRY_value(ctx->dirs, i);
+        /* A miss in the index needs no file system access */
+        if (indexed && dir_index_check(ctx, ent, h, type) == 0)
+            continue;
         j = strlen(ent->dir) + 1 + 8 + 6 + 1 + 1;
         if (!BUF_MEM_grow(b, j)) {
             X509err(X509_F_GET_CERT_BY_SUBJECT, ERR_R_MALLOC_FAILURE);
@@ -303,9 +498,6 @@ static int get_cert_by_subject(X509_LOOKUP *xl, X509_LOOKUP_TYPE type,
                              "%s%c%08lx.%s%d", ent->dir, c, h, postfix, k);
             }
 #ifndef OPENSSL_NO_POSIX_IO
-# ifdef _WIN32
-#  define stat _stat
-# endif
             {
                 struct stat st;
                 if (stat(b->data, &st) < 0)
@@ -0,0 +1,424 @@
+/*
+ * Copyright 2020 The OpenSSL Project Authors. All Rights Reserved.
+ *
+ * Licensed under the OpenSSL license (the "License").  You may not use
+ * this file except in compliance with the License.  You can obtain a copy
+ * in the file LICENSE in the source distribution or at
+ * https://www.openssl.org/source/license.html
+ */
+
+#include "e_os.h"
+#include "internal/cryptlib.h"
+#include <stdio.h>
+#include <string.h>
+
+#if defined(OPENSSL_SYS_UNIX) && !defined(OPENSSL_NO_POSIX_IO)
+# include <sys/types.h>
+# include <sys/mman.h>
+# include <sys/stat.h>
+# include <fcntl.h>
+# include <unistd.h>
+# define HASH_FILE_MMAP
+#endif
+
+#include <openssl/buffer.h>
+#include <openssl/x509.h>
+#include "crypto/x509.h"
+#include "x509_local.h"
+
+/*-
+ * A hashed certificate file holds DER encoded certificates together with an
+ * index sorted by subject name hash, so that a lookup by subject only has to
+ * decode the certificates that can match.  All integers are big endian.
+ *
+ *   magic     8 bytes     "OSSLHCF1"
+ *   count     4 bytes     number of certificates
+ *   index     count * 12  subject hash, offset and length of each certificate
+ *   data                  DER encoded certificates
+ *
+ * Offsets are relative to the start of the file.  Entries with the same hash
+ * keep the order in which the certificates were written.
+ */
+#define HASH_FILE_MAGIC         "OSSLHCF1"
+#define HASH_FILE_MAGIC_LEN     8
+#define HASH_FILE_HEADER_LEN    (HASH_FILE_MAGIC_LEN + 4)
+#define HASH_FILE_ENTRY_LEN     12
+
+typedef struct lookup_hash_file_st {
+    const unsigned char *data;
+    size_t len;
+    int mapped;
+    size_t num;
+    /* Lazily decoded certificates, one per index entry */
+    X509 **certs;
+    CRYPTO_RWLOCK *lock;
+} BY_HASH_FILE;
+
+static int hash_file_ctrl(X509_LOOKUP *ctx, int cmd, const char *argp,
+                          long argl, char **ret);
+static int new_hash_file(X509_LOOKUP *lu);
+static void free_hash_file(X509_LOOKUP *lu);
+static int get_cert_by_subject(X509_LOOKUP *xl, X509_LOOKUP_TYPE type,
+                               X509_NAME *name, X509_OBJECT *ret);
+static X509_LOOKUP_METHOD x509_hash_file_lookup = {
+    "Load certs on demand from a hashed certificate file",
+    new_hash_file,              /* new_item */
+    free_hash_file,             /* free */
+    NULL,                       /* init */
+    NULL,                       /* shutdown */
+    hash_file_ctrl,             /* ctrl */
+    get_cert_by_subject,        /* get_by_subject */
+    NULL,                       /* get_by_issuer_serial */
+    NULL,                       /* get_by_fingerprint */
+    NULL,                       /* get_by_alias */
+};
+
+X509_LOOKUP_METHOD *X509_LOOKUP_hash_file(void)
+{
+    return &x509_hash_file_lookup;
+}
+
+static unsigned long get_u32(const unsigned char *p)
+{
+    return ((unsigned long)p[0] << 24) | ((unsigned long)p[1] << 16)
+           | ((unsigned long)p[2] << 8) | (unsigned long)p[3];
+}
+
+static void put_u32(unsigned char *p, unsigned long v)
+{
+    p[0] = (unsigned char)(v >> 24);
+    p[1] = (unsigned char)(v >> 16);
+    p[2] = (unsigned char)(v >> 8);
+    p[3] = (unsigned char)v;
+}
+
+static const unsigned char *entry_ptr(const BY_HASH_FILE *hf, size_t i)
+{
+    return hf->data + HASH_FILE_HEADER_LEN + i * HASH_FILE_ENTRY_LEN;
+}
+
+static int new_hash_file(X509_LOOKUP *lu)
+{
+    BY_HASH_FILE *hf = OPENSSL_zalloc(sizeof(*hf));
+
+    if (hf == NULL) {
+        X509err(X509_F_NEW_HASH_FILE, ERR_R_MALLOC_FAILURE);
+        return 0;
+    }
+    hf->lock = CRYPTO_THREAD_lock_new();
+    if (hf->lock == NULL) {
+        X509err(X509_F_NEW_HASH_FILE, ERR_R_MALLOC_FAILURE);
+        OPENSSL_free(hf);
+        return 0;
+    }
+    lu->method_data = hf;
+    return 1;
+}
+
+static void unload_hash_file(BY_HASH_FILE *hf)
+{
+    size_t i;
+
+    if (hf->certs != NULL) {
+        for (i = 0; i < hf->num; i++)
+            X509_free(hf->certs[i]);
+        OPENSSL_free(hf->certs);
+    }
+#ifdef HASH_FILE_MMAP
+    if (hf->mapped)
+        munmap((void *)hf->data, hf->len);
+    else
+#endif
+        OPENSSL_free((void *)hf->data);
+    hf->data = NULL;
+    hf->len = 0;
+    hf->mapped = 0;
+    hf->num = 0;
+    hf->certs = NULL;
+}
+
+static void free_hash_file(X509_LOOKUP *lu)
+{
+    BY_HASH_FILE *hf = (BY_HASH_FILE *)lu->method_data;
+
+    unload_hash_file(hf);
+    CRYPTO_THREAD_lock_free(hf->lock);
+    OPENSSL_free(hf);
+}
+
+/* Read the whole file into memory, for when it cannot be mapped */
+static int read_hash_file(BY_HASH_FILE *hf, const char *file)
+{
+    BIO *in;
+    BUF_MEM *b = NULL;
+    size_t len = 0;
+    int n, ret = 0;
+
+    if ((in = BIO_new_file(file, "rb")) == NULL) {
+        X509err(X509_F_READ_HASH_FILE, ERR_R_SYS_LIB);
+        return 0;
+    }
+    if ((b = BUF_MEM_new()) == NULL) {
+        X509err(X509_F_READ_HASH_FILE, ERR_R_MALLOC_FAILURE);
+        goto err;
+    }
+    for (;;) {
+        if (!BUF_MEM_grow(b, len + 4096)) {
+            X509err(X509_F_READ_HASH_FILE, ERR_R_MALLOC_FAILURE);
+            goto err;
+        }
+        n = BIO_read(in, b->data + len, 4096);
+        if (n <= 0)
+            break;
+        len += n;
+    }
+    hf->data = (unsigned char *)b->data;
+    hf->len = len;
+    hf->mapped = 0;
+    b->data = NULL;
+    ret = 1;
+ err:
+    BUF_MEM_free(b);
+    BIO_free(in);
+    return ret;
+}
+
+#ifdef HASH_FILE_MMAP
+static int map_hash_file(BY_HASH_FILE *hf, const char *file)
+{
+    struct stat st;
+    void *p;
+    int fd;
+
+    if ((fd = open(file, O_RDONLY)) < 0)
+        return 0;
+    if (fstat(fd, &st) < 0 || st.st_size <= 0) {
+        close(fd);
+        return 0;
+    }
+    p = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (p == MAP_FAILED)
+        return 0;
+    hf->data = p;
+    hf->len = (size_t)st.st_size;
+    hf->mapped = 1;
+    return 1;
+}
+#endif
+
+/*
+ * Check that the header and the index are consistent with the file size, so
+ * that entries can later be decoded without further bounds checks.
+ */
+static int check_hash_file(BY_HASH_FILE *hf)
+{
+    size_t i, num, off, len;
+    unsigned long prev = 0;
+
+    if (hf->len < HASH_FILE_HEADER_LEN
+        || memcmp(hf->data, HASH_FILE_MAGIC, HASH_FILE_MAGIC_LEN) != 0)
+        return 0;
+    num = get_u32(hf->data + HASH_FILE_MAGIC_LEN);
+    if (num > (hf->len - HASH_FILE_HEADER_LEN) / HASH_FILE_ENTRY_LEN)
+        return 0;
+    hf->num = num;
+    for (i = 0; i < num; i++) {
+        const unsigned char *e = entry_ptr(hf, i);
+        unsigned long h = get_u32(e);
+
+        if (i > 0 && h < prev)
+            return 0;
+        off = get_u32(e + 4);
+        len = get_u32(e + 8);
+        if (off > hf->len || len > hf->len - off)
+            return 0;
+        prev = h;
+    }
+    return 1;
+}
+
+static int load_hash_file(BY_HASH_FILE *hf, const char *file)
+{
+    int ok = 0;
+
+    if (file == NULL) {
+        X509err(X509_F_LOAD_HASH_FILE, ERR_R_PASSED_NULL_PARAMETER);
+        return 0;
+    }
+
+    CRYPTO_THREAD_write_lock(hf->lock);
+    unload_hash_file(hf);
+#ifdef HASH_FILE_MMAP
+    if (!map_hash_file(hf, file))
+#endif
+        if (!read_hash_file(hf, file))
+            goto err;
+    if (!check_hash_file(hf)) {
+        X509err(X509_F_LOAD_HASH_FILE, X509_R_INVALID_HASH_FILE);
+        goto err;
+    }
+    if (hf->num > 0
+        && (hf->certs = OPENSSL_zalloc(hf->num * sizeof(*hf->certs))) == NULL) {
+        X509err(X509_F_LOAD_HASH_FILE, ERR_R_MALLOC_FAILURE);
+        goto err;
+    }
+    ok = 1;
+ err:
+    if (!ok) {
+        unload_hash_file(hf);
+        ERR_add_error_data(2, "file=", file);
+    }
+    CRYPTO_THREAD_unlock(hf->lock);
+    return ok;
+}
+
+static int hash_file_ctrl(X509_LOOKUP *ctx, int cmd, const char *argp,
+                          long argl, char **ret)
+{
+    BY_HASH_FILE *hf = (BY_HASH_FILE *)ctx->method_data;
+
+    switch (cmd) {
+    case X509_L_FILE_LOAD:
+        return load_hash_file(hf, argp);
+    }
+    return 0;
+}
+
+/*
+ * Return the certificate for index entry |i|, decoding it on first use.
+ * Must be called with the write lock held.
+ */
+static X509 *hash_file_cert(BY_HASH_FILE *hf, size_t i)
+{
+    const unsigned char *e, *p;
+
+    if (hf->certs[i] == NULL) {
+        e = entry_ptr(hf, i);
+        p = hf->data + get_u32(e + 4);
+        hf->certs[i] = d2i_X509(NULL, &p, (long)get_u32(e + 8));
+    }
+    return hf->certs[i];
+}
+
+static int get_cert_by_subject(X509_LOOKUP *xl, X509_LOOKUP_TYPE type,
+                               X509_NAME *name, X509_OBJECT *ret)
+{
+    BY_HASH_FILE *hf = (BY_HASH_FILE *)xl->method_data;
+    X509_OBJECT *tmp;
+    unsigned long h;
+    size_t lo, hi, mid, i;
+    int added = 0;
+
+    if (name == NULL || type != X509_LU_X509)
+        return 0;
+
+    h = X509_NAME_hash(name);
+
+    CRYPTO_THREAD_write_lock(hf->lock);
+    /* Find the first index entry with a matching hash */
+    lo = 0;
+    hi = hf->num;
+    while (lo < hi) {
+        mid = lo + (hi - lo) / 2;
+        if (get_u32(entry_ptr(hf, mid)) < h)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    for (i = lo; i < hf->num && get_u32(entry_ptr(hf, i)) == h; i++) {
+        X509 *x = hash_file_cert(hf, i);
+
+        if (x == NULL || X509_NAME_cmp(X509_get_subject_name(x), name) != 0)
+            continue;
+        if (!X509_STORE_add_cert(xl->store_ctx, x))
+            break;
+        added = 1;
+    }
+    CRYPTO_THREAD_unlock(hf->lock);
+
+    if (!added)
+        return 0;
+
+    /* Pull it out of the store cache, like the hashed directory method */
+    X509_STORE_lock(xl->store_ctx);
+    tmp = X509_OBJECT_retrieve_by_subject(xl->store_ctx->objs, type, name);
+    X509_STORE_unlock(xl->store_ctx);
+    if (tmp == NULL)
+        return 0;
+    ret->type = tmp->type;
+    memcpy(&ret->data, &tmp->data, sizeof(ret->data));
+    return 1;
+}
+
+typedef struct {
+    unsigned long hash;
+    int pos;
+    unsigned char *der;
+    int len;
+} HASH_FILE_ENTRY;
+
+static int hash_file_entry_cmp(const void *a, const void *b)
+{
+    const HASH_FILE_ENTRY *ea = a, *eb = b;
+
+    if (ea->hash != eb->hash)
+        return ea->hash < eb->hash ? -1 : 1;
+    return ea->pos - eb->pos;
+}
+
+int X509_hash_file_write_bio(BIO *out, STACK_OF(X509) *certs)
+{
+    HASH_FILE_ENTRY *ents = NULL;
+    unsigned char buf[HASH_FILE_ENTRY_LEN];
+    unsigned long off;
+    int i, num = sk_X509_num(certs), ret = 0;
+
+    if (num > 0 && (ents = OPENSSL_zalloc(num * sizeof(*ents))) == NULL) {
+        X509err(X509_F_X509_HASH_FILE_WRITE_BIO, ERR_R_MALLOC_FAILURE);
+        return 0;
+    }
+
+    off = HASH_FILE_HEADER_LEN + (unsigned long)num * HASH_FILE_ENTRY_LEN;
+    for (i = 0; i < num; i++) {
+        X509 *x = sk_X509_value(certs, i);
+
+        ents[i].hash = X509_NAME_hash(X509_get_subject_name(x));
+        ents[i].pos = i;
+        if ((ents[i].len = i2d_X509(x, &ents[i].der)) <= 0) {
+            X509err(X509_F_X509_HASH_FILE_WRITE_BIO, ERR_R_ASN1_LIB);
+            goto err;
+        }
+        if (off > 0xffffffffUL - (unsigned long)ents[i].len) {
+            X509err(X509_F_X509_HASH_FILE_WRITE_BIO, X509_R_INVALID_HASH_FILE);
+            goto err;
+        }
+        off += ents[i].len;
+    }
+    if (num > 0)
+        qsort(ents, num, sizeof(*ents), hash_file_entry_cmp);
+
+    memcpy(buf, HASH_FILE_MAGIC, HASH_FILE_MAGIC_LEN);
+    put_u32(buf + HASH_FILE_MAGIC_LEN, (unsigned long)num);
+    if (BIO_write(out, buf, HASH_FILE_HEADER_LEN) != HASH_FILE_HEADER_LEN)
+        goto err;
+
+    off = HASH_FILE_HEADER_LEN + (unsigned long)num * HASH_FILE_ENTRY_LEN;
+    for (i = 0; i < num; i++) {
+        put_u32(buf, ents[i].hash);
+        put_u32(buf + 4, off);
+        put_u32(buf + 8, (unsigned long)ents[i].len);
+        if (BIO_write(out, buf, HASH_FILE_ENTRY_LEN) != HASH_FILE_ENTRY_LEN)
+            goto err;
+        off += ents[i].len;
+    }
+    for (i = 0; i < num; i++)
+        if (BIO_write(out, ents[i].der, ents[i].len) != ents[i].len)
+            goto err;
+    ret = 1;
+ err:
+    for (i = 0; i < num; i++)
+        OPENSSL_free(ents[i].der);
+    OPENSSL_free(ents);
+    return ret;
+}
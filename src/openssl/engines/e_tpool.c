@@ -0,0 +1,1061 @@
+/*
+ * Copyright 2020 The OpenSSL Project Authors. All Rights Reserved.
+ *
+ * Licensed under the OpenSSL license (the "License").  You may not use
+ * this file except in compliance with the License.  You can obtain a copy
+ * in the file LICENSE in the source distribution or at
+ * https://www.openssl.org/source/license.html
+ */
+
+/*
+ * Thread pool offload engine.  RSA private key operations, ECDSA signatures
+ * and ECDH are handed to a pool of worker threads when they are called from
+ * within an ASYNC job (e.g. an SSL_MODE_ASYNC handshake).  The job is paused
+ * while a worker does the bignum arithmetic, and the worker wakes it up
+ * through the job's ASYNC_WAIT_CTX file descriptor once the result is ready.
+ * Outside of an ASYNC job the operations are done inline.
+ *
+ * RSA key generation searches for primes on all workers at once, wherever it
+ * is called from, and blocks the caller until the key is ready.  Keys with
+ * more than two primes are generated inline by the builtin code.
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include <openssl/engine.h>
+#include <openssl/async.h>
+#include <openssl/crypto.h>
+#include <openssl/err.h>
+#include <openssl/rsa.h>
+#include <openssl/ec.h>
+#include <openssl/bn.h>
+#include <openssl/rand.h>
+#include <openssl/sha.h>
+
+#if defined(OPENSSL_SYS_UNIX) && defined(OPENSSL_THREADS)
+# define TPOOL_PTHREADS
+# include <pthread.h>
+# include <unistd.h>
+#endif
+
+#include "e_tpool_err.c"
+
+/* Engine Id and Name */
+static const char *engine_tpool_id = "tpool";
+static const char *engine_tpool_name = "Thread pool offload engine";
+
+/* Engine Lifetime functions */
+static int tpool_destroy(ENGINE *e);
+static int tpool_init(ENGINE *e);
+static int tpool_finish(ENGINE *e);
+static int tpool_ctrl(ENGINE *e, int cmd, long i, void *p, void (*f) (void));
+
+#define TPOOL_CMD_THREADS           ENGINE_CMD_BASE
+#define TPOOL_MAX_THREADS           256
+#define TPOOL_DEFAULT_THREADS       4
+
+static const ENGINE_CMD_DEFN tpool_cmd_defns[] = {
+    {TPOOL_CMD_THREADS,
+     "THREADS",
+     "Number of worker threads, set before the engine is initialised",
+     ENGINE_CMD_FLAG_NUMERIC},
+    {0, NULL, NULL, 0}
+};
+
+static RSA_METHOD *tpool_rsa_method = NULL;
+#ifndef OPENSSL_NO_EC
+static EC_KEY_METHOD *tpool_ec_method = NULL;
+#endif
+
+/*
+ * A request for a worker thread.  It lives on the stack of the paused ASYNC
+ * job until the worker has set |done|.
+ */
+#define TPOOL_MAX_ERRS              4
+
+typedef struct tpool_search_st TPOOL_SEARCH;
+typedef struct tpool_req_st TPOOL_REQ;
+struct tpool_req_st {
+    int (*run)(TPOOL_REQ *req);
+    /* RSA */
+    int (*rsa_op)(int flen, const unsigned char *from, unsigned char *to,
+                  RSA *rsa, int padding);
+    int flen;
+    const unsigned char *from;
+    unsigned char *to;
+    RSA *rsa;
+    int padding;
+    /* RSA key generation, the window of |search| to look for a prime in */
+    TPOOL_SEARCH *search;
+    int window;
+#ifndef OPENSSL_NO_EC
+    /* ECDSA */
+    const unsigned char *dgst;
+    int dlen;
+    const BIGNUM *kinv;
+    const BIGNUM *r;
+    ECDSA_SIG *sig;
+    /* ECDH */
+    unsigned char **psec;
+    size_t *pseclen;
+    const EC_POINT *pub_key;
+    const EC_KEY *eckey;
+#endif
+    int ret;
+    /* Errors raised by the worker, replayed in the job */
+    unsigned long errs[TPOOL_MAX_ERRS];
+    const char *err_files[TPOOL_MAX_ERRS];
+    int err_lines[TPOOL_MAX_ERRS];
+    int num_errs;
+    /* -1 if the submitter waits on tpool_done_cond instead */
+    OSSL_ASYNC_FD wakefd;
+    int done;
+    TPOOL_REQ *next;
+};
+
+#ifdef TPOOL_PTHREADS
+static pthread_mutex_t tpool_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t tpool_cond = PTHREAD_COND_INITIALIZER;
+static pthread_cond_t tpool_done_cond = PTHREAD_COND_INITIALIZER;
+static TPOOL_REQ *tpool_head = NULL, *tpool_tail = NULL;
+static pthread_t *tpool_threads = NULL;
+static long tpool_num_started = 0;
+static int tpool_running = 0;
+static int tpool_stopping = 0;
+#endif
+static long tpool_num_threads = TPOOL_DEFAULT_THREADS;
+
+#ifdef TPOOL_PTHREADS
+/* RSA */
+
+static int tpool_rsa_priv_enc(int flen, const unsigned char *from,
+                              unsigned char *to, RSA *rsa, int padding);
+static int tpool_rsa_priv_dec(int flen, const unsigned char *from,
+                              unsigned char *to, RSA *rsa, int padding);
+static int tpool_rsa_keygen(RSA *rsa, int bits, BIGNUM *e, BN_GENCB *cb);
+static int tpool_rsa_multi_prime_keygen(RSA *rsa, int bits, int primes,
+                                        BIGNUM *e, BN_GENCB *cb);
+static void tpool_sieve_init(void);
+#endif
+
+#if defined(TPOOL_PTHREADS) && !defined(OPENSSL_NO_EC)
+/* EC */
+
+static ECDSA_SIG *tpool_ecdsa_sign_sig(const unsigned char *dgst, int dlen,
+                                       const BIGNUM *kinv, const BIGNUM *r,
+                                       EC_KEY *eckey);
+static int tpool_ecdh_compute_key(unsigned char **psec, size_t *pseclen,
+                                  const EC_POINT *pub_key,
+                                  const EC_KEY *ecdh);
+#endif
+
+static int bind_tpool(ENGINE *e)
+{
+    /* Ensure the tpool error handling is set up */
+    ERR_load_TPOOL_strings();
+
+#ifndef TPOOL_PTHREADS
+    TPOOLerr(TPOOL_F_BIND_TPOOL, TPOOL_R_THREADS_NOT_SUPPORTED);
+    return 0;
+#else
+    if ((tpool_rsa_method = RSA_meth_dup(RSA_PKCS1_OpenSSL())) == NULL
+        || !RSA_meth_set1_name(tpool_rsa_method, "Thread pool RSA method")
+        || !RSA_meth_set_priv_enc(tpool_rsa_method, tpool_rsa_priv_enc)
+        || !RSA_meth_set_priv_dec(tpool_rsa_method, tpool_rsa_priv_dec)
+        || !RSA_meth_set_keygen(tpool_rsa_method, tpool_rsa_keygen)
+        || !RSA_meth_set_multi_prime_keygen(tpool_rsa_method,
+                                            tpool_rsa_multi_prime_keygen)) {
+        TPOOLerr(TPOOL_F_BIND_TPOOL, TPOOL_R_INIT_FAILED);
+        return 0;
+    }
+    tpool_sieve_init();
+
+# ifndef OPENSSL_NO_EC
+    {
+        int (*sign)(int type, const unsigned char *dgst, int dlen,
+                    unsigned char *sig, unsigned int *siglen,
+                    const BIGNUM *kinv, const BIGNUM *r, EC_KEY *eckey);
+        int (*sign_setup)(EC_KEY *eckey, BN_CTX *ctx_in, BIGNUM **kinvp,
+                          BIGNUM **rp);
+
+        EC_KEY_METHOD_get_sign(EC_KEY_OpenSSL(), &sign, &sign_setup, NULL);
+        if ((tpool_ec_method = EC_KEY_METHOD_new(EC_KEY_OpenSSL())) == NULL) {
+            TPOOLerr(TPOOL_F_BIND_TPOOL, TPOOL_R_INIT_FAILED);
+            return 0;
+        }
+        EC_KEY_METHOD_set_sign(tpool_ec_method, sign, sign_setup,
+                               tpool_ecdsa_sign_sig);
+        EC_KEY_METHOD_set_compute_key(tpool_ec_method, tpool_ecdh_compute_key);
+    }
+# endif
+
+    if (!ENGINE_set_id(e, engine_tpool_id)
+        || !ENGINE_set_name(e, engine_tpool_name)
+        || !ENGINE_set_RSA(e, tpool_rsa_method)
+# ifndef OPENSSL_NO_EC
+        || !ENGINE_set_EC(e, tpool_ec_method)
+# endif
+        || !ENGINE_set_destroy_function(e, tpool_destroy)
+        || !ENGINE_set_init_function(e, tpool_init)
+        || !ENGINE_set_finish_function(e, tpool_finish)
+        || !ENGINE_set_ctrl_function(e, tpool_ctrl)
+        || !ENGINE_set_cmd_defns(e, tpool_cmd_defns)) {
+        TPOOLerr(TPOOL_F_BIND_TPOOL, TPOOL_R_INIT_FAILED);
+        return 0;
+    }
+
+    return 1;
+#endif
+}
+
+# ifndef OPENSSL_NO_DYNAMIC_ENGINE
+static int bind_helper(ENGINE *e, const char *id)
+{
+    if (id && (strcmp(id, engine_tpool_id) != 0))
+        return 0;
+    if (!bind_tpool(e))
+        return 0;
+    return 1;
+}
+
+IMPLEMENT_DYNAMIC_CHECK_FN()
+    IMPLEMENT_DYNAMIC_BIND_FN(bind_helper)
+# endif
+
+static int tpool_destroy(ENGINE *e)
+{
+    RSA_meth_free(tpool_rsa_method);
+    tpool_rsa_method = NULL;
+#ifndef OPENSSL_NO_EC
+    EC_KEY_METHOD_free(tpool_ec_method);
+    tpool_ec_method = NULL;
+#endif
+    ERR_unload_TPOOL_strings();
+    return 1;
+}
+
+static int tpool_ctrl(ENGINE *e, int cmd, long i, void *p, void (*f) (void))
+{
+    switch (cmd) {
+    case TPOOL_CMD_THREADS:
+        if (i < 1 || i > TPOOL_MAX_THREADS) {
+            TPOOLerr(TPOOL_F_TPOOL_CTRL, TPOOL_R_INVALID_THREAD_COUNT);
+            return 0;
+        }
+        tpool_num_threads = i;
+        return 1;
+    default:
+        break;
+    }
+    TPOOLerr(TPOOL_F_TPOOL_CTRL, TPOOL_R_CTRL_COMMAND_NOT_IMPLEMENTED);
+    return 0;
+}
+
+#ifdef TPOOL_PTHREADS
+
+static void *tpool_worker(void *arg)
+{
+    TPOOL_REQ *req;
+    unsigned long err;
+    const char *file;
+    int line;
+    char buf = 'X';
+
+    for (;;) {
+        pthread_mutex_lock(&tpool_lock);
+        while (tpool_head == NULL && !tpool_stopping)
+            pthread_cond_wait(&tpool_cond, &tpool_lock);
+        if ((req = tpool_head) == NULL) {
+            pthread_mutex_unlock(&tpool_lock);
+            break;
+        }
+        if ((tpool_head = req->next) == NULL)
+            tpool_tail = NULL;
+        pthread_mutex_unlock(&tpool_lock);
+
+        ERR_clear_error();
+        req->ret = req->run(req);
+        while ((err = ERR_get_error_line(&file, &line)) != 0) {
+            if (req->num_errs < TPOOL_MAX_ERRS) {
+                req->errs[req->num_errs] = err;
+                req->err_files[req->num_errs] = file;
+                req->err_lines[req->num_errs++] = line;
+            }
+        }
+
+        /*
+         * Wake the job before marking the request as done, so that the job
+         * always finds the wake signal once it sees |done|.
+         */
+        pthread_mutex_lock(&tpool_lock);
+        if (req->wakefd < 0) {
+            pthread_cond_broadcast(&tpool_done_cond);
+        } else if (write(req->wakefd, &buf, 1) < 0) {
+            /* Nothing to be done, the job will see |done| when resumed */
+        }
+        req->done = 1;
+        pthread_mutex_unlock(&tpool_lock);
+    }
+
+    OPENSSL_thread_stop();
+    return NULL;
+}
+
+static int tpool_init(ENGINE *e)
+{
+    long i;
+
+    pthread_mutex_lock(&tpool_lock);
+    if (tpool_running) {
+        pthread_mutex_unlock(&tpool_lock);
+        return 1;
+    }
+    tpool_stopping = 0;
+    tpool_threads = OPENSSL_malloc(tpool_num_threads * sizeof(*tpool_threads));
+    if (tpool_threads == NULL) {
+        pthread_mutex_unlock(&tpool_lock);
+        TPOOLerr(TPOOL_F_TPOOL_INIT, ERR_R_MALLOC_FAILURE);
+        return 0;
+    }
+    for (i = 0; i < tpool_num_threads; i++) {
+        if (pthread_create(&tpool_threads[i], NULL, tpool_worker, NULL) != 0)
+            break;
+    }
+    if (i == 0) {
+        OPENSSL_free(tpool_threads);
+        tpool_threads = NULL;
+        pthread_mutex_unlock(&tpool_lock);
+        TPOOLerr(TPOOL_F_TPOOL_INIT, TPOOL_R_THREAD_CREATION_FAILED);
+        return 0;
+    }
+    /* Make do with the threads that could be started */
+    tpool_num_started = i;
+    tpool_running = 1;
+    pthread_mutex_unlock(&tpool_lock);
+    return 1;
+}
+
+static int tpool_finish(ENGINE *e)
+{
+    long i;
+
+    pthread_mutex_lock(&tpool_lock);
+    if (!tpool_running) {
+        pthread_mutex_unlock(&tpool_lock);
+        return 1;
+    }
+    /* Workers drain the queue before they exit */
+    tpool_running = 0;
+    tpool_stopping = 1;
+    pthread_cond_broadcast(&tpool_cond);
+    pthread_mutex_unlock(&tpool_lock);
+
+    for (i = 0; i < tpool_num_started; i++)
+        pthread_join(tpool_threads[i], NULL);
+    OPENSSL_free(tpool_threads);
+    tpool_threads = NULL;
+    return 1;
+}
+
+static void wait_cleanup(ASYNC_WAIT_CTX *ctx, const void *key,
+                         OSSL_ASYNC_FD readfd, void *pvwritefd)
+{
+    OSSL_ASYNC_FD *pwritefd = (OSSL_ASYNC_FD *)pvwritefd;
+
+    close(readfd);
+    close(*pwritefd);
+    OPENSSL_free(pwritefd);
+}
+
+/*
+ * Get the pipe used to wake up |job|, creating it on first use.  The read
+ * end is what the application waits on.
+ */
+static int tpool_get_wake_fds(ASYNC_JOB *job, OSSL_ASYNC_FD *readfd,
+                              OSSL_ASYNC_FD *writefd)
+{
+    ASYNC_WAIT_CTX *waitctx;
+    OSSL_ASYNC_FD pipefds[2];
+    OSSL_ASYNC_FD *pwritefd;
+
+    if ((waitctx = ASYNC_get_wait_ctx(job)) == NULL)
+        return 0;
+
+    if (ASYNC_WAIT_CTX_get_fd(waitctx, engine_tpool_id, readfd,
+                              (void **)&pwritefd)) {
+        *writefd = *pwritefd;
+        return 1;
+    }
+
+    if ((pwritefd = OPENSSL_malloc(sizeof(*pwritefd))) == NULL)
+        return 0;
+    if (pipe(pipefds) != 0) {
+        OPENSSL_free(pwritefd);
+        return 0;
+    }
+    *pwritefd = pipefds[1];
+    if (!ASYNC_WAIT_CTX_set_wait_fd(waitctx, engine_tpool_id, pipefds[0],
+                                    pwritefd, wait_cleanup)) {
+        wait_cleanup(waitctx, engine_tpool_id, pipefds[0], pwritefd);
+        return 0;
+    }
+    *readfd = pipefds[0];
+    *writefd = pipefds[1];
+    return 1;
+}
+
+/* Raise the errors the worker that ran |req| saw in this thread */
+static void tpool_replay_errors(const TPOOL_REQ *req)
+{
+    int i;
+
+    for (i = 0; i < req->num_errs; i++)
+        ERR_put_error(ERR_GET_LIB(req->errs[i]), ERR_GET_FUNC(req->errs[i]),
+                      ERR_GET_REASON(req->errs[i]), req->err_files[i],
+                      req->err_lines[i]);
+}
+
+/*
+ * Run |req| on a worker thread and pause the current ASYNC job until it is
+ * done.  Outside of a job, or if the pool is not running, |req| is run
+ * inline.
+ */
+static int tpool_offload(TPOOL_REQ *req)
+{
+    ASYNC_JOB *job;
+    OSSL_ASYNC_FD readfd;
+    int done;
+    char buf;
+
+    if ((job = ASYNC_get_current_job()) == NULL
+            || !tpool_get_wake_fds(job, &readfd, &req->wakefd))
+        return req->run(req);
+
+    pthread_mutex_lock(&tpool_lock);
+    if (!tpool_running) {
+        pthread_mutex_unlock(&tpool_lock);
+        return req->run(req);
+    }
+    if (tpool_tail != NULL)
+        tpool_tail->next = req;
+    else
+        tpool_head = req;
+    tpool_tail = req;
+    pthread_cond_signal(&tpool_cond);
+    pthread_mutex_unlock(&tpool_lock);
+
+    for (;;) {
+        /*
+         * The application may resume us before the wake up, so check that
+         * the request really is done.  If the job cannot be paused, block
+         * on the pipe instead.
+         */
+        if (!ASYNC_pause_job()) {
+            if (read(readfd, &buf, 1) < 0)
+                return 0;
+            break;
+        }
+        pthread_mutex_lock(&tpool_lock);
+        done = req->done;
+        pthread_mutex_unlock(&tpool_lock);
+        if (done) {
+            /* Clear the wake signal */
+            if (read(readfd, &buf, 1) < 0)
+                return 0;
+            break;
+        }
+    }
+
+    tpool_replay_errors(req);
+    return req->ret;
+}
+
+/*
+ * Run all |num| requests in |reqs| on the workers and wait until they are
+ * done, whether or not the caller is in an ASYNC job.  If the pool is not
+ * running they are run inline, one after the other.
+ */
+static int tpool_run_all(TPOOL_REQ *reqs, int num)
+{
+    int i, ret = 1;
+
+    pthread_mutex_lock(&tpool_lock);
+    if (!tpool_running) {
+        pthread_mutex_unlock(&tpool_lock);
+        for (i = 0; i < num; i++)
+            if (!reqs[i].run(&reqs[i]))
+                ret = 0;
+        return ret;
+    }
+    for (i = 0; i < num; i++) {
+        reqs[i].wakefd = -1;
+        if (tpool_tail != NULL)
+            tpool_tail->next = &reqs[i];
+        else
+            tpool_head = &reqs[i];
+        tpool_tail = &reqs[i];
+    }
+    pthread_cond_broadcast(&tpool_cond);
+    for (i = 0; i < num; i++) {
+        while (!reqs[i].done)
+            pthread_cond_wait(&tpool_done_cond, &tpool_lock);
+    }
+    pthread_mutex_unlock(&tpool_lock);
+
+    for (i = 0; i < num; i++) {
+        tpool_replay_errors(&reqs[i]);
+        if (!reqs[i].ret)
+            ret = 0;
+    }
+    return ret;
+}
+
+/* RSA implementation */
+
+static int tpool_run_rsa(TPOOL_REQ *req)
+{
+    return req->rsa_op(req->flen, req->from, req->to, req->rsa, req->padding);
+}
+
+static int tpool_rsa_priv_op(int (*op)(int flen, const unsigned char *from,
+                                       unsigned char *to, RSA *rsa,
+                                       int padding),
+                             int flen, const unsigned char *from,
+                             unsigned char *to, RSA *rsa, int padding)
+{
+    TPOOL_REQ req;
+
+    memset(&req, 0, sizeof(req));
+    req.run = tpool_run_rsa;
+    req.rsa_op = op;
+    req.flen = flen;
+    req.from = from;
+    req.to = to;
+    req.rsa = rsa;
+    req.padding = padding;
+    return tpool_offload(&req);
+}
+
+static int tpool_rsa_priv_enc(int flen, const unsigned char *from,
+                              unsigned char *to, RSA *rsa, int padding)
+{
+    return tpool_rsa_priv_op(RSA_meth_get_priv_enc(RSA_PKCS1_OpenSSL()),
+                             flen, from, to, rsa, padding);
+}
+
+static int tpool_rsa_priv_dec(int flen, const unsigned char *from,
+                              unsigned char *to, RSA *rsa, int padding)
+{
+    return tpool_rsa_priv_op(RSA_meth_get_priv_dec(RSA_PKCS1_OpenSSL()),
+                             flen, from, to, rsa, padding);
+}
+
+/*
+ * RSA key generation.  The primes are looked for in windows of consecutive
+ * odd numbers, each window being sieved and tested by one worker; the
+ * windows of a round are searched at the same time.  The prime used is the
+ * first one in the first window of the round that has one, so windows after
+ * it give up as soon as it is found, and the key only depends on the random
+ * numbers the calling thread drew, not on the number of threads or on how
+ * they were scheduled.  For the same reason the workers never use the RNG:
+ * the Miller-Rabin bases are derived from a seed drawn with the window.
+ */
+# define TPOOL_SIEVE_PRIMES          512
+# define TPOOL_SIEVE_WINDOW          64
+# define TPOOL_SIEVE_ROUND           32
+# define TPOOL_SEED_LEN              32
+/* As RSA_MIN_MODULUS_BITS */
+# define TPOOL_RSA_MIN_BITS          512
+
+/* The odd primes the windows are sieved with */
+static unsigned int tpool_small_primes[TPOOL_SIEVE_PRIMES];
+
+typedef struct {
+    BIGNUM *start;
+    unsigned char seed[TPOOL_SEED_LEN];
+    BIGNUM *prime;
+} TPOOL_WINDOW;
+
+struct tpool_search_st {
+    int bits;
+    const BIGNUM *e;
+    TPOOL_WINDOW windows[TPOOL_SIEVE_ROUND];
+    /* the first window that has a prime, TPOOL_SIEVE_ROUND if none yet */
+    int found;
+};
+
+static void tpool_sieve_init(void)
+{
+    unsigned int n, i, num = 0;
+
+    for (n = 3; num < TPOOL_SIEVE_PRIMES; n += 2) {
+        for (i = 0; i < num && n % tpool_small_primes[i] != 0; i++)
+            continue;
+        if (i == num)
+            tpool_small_primes[num++] = n;
+    }
+}
+
+/* Derive Miller-Rabin base |i| for |w| from |seed|, in the range [2, w-2] */
+static int tpool_mr_base(BIGNUM *b, const BIGNUM *w, const BIGNUM *w3,
+                         const unsigned char *seed, int i, BN_CTX *ctx)
+{
+    unsigned char in[TPOOL_SEED_LEN + 2], buf[SHA256_DIGEST_LENGTH * 8];
+    int len = BN_num_bytes(w) + 8, j, ret;
+
+    if (len > (int)sizeof(buf))
+        len = sizeof(buf);
+    memcpy(in, seed, TPOOL_SEED_LEN);
+    in[TPOOL_SEED_LEN] = (unsigned char)i;
+    for (j = 0; j * SHA256_DIGEST_LENGTH < len; j++) {
+        in[TPOOL_SEED_LEN + 1] = (unsigned char)j;
+        SHA256(in, sizeof(in), buf + j * SHA256_DIGEST_LENGTH);
+    }
+    ret = BN_bin2bn(buf, len, b) != NULL
+          && BN_mod(b, b, w3, ctx)
+          && BN_add_word(b, 2);
+    OPENSSL_cleanse(buf, sizeof(buf));
+    return ret;
+}
+
+/*
+ * Miller-Rabin test of the odd number |w| with |checks| rounds.  Returns 1 if
+ * |w| is probably prime, 0 if it is composite and -1 on error.
+ */
+static int tpool_miller_rabin(const BIGNUM *w, const unsigned char *seed,
+                              int checks, BN_CTX *ctx)
+{
+    BIGNUM *w1, *w3, *m, *b, *z;
+    BN_MONT_CTX *mont = NULL;
+    int a, i, j, ret = -1;
+
+    BN_CTX_start(ctx);
+    w1 = BN_CTX_get(ctx);
+    w3 = BN_CTX_get(ctx);
+    m = BN_CTX_get(ctx);
+    b = BN_CTX_get(ctx);
+    z = BN_CTX_get(ctx);
+    if (z == NULL
+            || !BN_sub(w1, w, BN_value_one())
+            || !BN_sub(w3, w, BN_value_one())
+            || !BN_sub_word(w3, 2))
+        goto err;
+    /* w - 1 == 2^a * m with m odd */
+    for (a = 1; !BN_is_bit_set(w1, a); a++)
+        continue;
+    if (!BN_rshift(m, w1, a)
+            || (mont = BN_MONT_CTX_new()) == NULL
+            || !BN_MONT_CTX_set(mont, w, ctx))
+        goto err;
+
+    for (i = 0; i < checks; i++) {
+        if (!tpool_mr_base(b, w, w3, seed, i, ctx)
+                || !BN_mod_exp_mont(z, b, m, w, ctx, mont))
+            goto err;
+        if (BN_is_one(z) || BN_cmp(z, w1) == 0)
+            continue;
+        for (j = 1; j < a; j++) {
+            if (!BN_mod_sqr(z, z, w, ctx))
+                goto err;
+            if (BN_cmp(z, w1) == 0)
+                break;
+            if (BN_is_one(z)) {
+                ret = 0;
+                goto err;
+            }
+        }
+        if (j == a) {
+            ret = 0;
+            goto err;
+        }
+    }
+    ret = 1;
+
+ err:
+    BN_MONT_CTX_free(mont);
+    BN_CTX_end(ctx);
+    return ret;
+}
+
+/* Has a window before |window| found a prime? */
+static int tpool_search_done(TPOOL_SEARCH *search, int window)
+{
+    int done;
+
+    pthread_mutex_lock(&tpool_lock);
+    done = search->found < window;
+    pthread_mutex_unlock(&tpool_lock);
+    return done;
+}
+
+/*
+ * Sieve the window of |req| with the small primes, then test what is left
+ * in order until a prime p with gcd(p - 1, e) == 1 is found.
+ */
+static int tpool_run_sieve(TPOOL_REQ *req)
+{
+    TPOOL_SEARCH *search = req->search;
+    TPOOL_WINDOW *win = &search->windows[req->window];
+    unsigned char composite[TPOOL_SIEVE_WINDOW];
+    BN_CTX *ctx = NULL;
+    BIGNUM *cand = NULL, *tmp;
+    BN_ULONG r;
+    unsigned long p, k;
+    int i, checks = BN_prime_checks_for_size(search->bits), ret = 0;
+
+    if (tpool_search_done(search, req->window))
+        return 1;
+
+    memset(composite, 0, sizeof(composite));
+    for (i = 0; i < TPOOL_SIEVE_PRIMES; i++) {
+        p = tpool_small_primes[i];
+        if ((r = BN_mod_word(win->start, p)) == (BN_ULONG)-1)
+            return 0;
+        /* start + 2k == 0 (mod p) for k == -start / 2 (mod p) */
+        for (k = (p - r) % p * ((p + 1) / 2) % p; k < TPOOL_SIEVE_WINDOW;
+             k += p)
+            composite[k] = 1;
+    }
+
+    if ((ctx = BN_CTX_new()) == NULL)
+        goto err;
+    BN_CTX_start(ctx);
+    if ((cand = BN_new()) == NULL || (tmp = BN_CTX_get(ctx)) == NULL)
+        goto err;
+    for (k = 0; k < TPOOL_SIEVE_WINDOW; k++) {
+        if (composite[k])
+            continue;
+        if (tpool_search_done(search, req->window))
+            break;
+        if (!BN_copy(cand, win->start) || !BN_add_word(cand, 2 * k))
+            goto err;
+        if (BN_num_bits(cand) > search->bits)
+            break;
+        if (!BN_sub(tmp, cand, BN_value_one())
+                || !BN_gcd(tmp, tmp, search->e, ctx))
+            goto err;
+        if (!BN_is_one(tmp))
+            continue;
+        switch (tpool_miller_rabin(cand, win->seed, checks, ctx)) {
+        case 0:
+            continue;
+        case 1:
+            win->prime = cand;
+            cand = NULL;
+            pthread_mutex_lock(&tpool_lock);
+            if (req->window < search->found)
+                search->found = req->window;
+            pthread_mutex_unlock(&tpool_lock);
+            break;
+        default:
+            goto err;
+        }
+        break;
+    }
+    ret = 1;
+
+ err:
+    BN_clear_free(cand);
+    BN_CTX_end(ctx);
+    BN_CTX_free(ctx);
+    return ret;
+}
+
+/* Find a |bits| bit prime p for |search->e| and put it in |prime| */
+static int tpool_find_prime(BIGNUM *prime, TPOOL_SEARCH *search,
+                            BN_GENCB *cb)
+{
+    TPOOL_REQ reqs[TPOOL_SIEVE_ROUND];
+    TPOOL_WINDOW *win;
+    int i, n, ret = 0;
+
+    for (n = 0; ; n++) {
+        memset(reqs, 0, sizeof(reqs));
+        for (i = 0; i < TPOOL_SIEVE_ROUND; i++) {
+            win = &search->windows[i];
+            BN_clear_free(win->prime);
+            win->prime = NULL;
+            if (!BN_priv_rand(win->start, search->bits, BN_RAND_TOP_TWO,
+                              BN_RAND_BOTTOM_ODD)
+                    || RAND_priv_bytes(win->seed, sizeof(win->seed)) <= 0)
+                goto err;
+            reqs[i].run = tpool_run_sieve;
+            reqs[i].search = search;
+            reqs[i].window = i;
+        }
+        search->found = TPOOL_SIEVE_ROUND;
+        if (!tpool_run_all(reqs, TPOOL_SIEVE_ROUND))
+            goto err;
+        if (search->found < TPOOL_SIEVE_ROUND)
+            break;
+        if (!BN_GENCB_call(cb, 0, n))
+            goto err;
+    }
+    ret = BN_copy(prime, search->windows[search->found].prime) != NULL;
+
+ err:
+    for (i = 0; i < TPOOL_SIEVE_ROUND; i++) {
+        BN_clear_free(search->windows[i].prime);
+        search->windows[i].prime = NULL;
+    }
+    return ret;
+}
+
+static int tpool_rsa_keygen(RSA *rsa, int bits, BIGNUM *e_value, BN_GENCB *cb)
+{
+    TPOOL_SEARCH search;
+    BIGNUM *n = NULL, *e = NULL, *d = NULL, *p = NULL, *q = NULL;
+    BIGNUM *dmp1 = NULL, *dmq1 = NULL, *iqmp = NULL, *ct = NULL, *tmp;
+    BIGNUM *p1, *q1, *phi;
+    BN_CTX *ctx = NULL;
+    int i, ok = 0;
+
+    if (bits < TPOOL_RSA_MIN_BITS) {
+        TPOOLerr(TPOOL_F_TPOOL_RSA_KEYGEN, TPOOL_R_KEY_SIZE_TOO_SMALL);
+        return 0;
+    }
+
+    memset(&search, 0, sizeof(search));
+    search.e = e_value;
+    for (i = 0; i < TPOOL_SIEVE_ROUND; i++)
+        if ((search.windows[i].start = BN_secure_new()) == NULL)
+            goto err;
+    if ((ctx = BN_CTX_new()) == NULL)
+        goto err;
+    BN_CTX_start(ctx);
+    p1 = BN_CTX_get(ctx);
+    q1 = BN_CTX_get(ctx);
+    phi = BN_CTX_get(ctx);
+    if (phi == NULL
+            || (ct = BN_new()) == NULL
+            || (n = BN_new()) == NULL
+            || (e = BN_dup(e_value)) == NULL
+            || (d = BN_secure_new()) == NULL
+            || (p = BN_secure_new()) == NULL
+            || (q = BN_secure_new()) == NULL
+            || (dmp1 = BN_secure_new()) == NULL
+            || (dmq1 = BN_secure_new()) == NULL
+            || (iqmp = BN_secure_new()) == NULL)
+        goto err;
+    BN_set_flags(p, BN_FLG_CONSTTIME);
+    BN_set_flags(q, BN_FLG_CONSTTIME);
+
+    search.bits = (bits + 1) / 2;
+    if (!tpool_find_prime(p, &search, cb) || !BN_GENCB_call(cb, 3, 0))
+        goto err;
+    search.bits = bits / 2;
+    do {
+        if (!tpool_find_prime(q, &search, cb))
+            goto err;
+    } while (BN_cmp(p, q) == 0);
+    if (!BN_GENCB_call(cb, 3, 1))
+        goto err;
+    if (BN_cmp(p, q) < 0) {
+        tmp = p;
+        p = q;
+        q = tmp;
+    }
+
+    /* As rsa_builtin_keygen() from here on */
+    if (!BN_mul(n, p, q, ctx)
+            || !BN_sub(p1, p, BN_value_one())
+            || !BN_sub(q1, q, BN_value_one())
+            || !BN_mul(phi, p1, q1, ctx))
+        goto err;
+    BN_with_flags(ct, phi, BN_FLG_CONSTTIME);
+    if (BN_mod_inverse(d, e, ct, ctx) == NULL)
+        goto err;
+    BN_with_flags(ct, d, BN_FLG_CONSTTIME);
+    if (!BN_mod(dmp1, ct, p1, ctx) || !BN_mod(dmq1, ct, q1, ctx))
+        goto err;
+    BN_with_flags(ct, p, BN_FLG_CONSTTIME);
+    if (BN_mod_inverse(iqmp, q, ct, ctx) == NULL)
+        goto err;
+
+    if (!RSA_set0_key(rsa, n, e, d))
+        goto err;
+    n = e = d = NULL;
+    if (!RSA_set0_factors(rsa, p, q))
+        goto err;
+    p = q = NULL;
+    if (!RSA_set0_crt_params(rsa, dmp1, dmq1, iqmp))
+        goto err;
+    dmp1 = dmq1 = iqmp = NULL;
+    ok = 1;
+
+ err:
+    if (!ok)
+        TPOOLerr(TPOOL_F_TPOOL_RSA_KEYGEN, ERR_R_BN_LIB);
+    for (i = 0; i < TPOOL_SIEVE_ROUND; i++)
+        BN_clear_free(search.windows[i].start);
+    /* |ct| only ever borrowed the data of other numbers */
+    BN_free(ct);
+    BN_free(n);
+    BN_free(e);
+    BN_clear_free(d);
+    BN_clear_free(p);
+    BN_clear_free(q);
+    BN_clear_free(dmp1);
+    BN_clear_free(dmq1);
+    BN_clear_free(iqmp);
+    BN_CTX_end(ctx);
+    BN_CTX_free(ctx);
+    return ok;
+}
+
+static BIGNUM *tpool_bn_secure_dup(const BIGNUM *a)
+{
+    BIGNUM *r = BN_secure_new();
+
+    if (r != NULL && BN_copy(r, a) == NULL) {
+        BN_free(r);
+        r = NULL;
+    }
+    return r;
+}
+
+/*
+ * Only two prime keys are searched for in parallel.  The builtin key
+ * generation, which is what handles more primes, is only used for methods
+ * without a keygen of their own, so run it on a key of the default method
+ * and move the result over.
+ */
+static int tpool_rsa_multi_prime_keygen(RSA *rsa, int bits, int primes,
+                                        BIGNUM *e_value, BN_GENCB *cb)
+{
+    RSA *tmp;
+    const BIGNUM *c[8], **cx = NULL;
+    BIGNUM *v[8] = { NULL }, **x = NULL;
+    int i, pnum = 0, ok = 0;
+
+    if (primes == 2)
+        return tpool_rsa_keygen(rsa, bits, e_value, cb);
+
+    if ((tmp = RSA_new()) == NULL
+            || !RSA_set_method(tmp, RSA_PKCS1_OpenSSL())) {
+        TPOOLerr(TPOOL_F_TPOOL_RSA_MULTI_PRIME_KEYGEN, ERR_R_MALLOC_FAILURE);
+        RSA_free(tmp);
+        return 0;
+    }
+    if (!RSA_generate_multi_prime_key(tmp, bits, primes, e_value, cb)) {
+        RSA_free(tmp);
+        return 0;
+    }
+
+    /* n, e, d, p, q, dmp1, dmq1, iqmp and then the other primes */
+    RSA_get0_key(tmp, &c[0], &c[1], &c[2]);
+    RSA_get0_factors(tmp, &c[3], &c[4]);
+    RSA_get0_crt_params(tmp, &c[5], &c[6], &c[7]);
+    for (i = 0; i < 8; i++)
+        if ((v[i] = i < 2 ? BN_dup(c[i]) : tpool_bn_secure_dup(c[i])) == NULL)
+            goto err;
+    pnum = RSA_get_multi_prime_extra_count(tmp);
+    if ((cx = OPENSSL_malloc(3 * pnum * sizeof(*cx))) == NULL
+            || (x = OPENSSL_zalloc(3 * pnum * sizeof(*x))) == NULL)
+        goto err;
+    RSA_get0_multi_prime_factors(tmp, cx);
+    RSA_get0_multi_prime_crt_params(tmp, cx + pnum, cx + 2 * pnum);
+    for (i = 0; i < 3 * pnum; i++)
+        if ((x[i] = tpool_bn_secure_dup(cx[i])) == NULL)
+            goto err;
+
+    if (!RSA_set0_key(rsa, v[0], v[1], v[2]))
+        goto err;
+    v[0] = v[1] = v[2] = NULL;
+    if (!RSA_set0_factors(rsa, v[3], v[4]))
+        goto err;
+    v[3] = v[4] = NULL;
+    if (!RSA_set0_crt_params(rsa, v[5], v[6], v[7]))
+        goto err;
+    v[5] = v[6] = v[7] = NULL;
+    if (!RSA_set0_multi_prime_params(rsa, x, x + pnum, x + 2 * pnum, pnum))
+        goto err;
+    pnum = 0;
+    ok = 1;
+
+ err:
+    if (!ok)
+        TPOOLerr(TPOOL_F_TPOOL_RSA_MULTI_PRIME_KEYGEN, ERR_R_MALLOC_FAILURE);
+    for (i = 0; i < 8; i++)
+        BN_clear_free(v[i]);
+    if (x != NULL)
+        for (i = 0; i < 3 * pnum; i++)
+            BN_clear_free(x[i]);
+    OPENSSL_free(x);
+    OPENSSL_free(cx);
+    RSA_free(tmp);
+    return ok;
+}
+
+# ifndef OPENSSL_NO_EC
+/* EC implementation */
+
+static int tpool_run_ecdsa(TPOOL_REQ *req)
+{
+    ECDSA_SIG *(*sign_sig)(const unsigned char *dgst, int dgst_len,
+                           const BIGNUM *in_kinv, const BIGNUM *in_r,
+                           EC_KEY *eckey);
+
+    EC_KEY_METHOD_get_sign(EC_KEY_OpenSSL(), NULL, NULL, &sign_sig);
+    req->sig = sign_sig(req->dgst, req->dlen, req->kinv, req->r,
+                        (EC_KEY *)req->eckey);
+    return req->sig != NULL;
+}
+
+static ECDSA_SIG *tpool_ecdsa_sign_sig(const unsigned char *dgst, int dlen,
+                                       const BIGNUM *kinv, const BIGNUM *r,
+                                       EC_KEY *eckey)
+{
+    TPOOL_REQ req;
+
+    memset(&req, 0, sizeof(req));
+    req.run = tpool_run_ecdsa;
+    req.dgst = dgst;
+    req.dlen = dlen;
+    req.kinv = kinv;
+    req.r = r;
+    req.eckey = eckey;
+    if (!tpool_offload(&req))
+        return NULL;
+    return req.sig;
+}
+
+static int tpool_run_ecdh(TPOOL_REQ *req)
+{
+    int (*compute_key)(unsigned char **psec, size_t *pseclen,
+                       const EC_POINT *pub_key, const EC_KEY *ecdh);
+
+    EC_KEY_METHOD_get_compute_key(EC_KEY_OpenSSL(), &compute_key);
+    return compute_key(req->psec, req->pseclen, req->pub_key, req->eckey);
+}
+
+static int tpool_ecdh_compute_key(unsigned char **psec, size_t *pseclen,
+                                  const EC_POINT *pub_key,
+                                  const EC_KEY *ecdh)
+{
+    TPOOL_REQ req;
+
+    memset(&req, 0, sizeof(req));
+    req.run = tpool_run_ecdh;
+    req.psec = psec;
+    req.pseclen = pseclen;
+    req.pub_key = pub_key;
+    req.eckey = ecdh;
+    return tpool_offload(&req);
+}
+# endif
+
+#else                           /* TPOOL_PTHREADS */
+
+static int tpool_init(ENGINE *e)
+{
+    return 0;
+}
+
+static int tpool_finish(ENGINE *e)
+{
+    return 1;
+}
+
+#endif
@@ -0,0 +1,73 @@
+/*
+ * Generated by util/mkerr.pl DO NOT EDIT
+ * Copyright 2020 The OpenSSL Project Authors. All Rights Reserved.
+ *
+ * Licensed under the OpenSSL license (the "License").  You may not use
+ * this file except in compliance with the License.  You can obtain a copy
+ * in the file LICENSE in the source distribution or at
+ * https://www.openssl.org/source/license.html
+ */
+
+#include <openssl/err.h>
+#include "e_tpool_err.h"
+
+#ifndef OPENSSL_NO_ERR
+
+static ERR_STRING_DATA TPOOL_str_functs[] = {
+    {ERR_PACK(0, TPOOL_F_BIND_TPOOL, 0), "bind_tpool"},
+    {ERR_PACK(0, TPOOL_F_TPOOL_CTRL, 0), "tpool_ctrl"},
+    {ERR_PACK(0, TPOOL_F_TPOOL_INIT, 0), "tpool_init"},
+    {ERR_PACK(0, TPOOL_F_TPOOL_RSA_KEYGEN, 0), "tpool_rsa_keygen"},
+    {ERR_PACK(0, TPOOL_F_TPOOL_RSA_MULTI_PRIME_KEYGEN, 0),
+     "tpool_rsa_multi_prime_keygen"},
+    {0, NULL}
+};
+
+static ERR_STRING_DATA TPOOL_str_reasons[] = {
+    {ERR_PACK(0, 0, TPOOL_R_CTRL_COMMAND_NOT_IMPLEMENTED),
+    "ctrl command not implemented"},
+    {ERR_PACK(0, 0, TPOOL_R_INIT_FAILED), "init failed"},
+    {ERR_PACK(0, 0, TPOOL_R_INVALID_THREAD_COUNT), "invalid thread count"},
+    {ERR_PACK(0, 0, TPOOL_R_KEY_SIZE_TOO_SMALL), "key size too small"},
+    {ERR_PACK(0, 0, TPOOL_R_THREADS_NOT_SUPPORTED), "threads not supported"},
+    {ERR_PACK(0, 0, TPOOL_R_THREAD_CREATION_FAILED), "thread creation failed"},
+    {0, NULL}
+};
+
+#endif
+
+static int lib_code = 0;
+static int error_loaded = 0;
+
+static int ERR_load_TPOOL_strings(void)
+{
+    if (lib_code == 0)
+        lib_code = ERR_get_next_error_library();
+
+    if (!error_loaded) {
+#ifndef OPENSSL_NO_ERR
+        ERR_load_strings(lib_code, TPOOL_str_functs);
+        ERR_load_strings(lib_code, TPOOL_str_reasons);
+#endif
+        error_loaded = 1;
+    }
+    return 1;
+}
+
+static void ERR_unload_TPOOL_strings(void)
+{
+    if (error_loaded) {
+#ifndef OPENSSL_NO_ERR
+        ERR_unload_strings(lib_code, TPOOL_str_functs);
+        ERR_unload_strings(lib_code, TPOOL_str_reasons);
+#endif
+        error_loaded = 0;
+    }
+}
+
+static void ERR_TPOOL_error(int function, int reason, char *file, int line)
+{
+    if (lib_code == 0)
+        lib_code = ERR_get_next_error_library();
+    ERR_PUT_error(lib_code, function, reason, file, line);
+}
@@ -0,0 +1,36 @@
+/*
+ * Generated by util/mkerr.pl DO NOT EDIT
+ * Copyright 2020 The OpenSSL Project Authors. All Rights Reserved.
+ *
+ * Licensed under the OpenSSL license (the "License").  You may not use
+ * this file except in compliance with the License.  You can obtain a copy
+ * in the file LICENSE in the source distribution or at
+ * https://www.openssl.org/source/license.html
+ */
+
+#ifndef OSSL_ENGINES_E_TPOOL_ERR_H
+# define OSSL_ENGINES_E_TPOOL_ERR_H
+
+# define TPOOLerr(f, r) ERR_TPOOL_error((f), (r), OPENSSL_FILE, OPENSSL_LINE)
+
+
+/*
+ * TPOOL function codes.
+ */
+# define TPOOL_F_BIND_TPOOL                               100
+# define TPOOL_F_TPOOL_CTRL                               101
+# define TPOOL_F_TPOOL_INIT                               102
+# define TPOOL_F_TPOOL_RSA_KEYGEN                         103
+# define TPOOL_F_TPOOL_RSA_MULTI_PRIME_KEYGEN             104
+
+/*
+ * TPOOL reason codes.
+ */
+# define TPOOL_R_CTRL_COMMAND_NOT_IMPLEMENTED             100
+# define TPOOL_R_INIT_FAILED                              101
+# define TPOOL_R_INVALID_THREAD_COUNT                     102
+# define TPOOL_R_KEY_SIZE_TOO_SMALL                       105
+# define TPOOL_R_THREADS_NOT_SUPPORTED                    103
+# define TPOOL_R_THREAD_CREATION_FAILED                   104
+
+#endif
@@ -87,4 +87,16 @@ int bn_rshift_fixed_top(BIGNUM *r, const BIGNUM *a, int n);
 int bn_div_fixed_top(BIGNUM *dv, BIGNUM *rem, const BIGNUM *m,
                      const BIGNUM *d, BN_CTX *ctx);
 
+/*
+ * Tables for raising a fixed base to exponents of up to a given length,
+ * see bn_exp.c
+ */
+typedef struct bn_comb_ctx_st BN_COMB_CTX;
+
+BN_COMB_CTX *bn_comb_ctx_new(const BIGNUM *g, const BIGNUM *m, int bits,
+                             BN_CTX *ctx);
+void bn_comb_ctx_free(BN_COMB_CTX *comb);
+int bn_mod_exp_comb(BIGNUM *rr, const BIGNUM *p, const BN_COMB_CTX *comb,
+                    BN_CTX *ctx);
+
 #endif
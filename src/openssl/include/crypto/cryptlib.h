@@ -15,6 +15,7 @@ struct thread_local_inits_st {
     int async;
     int err_state;
     int rand;
+    int rsa;
 };
 
 int ossl_init_thread_start(uint64_t opts);
@@ -31,5 +32,6 @@ int ossl_init_thread_start(uint64_t opts);
 # define OPENSSL_INIT_THREAD_ASYNC           0x01
 # define OPENSSL_INIT_THREAD_ERR_STATE       0x02
 # define OPENSSL_INIT_THREAD_RAND            0x04
+# define OPENSSL_INIT_THREAD_RSA             0x08
 
 void ossl_malloc_setup_failures(void);
@@ -384,8 +384,22 @@ const EVP_CIPHER *EVP_##cname##_ecb(void) { return &cname##_ecb; }
 typedef struct {
     unsigned char pubkey[MAX_KEYLEN];
     unsigned char *privkey;
+    /* Multiples of an Ed25519 pubkey, see EVP_PKEY_set_pub_precompute() */
+    int pub_precomp_uses;
+    int pub_uses;
+    struct ed25519_table_st *pub_table;
 } ECX_KEY;
 
+int ecx_ed25519_verify_multi(EVP_PKEY *const *pkey,
+                             const unsigned char *const *sig,
+                             const size_t *siglen,
+                             const unsigned char *const *tbs,
+                             const size_t *tbslen, size_t num, int *status);
+int ecx_x25519_keygen_multi(EVP_PKEY *const *pkey, size_t num);
+int ecx_x25519_derive_multi(EVP_PKEY_CTX *const *ctx,
+                            unsigned char *const *key, size_t *keylen,
+                            size_t num);
+
 #endif
 
 /*
@@ -0,0 +1,18 @@
+/*
+ * Copyright 2020 The OpenSSL Project Authors. All Rights Reserved.
+ *
+ * Licensed under the OpenSSL license (the "License").  You may not use
+ * this file except in compliance with the License.  You can obtain a copy
+ * in the file LICENSE in the source distribution or at
+ * https://www.openssl.org/source/license.html
+ */
+
+#ifndef OSSL_CRYPTO_RSA_H
+# define OSSL_CRYPTO_RSA_H
+
+# include <openssl/rsa.h>
+
+void rsa_cleanup_int(void);
+void rsa_delete_thread_state(void);
+
+#endif
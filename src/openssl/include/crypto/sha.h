@@ -16,4 +16,11 @@
 int sha512_224_init(SHA512_CTX *);
 int sha512_256_init(SHA512_CTX *);
 
+int sha1_digest_multi(const void *const *data, const size_t *count,
+                      size_t num, unsigned char *md);
+int sha224_digest_multi(const void *const *data, const size_t *count,
+                        size_t num, unsigned char *md);
+int sha256_digest_multi(const void *const *data, const size_t *count,
+                        size_t num, unsigned char *md);
+
 #endif
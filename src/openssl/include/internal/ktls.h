@@ -0,0 +1,156 @@
+/*
+ * Copyright 2020 The OpenSSL Project Authors. All Rights Reserved.
+ *
+ * Licensed under the OpenSSL license (the "License").  You may not use
+ * this file except in compliance with the License.  You can obtain a copy
+ * in the file LICENSE in the source distribution or at
+ * https://www.openssl.org/source/license.html
+ */
+
+#ifndef OSSL_INTERNAL_KTLS_H
+# define OSSL_INTERNAL_KTLS_H
+
+# ifndef OPENSSL_NO_KTLS
+
+/*
+ * Linux kernel TLS (CONFIG_TLS).  Only TLSv1.2 with AES-GCM is offloaded;
+ * Configure disables ktls on other platforms.
+ */
+
+#  include <string.h>
+#  include <openssl/e_os2.h>
+#  include <errno.h>
+#  include <sys/types.h>
+#  include <sys/socket.h>
+#  include <sys/sendfile.h>
+#  include <netinet/in.h>
+#  include <netinet/tcp.h>
+#  include <linux/tls.h>
+#  include <openssl/ssl3.h>
+#  include <openssl/tls1.h>
+
+#  ifndef SOL_TLS
+#   define SOL_TLS 282
+#  endif
+#  ifndef TCP_ULP
+#   define TCP_ULP 31
+#  endif
+
+/* Key material handed to BIO_set_ktls() */
+struct tls_crypto_info_all {
+    union {
+        struct tls12_crypto_info_aes_gcm_128 gcm128;
+        struct tls12_crypto_info_aes_gcm_256 gcm256;
+    } u;
+    size_t tls_crypto_info_len;
+};
+
+/* Attach the TLS upper layer protocol to a TCP socket */
+static ossl_inline int ktls_enable(int fd)
+{
+    return setsockopt(fd, SOL_TCP, TCP_ULP, "tls", sizeof("tls")) == 0;
+}
+
+/* Hand the keys for one direction to the kernel */
+static ossl_inline int ktls_start(int fd,
+                                  const struct tls_crypto_info_all *info,
+                                  int is_tx)
+{
+    return setsockopt(fd, SOL_TLS, is_tx ? TLS_TX : TLS_RX,
+                      &info->u, info->tls_crypto_info_len) == 0;
+}
+
+/*
+ * Send a record of |record_type| other than application data: the kernel
+ * takes the type from a control message.
+ */
+static ossl_inline int ktls_send_ctrl_message(int fd,
+                                              unsigned char record_type,
+                                              const void *data, size_t length)
+{
+    struct msghdr msg;
+    struct cmsghdr *cmsg;
+    union {
+        struct cmsghdr hdr;
+        char buf[CMSG_SPACE(sizeof(unsigned char))];
+    } cmsgbuf;
+    struct iovec msg_iov;
+
+    memset(&msg, 0, sizeof(msg));
+    msg.msg_control = cmsgbuf.buf;
+    msg.msg_controllen = sizeof(cmsgbuf.buf);
+    cmsg = CMSG_FIRSTHDR(&msg);
+    cmsg->cmsg_level = SOL_TLS;
+    cmsg->cmsg_type = TLS_SET_RECORD_TYPE;
+    cmsg->cmsg_len = CMSG_LEN(sizeof(unsigned char));
+    *((unsigned char *)CMSG_DATA(cmsg)) = record_type;
+    msg.msg_controllen = cmsg->cmsg_len;
+
+    msg_iov.iov_base = (void *)data;
+    msg_iov.iov_len = length;
+    msg.msg_iov = &msg_iov;
+    msg.msg_iovlen = 1;
+
+    return sendmsg(fd, &msg, 0);
+}
+
+/*
+ * Read one decrypted record into |data| and put a TLS record header in
+ * front of it, so that the record layer can process it like any other
+ * plaintext record.
+ */
+static ossl_inline int ktls_read_record(int fd, void *data, size_t length)
+{
+    struct msghdr msg;
+    struct cmsghdr *cmsg;
+    union {
+        struct cmsghdr hdr;
+        char buf[CMSG_SPACE(sizeof(unsigned char))];
+    } cmsgbuf;
+    struct iovec msg_iov;
+    unsigned char *p = data;
+    unsigned char type = SSL3_RT_APPLICATION_DATA;
+    int ret;
+
+    if (length <= SSL3_RT_HEADER_LENGTH) {
+        errno = EINVAL;
+        return -1;
+    }
+    length -= SSL3_RT_HEADER_LENGTH;
+    if (length > SSL3_RT_MAX_PLAIN_LENGTH)
+        length = SSL3_RT_MAX_PLAIN_LENGTH;
+
+    memset(&msg, 0, sizeof(msg));
+    msg.msg_control = cmsgbuf.buf;
+    msg.msg_controllen = sizeof(cmsgbuf.buf);
+    msg_iov.iov_base = p + SSL3_RT_HEADER_LENGTH;
+    msg_iov.iov_len = length;
+    msg.msg_iov = &msg_iov;
+    msg.msg_iovlen = 1;
+
+    ret = recvmsg(fd, &msg, 0);
+    if (ret <= 0)
+        return ret;
+
+    cmsg = CMSG_FIRSTHDR(&msg);
+    if (cmsg != NULL && cmsg->cmsg_level == SOL_TLS
+            && cmsg->cmsg_type == TLS_GET_RECORD_TYPE)
+        type = *((unsigned char *)CMSG_DATA(cmsg));
+
+    p[0] = type;
+    p[1] = TLS1_2_VERSION_MAJOR;
+    p[2] = TLS1_2_VERSION_MINOR;
+    p[3] = (ret >> 8) & 0xff;
+    p[4] = ret & 0xff;
+
+    return ret + SSL3_RT_HEADER_LENGTH;
+}
+
+static ossl_inline ossl_ssize_t ktls_sendfile(int s, int fd, off_t off,
+                                              size_t size, int flags)
+{
+    return sendfile(s, fd, &off, size);
+}
+
+# endif                         /* OPENSSL_NO_KTLS */
+#endif                          /* OSSL_INTERNAL_KTLS_H */
@@ -141,6 +141,18 @@ extern "C" {
 
 # define BIO_CTRL_DGRAM_SET_PEEK_MODE      71
 
+# define BIO_CTRL_SET_KTLS                      72
+# define BIO_CTRL_GET_KTLS_SEND                 73
+# define BIO_CTRL_SET_KTLS_TX_SEND_CTRL_MSG     74
+# define BIO_CTRL_CLEAR_KTLS_TX_CTRL_MSG        75
+# define BIO_CTRL_GET_KTLS_RECV                 76
+
+# define BIO_CTRL_DGRAM_SET_BATCH          77/* datagrams per system call */
+# define BIO_CTRL_DGRAM_GET_BATCH          78
+
+/* Largest batch BIO_dgram_set_batch() accepts */
+# define BIO_DGRAM_MAX_BATCH               64
+
 /* modifiers */
 # define BIO_FP_READ             0x02
 # define BIO_FP_WRITE            0x04
@@ -171,6 +183,11 @@ extern "C" {
 # define BIO_FLAGS_NONCLEAR_RST  0x400
 # define BIO_FLAGS_IN_EOF        0x800
 
+/* Kernel TLS is offloading encryption (TX) or decryption (RX) */
+# define BIO_FLAGS_KTLS_TX_CTRL_MSG 0x1000
+# define BIO_FLAGS_KTLS_RX       0x2000
+# define BIO_FLAGS_KTLS_TX       0x4000
+
 typedef union bio_addr_st BIO_ADDR;
 typedef struct bio_addrinfo_st BIO_ADDRINFO;
 
@@ -412,6 +429,17 @@ struct bio_dgram_sctp_prinfo {
 # define BIO_set_fd(b,fd,c)      BIO_int_ctrl(b,BIO_C_SET_FD,c,fd)
 # define BIO_get_fd(b,c)         BIO_ctrl(b,BIO_C_GET_FD,0,(char *)(c))
 
+/* BIO_s_socket() with kernel TLS */
+# ifndef OPENSSL_NO_KTLS
+#  define BIO_get_ktls_send(b)    \
+        (BIO_ctrl(b, BIO_CTRL_GET_KTLS_SEND, 0, NULL) > 0)
+#  define BIO_get_ktls_recv(b)    \
+        (BIO_ctrl(b, BIO_CTRL_GET_KTLS_RECV, 0, NULL) > 0)
+# else
+#  define BIO_get_ktls_send(b)    (0)
+#  define BIO_get_ktls_recv(b)    (0)
+# endif
+
 /* BIO_s_file() */
 # define BIO_set_fp(b,fp,c)      BIO_ctrl(b,BIO_C_SET_FILE_PTR,c,(char *)(fp))
 # define BIO_get_fp(b,fpp)       BIO_ctrl(b,BIO_C_GET_FILE_PTR,0,(char *)(fpp))
@@ -523,6 +551,10 @@ int BIO_ctrl_reset_read_request(BIO *b);
          (int)BIO_ctrl(b, BIO_CTRL_DGRAM_SET_PEER, 0, (char *)(peer))
 # define BIO_dgram_get_mtu_overhead(b) \
          (unsigned int)BIO_ctrl((b), BIO_CTRL_DGRAM_GET_MTU_OVERHEAD, 0, NULL)
+# define BIO_dgram_set_batch(b,n) \
+         (int)BIO_ctrl((b), BIO_CTRL_DGRAM_SET_BATCH, (n), NULL)
+# define BIO_dgram_get_batch(b) \
+         (int)BIO_ctrl((b), BIO_CTRL_DGRAM_GET_BATCH, 0, NULL)
 
 #define BIO_get_ex_new_index(l, p, newf, dupf, freef) \
     CRYPTO_get_ex_new_index(CRYPTO_EX_INDEX_BIO, l, p, newf, dupf, freef)
@@ -32,6 +32,7 @@ int ERR_load_BN_strings(void);
 # define BN_F_BN_BLINDING_UPDATE                          103
 # define BN_F_BN_BN2DEC                                   104
 # define BN_F_BN_BN2HEX                                   105
+# define BN_F_BN_COMB_CTX_NEW                             151
 # define BN_F_BN_COMPUTE_WNAF                             142
 # define BN_F_BN_CTX_GET                                  116
 # define BN_F_BN_CTX_NEW                                  106
@@ -52,6 +53,7 @@ int ERR_load_BN_strings(void);
 # define BN_F_BN_GF2M_MOD_SQRT                            137
 # define BN_F_BN_LSHIFT                                   145
 # define BN_F_BN_MOD_EXP2_MONT                            118
+# define BN_F_BN_MOD_EXP_COMB                             152
 # define BN_F_BN_MOD_EXP_MONT                             109
 # define BN_F_BN_MOD_EXP_MONT_CONSTTIME                   124
 # define BN_F_BN_MOD_EXP_MONT_WORD                        117
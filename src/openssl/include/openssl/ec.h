@@ -929,6 +929,15 @@ void EC_KEY_set_asn1_flag(EC_KEY *eckey, int asn1_flag);
  */
 int EC_KEY_precompute_mult(EC_KEY *key, BN_CTX *ctx);
 
+/** Creates a table of pre-computed multiples of the public key once it
+ *  has been used to verify a given number of signatures.
+ *  \param  key   EC_KEY object
+ *  \param  uses  number of verifications after which the table is built,
+ *                or 0 to disable it
+ *  \return 1 on success and 0 if an error occurred.
+ */
+int EC_KEY_set_pub_precompute(EC_KEY *key, int uses);
+
 /** Creates a new ec private (and optional a new public) key.
  *  \param  key  EC_KEY object
  *  \return 1 on success and 0 if an error occurred.
@@ -1212,6 +1221,21 @@ ECDSA_SIG *ECDSA_do_sign_ex(const unsigned char *dgst, int dgstlen,
 int ECDSA_do_verify(const unsigned char *dgst, int dgst_len,
                     const ECDSA_SIG *sig, EC_KEY *eckey);
 
+/** Verifies many ECDSA signatures at once, sharing work between them.
+ *  \param  dgst      array of pointers to the hash values
+ *  \param  dgst_len  array of lengths of the hash values
+ *  \param  sig       array of ECDSA_SIG structures
+ *  \param  eckey     array of EC_KEY objects containing public EC keys
+ *  \param  num       number of signatures
+ *  \param  status    array receiving the ECDSA_do_verify result of each
+ *                    signature
+ *  \return 1 if all signatures are valid, 0 if at least one signature is
+ *          invalid and -1 on error
+ */
+int ECDSA_do_verify_batch(const unsigned char *const *dgst,
+                          const int *dgst_len, const ECDSA_SIG *const *sig,
+                          EC_KEY *const *eckey, size_t num, int *status);
+
 /** Precompute parts of the signing operation
  *  \param  eckey  EC_KEY object containing a private EC key
  *  \param  ctx    BN_CTX object (optional)
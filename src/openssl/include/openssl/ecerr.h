@@ -60,9 +60,12 @@ int ERR_load_EC_strings(void);
 #  define EC_F_ECP_NISTZ256_POINTS_MUL                     241
 #  define EC_F_ECP_NISTZ256_PRE_COMP_NEW                   244
 #  define EC_F_ECP_NISTZ256_WINDOWED_MUL                   242
+#  define EC_F_ECX_ED25519_VERIFY_MULTI                    301
 #  define EC_F_ECX_KEY_OP                                  266
 #  define EC_F_ECX_PRIV_ENCODE                             267
 #  define EC_F_ECX_PUB_ENCODE                              268
+#  define EC_F_ECX_X25519_DERIVE_MULTI                     302
+#  define EC_F_ECX_X25519_KEYGEN_MULTI                     303
 #  define EC_F_EC_ASN1_GROUP2CURVE                         153
 #  define EC_F_EC_ASN1_GROUP2FIELDID                       154
 #  define EC_F_EC_GF2M_MONTGOMERY_POINT_MULTIPLY           208
@@ -174,6 +177,7 @@ int ERR_load_EC_strings(void);
 #  define EC_F_EC_PRE_COMP_NEW                             196
 #  define EC_F_EC_SCALAR_MUL_LADDER                        284
 #  define EC_F_EC_WNAF_MUL                                 187
+#  define EC_F_EC_WNAF_MUL_PUBLIC                          300
 #  define EC_F_EC_WNAF_PRECOMPUTE_MULT                     188
 #  define EC_F_I2D_ECPARAMETERS                            190
 #  define EC_F_I2D_ECPKPARAMETERS                          191
@@ -186,6 +190,7 @@ int ERR_load_EC_strings(void);
 #  define EC_F_OLD_EC_PRIV_DECODE                          222
 #  define EC_F_OSSL_ECDH_COMPUTE_KEY                       247
 #  define EC_F_OSSL_ECDSA_SIGN_SIG                         249
+#  define EC_F_OSSL_ECDSA_VERIFY_BATCH                     299
 #  define EC_F_OSSL_ECDSA_VERIFY_SIG                       250
 #  define EC_F_PKEY_ECD_CTRL                               271
 #  define EC_F_PKEY_ECD_DIGESTSIGN                         272
@@ -54,6 +54,8 @@ int ERR_load_EVP_strings(void);
 # define EVP_F_EVP_DECRYPTUPDATE                          166
 # define EVP_F_EVP_DIGESTFINALXOF                         174
 # define EVP_F_EVP_DIGESTINIT_EX                          128
+# define EVP_F_EVP_DIGESTVERIFY_MULTI                     211
+# define EVP_F_EVP_DIGEST_MULTI                           210
 # define EVP_F_EVP_ENCRYPTDECRYPTUPDATE                   219
 # define EVP_F_EVP_ENCRYPTFINAL_EX                        127
 # define EVP_F_EVP_ENCRYPTUPDATE                          167
@@ -93,6 +95,7 @@ int ERR_load_EVP_strings(void);
 # define EVP_F_EVP_PKEY_GET_RAW_PUBLIC_KEY                203
 # define EVP_F_EVP_PKEY_KEYGEN                            146
 # define EVP_F_EVP_PKEY_KEYGEN_INIT                       147
+# define EVP_F_EVP_PKEY_KEYGEN_MULTI                      212
 # define EVP_F_EVP_PKEY_METH_ADD0                         194
 # define EVP_F_EVP_PKEY_METH_NEW                          195
 # define EVP_F_EVP_PKEY_NEW                               106
@@ -45,6 +45,11 @@ int OBJ_NAME_init(void);
 int OBJ_NAME_new_index(unsigned long (*hash_func) (const char *),
                        int (*cmp_func) (const char *, const char *),
                        void (*free_func) (const char *, int, const char *));
+/*
+ * Digest and cipher names are looked up without taking a lock, in a snapshot
+ * that is rebuilt after the names change.  After 16 rebuilds those lookups
+ * take the lock again until OBJ_NAME_cleanup(-1).
+ */
 const char *OBJ_NAME_get(const char *name, int type);
 int OBJ_NAME_add(const char *name, int type, const char *data);
 int OBJ_NAME_remove(const char *name, int type);
@@ -12,6 +12,7 @@
 #ifndef HEADER_SSL_H
 # define HEADER_SSL_H
 
+# include <sys/types.h>
 # include <openssl/e_os2.h>
 # include <openssl/opensslconf.h>
 # include <openssl/comp.h>
@@ -303,7 +304,8 @@ typedef int (*SSL_verify_cb)(int preverify_ok, X509_STORE_CTX *x509_ctx);
 /* Allow initial connection to servers that don't support RI */
 # define SSL_OP_LEGACY_SERVER_CONNECT                    0x00000004U
 
-/* Reserved value (until OpenSSL 1.2.0)                  0x00000008U */
+/* Hand the record layer to kernel TLS when the cipher allows it */
+# define SSL_OP_ENABLE_KTLS                              0x00000008U
 # define SSL_OP_TLSEXT_PADDING                           0x00000010U
 /* Reserved value (until OpenSSL 1.2.0)                  0x00000020U */
 # define SSL_OP_SAFARI_ECDHE_ECDSA_BUG                   0x00000040U
@@ -1305,6 +1307,15 @@ DECLARE_PEM_rw(SSL_SESSION, SSL_SESSION)
 # define SSL_CTRL_GET_MAX_PROTO_VERSION          131
 # define SSL_CTRL_GET_SIGNATURE_NID              132
 # define SSL_CTRL_GET_TMP_KEY                    133
+# define SSL_CTRL_SET_PEER_CERT_CACHE_SIZE       134
+# define SSL_CTRL_SET_BUFFER_POOL_SIZE           135
+# define SSL_CTRL_BUFFER_POOL_HITS               136
+# define SSL_CTRL_BUFFER_POOL_MISSES             137
+# define SSL_CTRL_BUFFER_POOL_IN_USE             138
+# define SSL_CTRL_BUFFER_POOL_HIGH_WATER         139
+# define SSL_CTRL_SET_KEYSHARE_POOL_SIZE         140
+# define SSL_CTRL_KEYSHARE_POOL_HITS             141
+# define SSL_CTRL_KEYSHARE_POOL_MISSES           142
 # define SSL_CERT_SET_FIRST                      1
 # define SSL_CERT_SET_NEXT                       2
 # define SSL_CERT_SET_SERVER                     3
@@ -1837,8 +1848,12 @@ __owur int SSL_read_early_data(SSL *s, void *buf, size_t num,
                                size_t *readbytes);
 __owur int SSL_peek(SSL *ssl, void *buf, int num);
 __owur int SSL_peek_ex(SSL *ssl, void *buf, size_t num, size_t *readbytes);
+__owur int SSL_read_view(SSL *s, const unsigned char **data, size_t *len);
+int SSL_release_view(SSL *s, size_t len);
 __owur int SSL_write(SSL *ssl, const void *buf, int num);
 __owur int SSL_write_ex(SSL *s, const void *buf, size_t num, size_t *written);
+__owur ossl_ssize_t SSL_sendfile(SSL *s, int fd, off_t offset, size_t size,
+                                 int flags);
 __owur int SSL_write_early_data(SSL *s, const void *buf, size_t num,
                                 size_t *written);
 long SSL_ctrl(SSL *ssl, int cmd, long larg, void *parg);
@@ -2053,6 +2068,24 @@ __owur int SSL_get_ex_data_X509_STORE_CTX_idx(void);
         SSL_CTX_ctrl(ctx,SSL_CTRL_SET_MAX_SEND_FRAGMENT,m,NULL)
 # define SSL_set_max_send_fragment(ssl,m) \
         SSL_ctrl(ssl,SSL_CTRL_SET_MAX_SEND_FRAGMENT,m,NULL)
+# define SSL_CTX_set_peer_cert_cache_size(ctx,m) \
+        SSL_CTX_ctrl(ctx,SSL_CTRL_SET_PEER_CERT_CACHE_SIZE,m,NULL)
+# define SSL_CTX_set_buffer_pool_size(ctx,m) \
+        SSL_CTX_ctrl(ctx,SSL_CTRL_SET_BUFFER_POOL_SIZE,m,NULL)
+# define SSL_CTX_buffer_pool_hits(ctx) \
+        SSL_CTX_ctrl(ctx,SSL_CTRL_BUFFER_POOL_HITS,0,NULL)
+# define SSL_CTX_buffer_pool_misses(ctx) \
+        SSL_CTX_ctrl(ctx,SSL_CTRL_BUFFER_POOL_MISSES,0,NULL)
+# define SSL_CTX_buffer_pool_in_use(ctx) \
+        SSL_CTX_ctrl(ctx,SSL_CTRL_BUFFER_POOL_IN_USE,0,NULL)
+# define SSL_CTX_buffer_pool_high_water(ctx) \
+        SSL_CTX_ctrl(ctx,SSL_CTRL_BUFFER_POOL_HIGH_WATER,0,NULL)
+# define SSL_CTX_set_keyshare_pool_size(ctx,m) \
+        SSL_CTX_ctrl(ctx,SSL_CTRL_SET_KEYSHARE_POOL_SIZE,m,NULL)
+# define SSL_CTX_keyshare_pool_hits(ctx) \
+        SSL_CTX_ctrl(ctx,SSL_CTRL_KEYSHARE_POOL_HITS,0,NULL)
+# define SSL_CTX_keyshare_pool_misses(ctx) \
+        SSL_CTX_ctrl(ctx,SSL_CTRL_KEYSHARE_POOL_MISSES,0,NULL)
 # define SSL_CTX_set_split_send_fragment(ctx,m) \
         SSL_CTX_ctrl(ctx,SSL_CTRL_SET_SPLIT_SEND_FRAGMENT,m,NULL)
 # define SSL_set_split_send_fragment(ssl,m) \
@@ -2063,6 +2096,7 @@ __owur int SSL_get_ex_data_X509_STORE_CTX_idx(void);
         SSL_ctrl(ssl,SSL_CTRL_SET_MAX_PIPELINES,m,NULL)
 
 void SSL_CTX_set_default_read_buffer_len(SSL_CTX *ctx, size_t len);
+int SSL_CTX_fill_keyshare_pool(SSL_CTX *ctx, int max);
 void SSL_set_default_read_buffer_len(SSL *s, size_t len);
 
 # ifndef OPENSSL_NO_DH
@@ -2087,6 +2121,8 @@ __owur STACK_OF(SSL_COMP) *SSL_COMP_set0_compression_methods(STACK_OF(SSL_COMP)
 #  define SSL_COMP_free_compression_methods() while(0) continue
 # endif
 __owur int SSL_COMP_add_compression_method(int id, COMP_METHOD *cm);
+__owur int SSL_CTX_add_cert_compression_alg(SSL_CTX *ctx, int alg,
+                                            COMP_METHOD *meth);
 
 const SSL_CIPHER *SSL_CIPHER_find(SSL *ssl, const unsigned char *ptr);
 int SSL_CIPHER_get_cipher_nid(const SSL_CIPHER *c);
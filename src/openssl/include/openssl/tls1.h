@@ -131,6 +131,9 @@ extern "C" {
 /* ExtensionType value from RFC7627 */
 # define TLSEXT_TYPE_extended_master_secret      23
 
+/* ExtensionType value from RFC8879 */
+# define TLSEXT_TYPE_compress_certificate        27
+
 /* ExtensionType value from RFC4507 */
 # define TLSEXT_TYPE_session_ticket              35
 
@@ -158,6 +161,11 @@ extern "C" {
 /* status request value from RFC3546 */
 # define TLSEXT_STATUSTYPE_ocsp 1
 
+/* CertificateCompressionAlgorithm values from RFC8879 */
+# define TLSEXT_comp_cert_zlib                           1
+# define TLSEXT_comp_cert_brotli                         2
+# define TLSEXT_comp_cert_zstd                           3
+
 /* ECPointFormat values from RFC4492 */
 # define TLSEXT_ECPOINTFORMAT_first                      0
 # define TLSEXT_ECPOINTFORMAT_uncompressed               0
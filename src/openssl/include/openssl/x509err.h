@@ -25,6 +25,7 @@ int ERR_load_X509_strings(void);
  */
 # define X509_F_ADD_CERT_DIR                              100
 # define X509_F_BUILD_CHAIN                               106
+# define X509_F_BUILD_DIR_INDEX                           161
 # define X509_F_BY_FILE_CTRL                              101
 # define X509_F_CHECK_NAME_CONSTRAINTS                    149
 # define X509_F_CHECK_POLICY                              145
@@ -32,10 +33,13 @@ int ERR_load_X509_strings(void);
 # define X509_F_DIR_CTRL                                  102
 # define X509_F_GET_CERT_BY_SUBJECT                       103
 # define X509_F_I2D_X509_AUX                              151
+# define X509_F_LOAD_HASH_FILE                            162
 # define X509_F_LOOKUP_CERTS_SK                           152
 # define X509_F_NETSCAPE_SPKI_B64_DECODE                  129
 # define X509_F_NETSCAPE_SPKI_B64_ENCODE                  130
 # define X509_F_NEW_DIR                                   153
+# define X509_F_NEW_HASH_FILE                             163
+# define X509_F_READ_HASH_FILE                            164
 # define X509_F_X509AT_ADD1_ATTR                          135
 # define X509_F_X509V3_ADD_EXT                            104
 # define X509_F_X509_ATTRIBUTE_CREATE_BY_NID              136
@@ -50,6 +54,7 @@ int ERR_load_X509_strings(void);
 # define X509_F_X509_EXTENSION_CREATE_BY_NID              108
 # define X509_F_X509_EXTENSION_CREATE_BY_OBJ              109
 # define X509_F_X509_GET_PUBKEY_PARAMETERS                110
+# define X509_F_X509_HASH_FILE_WRITE_BIO                  165
 # define X509_F_X509_LOAD_CERT_CRL_FILE                   132
 # define X509_F_X509_LOAD_CERT_FILE                       111
 # define X509_F_X509_LOAD_CRL_FILE                        112
@@ -100,6 +105,7 @@ int ERR_load_X509_strings(void);
 # define X509_R_INVALID_ATTRIBUTES                        138
 # define X509_R_INVALID_DIRECTORY                         113
 # define X509_R_INVALID_FIELD_NAME                        119
+# define X509_R_INVALID_HASH_FILE                         139
 # define X509_R_INVALID_TRUST                             123
 # define X509_R_ISSUER_MISMATCH                           129
 # define X509_R_KEY_TYPE_MISMATCH                         115
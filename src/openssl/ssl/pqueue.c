@@ -1,5 +1,5 @@
 /*
- * Copyright 2005-2018 The OpenSSL Project Authors. All Rights Reserved.
+ * Copyright 2005-2020 The OpenSSL Project Authors. All Rights Reserved.
  *
  * Licensed under the OpenSSL license (the "License").  You may not use
  * this file except in compliance with the License.  You can obtain a copy
@@ -10,11 +10,116 @@
 #include "ssl_local.h"
 #include <openssl/bn.h>
 
+/*
+ * The DTLS queues are keyed by handshake message or record sequence numbers,
+ * which mostly arrive in order and close together.  Items are kept in a
+ * sorted list for peek/pop and iteration, and the items whose priority lies
+ * in a window of PQUEUE_WINDOW consecutive values ending at or after the
+ * highest queued priority are also indexed in a ring of slots.  This makes
+ * appending, inserting a reordered item and finding an item O(1) unless the
+ * item lies more than PQUEUE_WINDOW behind the newest one, in which case the
+ * list is walked as before.
+ */
+#define PQUEUE_WINDOW   64
+
 struct pqueue_st {
-    pitem *items;
-    int count;
+    pitem *items;               /* sorted by priority */
+    pitem *last;                /* highest priority item in |items| */
+    size_t count;
+    /*
+     * The window covers priorities [base, base + PQUEUE_WINDOW) and always
+     * contains the priority of |last|.  A queued item with priority p in the
+     * window is in slots[p % PQUEUE_WINDOW] and has that bit set in |map|,
+     * slots whose bit is clear are unused.
+     */
+    uint64_t base;
+    uint64_t map;
+    pitem *slots[PQUEUE_WINDOW];
 };
 
+static ossl_inline uint64_t pitem_prio(const unsigned char *prio64be)
+{
+    uint64_t prio;
+
+    n2l8(prio64be, prio);
+    return prio;
+}
+
+static ossl_inline unsigned int pqueue_slot(uint64_t prio)
+{
+    return (unsigned int)(prio % PQUEUE_WINDOW);
+}
+
+static ossl_inline int pqueue_in_window(const pqueue *pq, uint64_t prio)
+{
+    /* Priorities below |base| wrap around to large differences */
+    return prio - pq->base < PQUEUE_WINDOW;
+}
+
+static ossl_inline uint64_t rotl64(uint64_t v, unsigned int n)
+{
+    return n == 0 ? v : (v << n) | (v >> (64 - n));
+}
+
+static unsigned int top_bit(uint64_t v)
+{
+    unsigned int n = 0;
+
+    if (v >> 32) {
+        v >>= 32;
+        n += 32;
+    }
+    if (v >> 16) {
+        v >>= 16;
+        n += 16;
+    }
+    if (v >> 8) {
+        v >>= 8;
+        n += 8;
+    }
+    if (v >> 4) {
+        v >>= 4;
+        n += 4;
+    }
+    if (v >> 2) {
+        v >>= 2;
+        n += 2;
+    }
+    if (v >> 1)
+        n += 1;
+    return n;
+}
+
+/* Move the start of the window up to |base|, forgetting the items below it */
+static void pqueue_slide(pqueue *pq, uint64_t base)
+{
+    uint64_t delta = base - pq->base;
+
+    if (delta >= PQUEUE_WINDOW)
+        pq->map = 0;
+    else if (delta > 0)
+        pq->map &= ~rotl64(((uint64_t)1 << delta) - 1, pqueue_slot(pq->base));
+    pq->base = base;
+}
+
+/*
+ * Returns the indexed item with the highest priority below |prio|, which must
+ * be in the window, or NULL if there is none.
+ */
+static pitem *pqueue_window_prev(const pqueue *pq, uint64_t prio)
+{
+    unsigned int s0 = pqueue_slot(pq->base);
+    uint64_t below = prio - pq->base;
+    uint64_t map;
+
+    /* Bit i of |map| is now the item with priority base + i */
+    map = s0 == 0 ? pq->map : (pq->map >> s0) | (pq->map << (64 - s0));
+    map &= ((uint64_t)1 << below) - 1;
+    if (map == 0)
+        return NULL;
+    return pq->slots[pqueue_slot(pq->base + top_bit(map))];
+}
+
 pitem *pitem_new(unsigned char *prio64be, void *data)
 {
     pitem *item = OPENSSL_malloc(sizeof(*item));
@@ -52,37 +157,67 @@ void pqueue_free(pqueue *pq)
 
 pitem *pqueue_insert(pqueue *pq, pitem *item)
 {
+    uint64_t prio = pitem_prio(item->priority);
+    unsigned int slot = pqueue_slot(prio);
     pitem *curr, *next;
 
     if (pq->items == NULL) {
-        pq->items = item;
-        return item;
-    }
-
-    for (curr = NULL, next = pq->items;
-         next != NULL; curr = next, next = next->next) {
-        /*
-         * we can compare 64-bit value in big-endian encoding with memcmp:-)
-         */
-        int cmp = memcmp(next->priority, item->priority, 8);
-        if (cmp > 0) {          /* next > item */
-            item->next = next;
+        item->next = NULL;
+        pq->items = pq->last = item;
+        pq->base = prio;
+        pq->map = 0;
+    } else if (prio > pitem_prio(pq->last->priority)) {
+        /* The common case: a new highest priority */
+        if (!pqueue_in_window(pq, prio))
+            pqueue_slide(pq, prio - (PQUEUE_WINDOW - 1));
+        item->next = NULL;
+        pq->last->next = item;
+        pq->last = item;
+    } else if (pqueue_in_window(pq, prio)) {
+        /* duplicates not allowed */
+        if ((pq->map & ((uint64_t)1 << slot)) != 0)
+            return NULL;
 
+        curr = pqueue_window_prev(pq, prio);
+        if (curr == NULL && memcmp(pq->items->priority, item->priority, 8) > 0) {
+            /* The new lowest priority */
+            item->next = pq->items;
+            pq->items = item;
+        } else {
+            /* Otherwise the previous item is below the window */
             if (curr == NULL)
-                pq->items = item;
-            else
-                curr->next = item;
-
-            return item;
+                for (curr = pq->items;
+                     memcmp(curr->next->priority, item->priority, 8) < 0;
+                     curr = curr->next)
+                    continue;
+            item->next = curr->next;
+            curr->next = item;
         }
-
-        else if (cmp == 0)      /* duplicates not allowed */
-            return NULL;
+    } else {
+        /* Far behind the newest item, fall back to walking the list */
+        for (curr = NULL, next = pq->items; ; curr = next, next = next->next) {
+            /*
+             * we can compare 64-bit value in big-endian encoding with memcmp:-)
+             */
+            int cmp = memcmp(next->priority, item->priority, 8);
+
+            if (cmp == 0)       /* duplicates not allowed */
+                return NULL;
+            if (cmp > 0)        /* next > item */
+                break;
+        }
+        item->next = next;
+        if (curr == NULL)
+            pq->items = item;
+        else
+            curr->next = item;
+        pq->count++;
+        return item;
     }
 
-    item->next = NULL;
-    curr->next = item;
-
+    pq->slots[slot] = item;
+    pq->map |= (uint64_t)1 << slot;
+    pq->count++;
     return item;
 }
 
@@ -94,36 +229,48 @@ pitem *pqueue_peek(pqueue *pq)
 pitem *pqueue_pop(pqueue *pq)
 {
     pitem *item = pq->items;
+    uint64_t prio;
+
+    if (item == NULL)
+        return NULL;
 
-    if (pq->items != NULL)
-        pq->items = pq->items->next;
+    prio = pitem_prio(item->priority);
+    if (pqueue_in_window(pq, prio))
+        pq->map &= ~((uint64_t)1 << pqueue_slot(prio));
+    pq->items = item->next;
+    if (pq->items == NULL)
+        pq->last = NULL;
+    pq->count--;
 
     return item;
 }
 
 pitem *pqueue_find(pqueue *pq, unsigned char *prio64be)
 {
+    uint64_t prio = pitem_prio(prio64be);
+    unsigned int slot = pqueue_slot(prio);
     pitem *next;
-    pitem *found = NULL;
 
     if (pq->items == NULL)
         return NULL;
 
-    for (next = pq->items; next->next != NULL; next = next->next) {
-        if (memcmp(next->priority, prio64be, 8) == 0) {
-            found = next;
-            break;
-        }
-    }
-
-    /* check the one last node */
-    if (memcmp(next->priority, prio64be, 8) == 0)
-        found = next;
+    if (pqueue_in_window(pq, prio))
+        return (pq->map & ((uint64_t)1 << slot)) != 0 ? pq->slots[slot] : NULL;
 
-    if (!found)
+    /* Nothing is queued above the window */
+    if (prio >= pq->base)
         return NULL;
 
-    return found;
+    for (next = pq->items; next != NULL; next = next->next) {
+        int cmp = memcmp(next->priority, prio64be, 8);
+
+        if (cmp == 0)
+            return next;
+        if (cmp > 0)
+            break;
+    }
+
+    return NULL;
 }
 
 pitem *pqueue_iterator(pqueue *pq)
@@ -147,12 +294,5 @@ pitem *pqueue_next(piterator *item)
 
 size_t pqueue_size(pqueue *pq)
 {
-    pitem *item = pq->items;
-    size_t count = 0;
-
-    while (item != NULL) {
-        count++;
-        item = item->next;
-    }
-    return count;
+    return pq->count;
 }
@@ -16,6 +16,7 @@
 #include <openssl/rand.h>
 #include "record_local.h"
 #include "../packet_local.h"
+#include "internal/bio.h"
 
 #if     defined(OPENSSL_SMALL_FOOTPRINT) || \
         !(      defined(AESNI_ASM) &&   ( \
@@ -268,8 +269,12 @@ int ssl3_read_n(SSL *s, size_t n, size_t max, int extend, int clearold,
         return -1;
     }
 
-    /* We always act like read_ahead is set for DTLS */
-    if (!s->rlayer.read_ahead && !SSL_IS_DTLS(s))
+    /*
+     * We always act like read_ahead is set for DTLS, and with kernel TLS a
+     * read returns at most one record whatever the size asked for.
+     */
+    if (!s->rlayer.read_ahead && !SSL_IS_DTLS(s)
+            && !BIO_get_ktls_recv(s->rbio))
         /* ignore max parameter */
         max = n;
     else {
@@ -330,6 +335,38 @@ int ssl3_read_n(SSL *s, size_t n, size_t max, int extend, int clearold,
     return 1;
 }
 
+/*
+ * Maximum number of records that ssl3_write_bytes() seals into one buffer
+ * for a single write when the cipher can't pipeline them itself.
+ */
+#define MAX_WRITE_BATCH 8
+
+/*
+ * AEAD ciphers grow every record by the same tag length, which lets several
+ * records be laid out back to back in one write buffer before any of them is
+ * encrypted.  Returns that length if records can currently be batched, or 0.
+ */
+static size_t ssl3_write_batch_taglen(SSL *s)
+{
+    const EVP_CIPHER *c;
+
+    if (s->enc_write_ctx == NULL
+            || SSL_IS_DTLS(s)
+            || s->compress != NULL
+            || s->statem.enc_write_state != ENC_WRITE_STATE_VALID
+            || BIO_get_ktls_send(s->wbio))
+        return 0;
+
+    c = EVP_CIPHER_CTX_cipher(s->enc_write_ctx);
+    if ((EVP_CIPHER_flags(c) & EVP_CIPH_FLAG_PIPELINE) != 0)
+        return 0;
+    if (EVP_CIPHER_mode(c) == EVP_CIPH_GCM_MODE)
+        return EVP_GCM_TLS_TAG_LEN;
+    if (EVP_CIPHER_nid(c) == NID_chacha20_poly1305)
+        return EVP_CHACHAPOLY_TLS_TAG_LEN;
+    return 0;
+}
+
 /*
  * Call this to write data in records of type 'type' It will return <= 0 if
  * not all data has been sent or non-blocking IO.
@@ -344,8 +381,8 @@ int ssl3_write_bytes(SSL *s, int type, const void *buf_, size_t len,
     size_t nw;
 #endif
     SSL3_BUFFER *wb = &s->rlayer.wbuf[0];
-    int i;
-    size_t tmpwrit;
+    int i, batch;
+    size_t tmpwrit, batchlen = 0;
 
     s->rwstate = SSL_NOTHING;
     tot = s->rlayer.wnum;
@@ -587,6 +624,24 @@ int ssl3_write_bytes(SSL *s, int type, const void *buf_, size_t len,
         return -1;
     }
 
+    /*
+     * Without a cipher that pipelines, large writes with an AEAD cipher are
+     * still sealed several records at a time into one jumbo buffer, so that
+     * they reach the BIO in a single write.
+     */
+    batch = maxpipes == 1
+            && type == SSL3_RT_APPLICATION_DATA
+            && len >= 4 * max_send_fragment
+            && s->rlayer.numwpipes <= 1
+            && ssl3_write_batch_taglen(s) != 0;
+    if (batch) {
+        batchlen = MAX_WRITE_BATCH * (max_send_fragment + SSL3_RT_HEADER_LENGTH
+                                      + SSL3_RT_SEND_MAX_ENCRYPTED_OVERHEAD);
+#if defined(SSL3_ALIGN_PAYLOAD) && SSL3_ALIGN_PAYLOAD != 0
+        batchlen += SSL3_ALIGN_PAYLOAD - 1;
+#endif
+    }
+
     for (;;) {
         size_t pipelens[SSL_MAX_PIPELINES], tmppipelen, remain;
         size_t numpipes, j;
@@ -598,6 +653,19 @@ int ssl3_write_bytes(SSL *s, int type, const void *buf_, size_t len,
         if (numpipes > maxpipes)
             numpipes = maxpipes;
 
+        if (batch && n >= 2 * max_send_fragment) {
+            numpipes = n / max_send_fragment;
+            if (numpipes > MAX_WRITE_BATCH)
+                numpipes = MAX_WRITE_BATCH;
+            /* Nothing is pending here, so the buffer can be replaced */
+            if ((s->rlayer.numwpipes != 1
+                 || SSL3_BUFFER_get_len(wb) < batchlen)
+                    && !ssl3_setup_write_buffer(s, 1, batchlen)) {
+                /* SSLfatal() already called */
+                return -1;
+            }
+        }
+
         if (n / numpipes >= max_send_fragment) {
             /*
              * We have enough data to completely fill all available
@@ -636,7 +704,8 @@ int ssl3_write_bytes(SSL *s, int type, const void *buf_, size_t len,
             s->s3->empty_fragment_done = 0;
 
             if (tmpwrit == n
-                    && (s->mode & SSL_MODE_RELEASE_BUFFERS) != 0
+                    && ((s->mode & SSL_MODE_RELEASE_BUFFERS) != 0
+                        || (batch && SSL3_BUFFER_get_len(wb) == batchlen))
                     && !SSL_IS_DTLS(s))
                 ssl3_release_write_buffer(s);
 
@@ -665,7 +734,7 @@ int do_ssl3_write(SSL *s, int type, const unsigned char *buf,
     SSL3_BUFFER *wb;
     SSL_SESSION *sess;
     size_t totlen = 0, len, wpinited = 0;
-    size_t j;
+    size_t j, numwbufs = numpipes, taglen = 0, batchleft = 0;
 
     for (j = 0; j < numpipes; j++)
         totlen += pipelens[j];
@@ -688,8 +757,22 @@ int do_ssl3_write(SSL *s, int type, const unsigned char *buf,
         /* if it went, fall through and send more stuff */
     }
 
-    if (s->rlayer.numwpipes < numpipes) {
-        if (!ssl3_setup_write_buffer(s, numpipes, 0)) {
+    /*
+     * Several records for a cipher that can't pipeline them go one after the
+     * other into the first write buffer, which ssl3_write_bytes() has sized
+     * for them.
+     */
+    if (numpipes > 1 && (taglen = ssl3_write_batch_taglen(s)) != 0) {
+        if (create_empty_fragment || s->rlayer.numwpipes != 1) {
+            SSLfatal(s, SSL_AD_INTERNAL_ERROR, SSL_F_DO_SSL3_WRITE,
+                     ERR_R_INTERNAL_ERROR);
+            return -1;
+        }
+        numwbufs = 1;
+    }
+
+    if (s->rlayer.numwpipes < numwbufs) {
+        if (!ssl3_setup_write_buffer(s, numwbufs, 0)) {
             /* SSLfatal() already called */
             return -1;
         }
@@ -698,6 +781,32 @@ int do_ssl3_write(SSL *s, int type, const unsigned char *buf,
     if (totlen == 0 && !create_empty_fragment)
         return 0;
 
+#ifndef OPENSSL_NO_KTLS
+    /*
+     * The kernel frames and encrypts the record itself: pass the plaintext
+     * down and tell it the record type if that isn't application data.
+     */
+    if (BIO_get_ktls_send(s->wbio)) {
+        wb = &s->rlayer.wbuf[0];
+        if (numpipes != 1 || totlen > SSL3_BUFFER_get_len(wb)) {
+            SSLfatal(s, SSL_AD_INTERNAL_ERROR, SSL_F_DO_SSL3_WRITE,
+                     ERR_R_INTERNAL_ERROR);
+            return -1;
+        }
+        memcpy(SSL3_BUFFER_get_buf(wb), buf, totlen);
+        SSL3_BUFFER_set_offset(wb, 0);
+        SSL3_BUFFER_set_left(wb, totlen);
+        if (type != SSL3_RT_APPLICATION_DATA)
+            BIO_set_ktls_ctrl_msg(s->wbio, type);
+
+        s->rlayer.wpend_tot = totlen;
+        s->rlayer.wpend_buf = buf;
+        s->rlayer.wpend_type = type;
+        s->rlayer.wpend_ret = totlen;
+        return ssl3_write_pending(s, type, buf, totlen, written);
+    }
+#endif
+
     sess = s->session;
 
     if ((sess == NULL) ||
@@ -784,7 +893,7 @@ int do_ssl3_write(SSL *s, int type, const unsigned char *buf,
         }
         wpinited = 1;
     } else {
-        for (j = 0; j < numpipes; j++) {
+        for (j = 0; j < numwbufs; j++) {
             thispkt = &pkt[j];
 
             wb = &s->rlayer.wbuf[j];
@@ -833,6 +942,22 @@ int do_ssl3_write(SSL *s, int type, const unsigned char *buf,
         thispkt = &pkt[j];
         thiswr = &wr[j];
 
+        if (j >= numwbufs) {
+            /* Start where the previous record will end once sealed */
+            unsigned char *next = WPACKET_get_curr(&pkt[j - 1]) + taglen;
+            unsigned char *end = SSL3_BUFFER_get_buf(&s->rlayer.wbuf[0])
+                                 + SSL3_BUFFER_get_len(&s->rlayer.wbuf[0]);
+
+            if (next > end
+                    || !WPACKET_init_static_len(thispkt, next,
+                                                (size_t)(end - next), 0)) {
+                SSLfatal(s, SSL_AD_INTERNAL_ERROR, SSL_F_DO_SSL3_WRITE,
+                         ERR_R_INTERNAL_ERROR);
+                goto err;
+            }
+            wpinited++;
+        }
+
         /*
          * In TLSv1.3, once encrypting, we always use application data for the
          * record type
@@ -1007,6 +1132,16 @@ int do_ssl3_write(SSL *s, int type, const unsigned char *buf,
             }
             goto err;
         }
+    } else if (numwbufs < numpipes) {
+        for (j = 0; j < numpipes; j++) {
+            if (s->method->ssl3_enc->enc(s, &wr[j], 1, 1) < 1) {
+                if (!ossl_statem_in_error(s)) {
+                    SSLfatal(s, SSL_AD_INTERNAL_ERROR, SSL_F_DO_SSL3_WRITE,
+                             ERR_R_INTERNAL_ERROR);
+                }
+                goto err;
+            }
+        }
     } else {
         if (s->method->ssl3_enc->enc(s, wr, numpipes, 1) < 1) {
             if (!ossl_statem_in_error(s)) {
@@ -1027,6 +1162,8 @@ int do_ssl3_write(SSL *s, int type, const unsigned char *buf,
         if (!WPACKET_get_length(thispkt, &origlen)
                    /* Encryption should never shrink the data! */
                 || origlen > thiswr->length
+                   /* Batched records must end where the next one starts */
+                || (numwbufs < numpipes && thiswr->length - origlen != taglen)
                 || (thiswr->length > origlen
                     && !WPACKET_allocate_bytes(thispkt,
                                                thiswr->length - origlen, NULL))) {
@@ -1098,9 +1235,14 @@ int do_ssl3_write(SSL *s, int type, const unsigned char *buf,
         }
 
         /* now let's set up wb */
-        SSL3_BUFFER_set_left(&s->rlayer.wbuf[j],
-                             prefix_len + SSL3_RECORD_get_length(thiswr));
+        if (numwbufs < numpipes)
+            batchleft += SSL3_RECORD_get_length(thiswr);
+        else
+            SSL3_BUFFER_set_left(&s->rlayer.wbuf[j],
+                                 prefix_len + SSL3_RECORD_get_length(thiswr));
     }
+    if (numwbufs < numpipes)
+        SSL3_BUFFER_set_left(&s->rlayer.wbuf[0], batchleft);
 
     /*
      * memorize arguments so that ssl3_write_pending can detect bad write
@@ -1750,6 +1892,67 @@ int ssl3_read_bytes(SSL *s, int type, int *recvd_type, unsigned char *buf,
     }
 }
 
+/*
+ * Return the first record that has been decrypted but not yet fully read, or
+ * NULL if there is none or it is not an application data record.
+ */
+static SSL3_RECORD *ssl3_view_record(SSL *s)
+{
+    SSL3_RECORD *rr = s->rlayer.rrec;
+    size_t curr_rec, num_recs = RECORD_LAYER_get_numrpipes(&s->rlayer);
+
+    for (curr_rec = 0; curr_rec < num_recs; curr_rec++, rr++) {
+        if (SSL3_RECORD_is_read(rr))
+            continue;
+        if (SSL3_RECORD_get_type(rr) != SSL3_RT_APPLICATION_DATA
+                || SSL3_RECORD_get_length(rr) == 0)
+            return NULL;
+        return rr;
+    }
+    return NULL;
+}
+
+/*
+ * Point |*data| at the unread plaintext of the current application data
+ * record.  The caller must already have made one available with a peek.
+ */
+int ssl3_read_view(SSL *s, const unsigned char **data, size_t *len)
+{
+    SSL3_RECORD *rr = ssl3_view_record(s);
+
+    if (rr == NULL)
+        return 0;
+
+    *data = &rr->data[rr->off];
+    *len = SSL3_RECORD_get_length(rr);
+    return 1;
+}
+
+/*
+ * Consume |len| bytes of the view handed out by ssl3_read_view(), exactly as
+ * ssl3_read_bytes() does after copying them out.
+ */
+int ssl3_release_view(SSL *s, size_t len)
+{
+    SSL3_RECORD *rr = ssl3_view_record(s);
+
+    if (rr == NULL || len > SSL3_RECORD_get_length(rr))
+        return 0;
+
+    SSL3_RECORD_sub_length(rr, len);
+    SSL3_RECORD_add_off(rr, len);
+    if (SSL3_RECORD_get_length(rr) == 0) {
+        s->rlayer.rstate = SSL_ST_READ_HEADER;
+        SSL3_RECORD_set_off(rr, 0);
+        SSL3_RECORD_set_read(rr);
+        if (rr == &s->rlayer.rrec[RECORD_LAYER_get_numrpipes(&s->rlayer) - 1]
+                && (s->mode & SSL_MODE_RELEASE_BUFFERS)
+                && SSL3_BUFFER_get_left(&s->rlayer.rbuf) == 0)
+            ssl3_release_read_buffer(s);
+    }
+    return 1;
+}
+
 void ssl3_record_sequence_update(unsigned char *seq)
 {
     int i;
@@ -25,6 +25,8 @@ typedef struct ssl3_buffer_st {
     size_t offset;
     /* how many bytes left */
     size_t left;
+    /* buf was taken from the SSL_CTX buffer pool, see ssl3_buffer.c */
+    int pooled;
 } SSL3_BUFFER;
 
 #define SEQ_NUM_SIZE                            8
@@ -210,6 +212,8 @@ int do_ssl3_write(SSL *s, int type, const unsigned char *buf,
 __owur int ssl3_read_bytes(SSL *s, int type, int *recvd_type,
                            unsigned char *buf, size_t len, int peek,
                            size_t *readbytes);
+int ssl3_read_view(SSL *s, const unsigned char **data, size_t *len);
+int ssl3_release_view(SSL *s, size_t len);
 __owur int ssl3_setup_buffers(SSL *s);
 __owur int ssl3_enc(SSL *s, SSL3_RECORD *inrecs, size_t n_recs, int send);
 __owur int n_ssl3_mac(SSL *ssl, SSL3_RECORD *rec, unsigned char *md, int send);
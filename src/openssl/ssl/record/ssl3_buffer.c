@@ -34,11 +34,203 @@ void SSL3_BUFFER_release(SSL3_BUFFER *b)
     b->buf = NULL;
 }
 
+/*
+ * Record buffers shared between the connections of an SSL_CTX.  Buffers of
+ * the default size are put on a free list when a connection releases them
+ * and handed out again to the next connection that needs one, so that only
+ * connections with data in flight hold a buffer.  The free list entries are
+ * stored in the buffers themselves.
+ */
+struct ssl_buf_freelist_entry_st {
+    struct ssl_buf_freelist_entry_st *next;
+};
+
+static SSL_BUF_POOL *ssl3_buf_pool(SSL *s)
+{
+    /* session_ctx does not change under SSL_set_SSL_CTX() */
+    if (SSL_IS_DTLS(s) || s->session_ctx == NULL)
+        return NULL;
+    return s->session_ctx->buf_pool;
+}
+
+static void freelist_trim(SSL_BUF_FREELIST *list, size_t max_len)
+{
+    struct ssl_buf_freelist_entry_st *ent;
+
+    while (list->len > max_len) {
+        ent = list->head;
+        list->head = ent->next;
+        list->len--;
+        OPENSSL_free(ent);
+    }
+}
+
+/*
+ * Get a buffer of |len| bytes, from the read or write free list of the pool
+ * if it has one of the right size.  |dflt| is set if |len| is the usual size
+ * for the connection, in which case an empty list takes on that size.  Only
+ * buffers of the size of the list are pooled: |*pooled| is set if the buffer
+ * is to be given back with freelist_insert().
+ */
+static unsigned char *freelist_extract(SSL *s, int for_read, size_t len,
+                                       int dflt, int *pooled)
+{
+    SSL_BUF_POOL *pool = ssl3_buf_pool(s);
+    SSL_BUF_FREELIST *list;
+    struct ssl_buf_freelist_entry_st *ent = NULL;
+    unsigned char *p;
+
+    *pooled = 0;
+    if (pool == NULL)
+        return OPENSSL_malloc(len);
+    list = for_read ? &pool->rbuf : &pool->wbuf;
+
+    CRYPTO_THREAD_write_lock(pool->lock);
+    if (list->head == NULL && dflt)
+        list->chunklen = len;
+    if (list->chunklen == len) {
+        if (list->head != NULL) {
+            ent = list->head;
+            list->head = ent->next;
+            list->len--;
+            pool->hits++;
+        } else {
+            pool->misses++;
+        }
+        if (++pool->in_use > pool->high_water)
+            pool->high_water = pool->in_use;
+        *pooled = 1;
+    }
+    CRYPTO_THREAD_unlock(pool->lock);
+
+    if ((p = (unsigned char *)ent) == NULL
+            && (p = OPENSSL_malloc(len)) == NULL) {
+        if (*pooled) {
+            CRYPTO_THREAD_write_lock(pool->lock);
+            pool->in_use--;
+            CRYPTO_THREAD_unlock(pool->lock);
+            *pooled = 0;
+        }
+        return NULL;
+    }
+    return p;
+}
+
+/*
+ * Give the buffer of |b| back, putting it on the read or write free list of
+ * the pool if it is of the size of the list and there is room for it.
+ */
+static void freelist_insert(SSL *s, SSL3_BUFFER *b, int for_read)
+{
+    SSL_BUF_POOL *pool = ssl3_buf_pool(s);
+    SSL_BUF_FREELIST *list;
+    struct ssl_buf_freelist_entry_st *ent;
+
+    if (!b->pooled || pool == NULL) {
+        OPENSSL_free(b->buf);
+        b->buf = NULL;
+        b->pooled = 0;
+        return;
+    }
+    list = for_read ? &pool->rbuf : &pool->wbuf;
+
+    /* The next user of the buffer may be another connection */
+    OPENSSL_cleanse(b->buf, b->len);
+
+    CRYPTO_THREAD_write_lock(pool->lock);
+    pool->in_use--;
+    if (list->chunklen == b->len && list->len < pool->max_len
+            && b->len >= sizeof(*ent)) {
+        ent = (struct ssl_buf_freelist_entry_st *)b->buf;
+        ent->next = list->head;
+        list->head = ent;
+        list->len++;
+        b->buf = NULL;
+    }
+    CRYPTO_THREAD_unlock(pool->lock);
+
+    OPENSSL_free(b->buf);
+    b->buf = NULL;
+    b->pooled = 0;
+}
+
+void ssl_buf_pool_free(SSL_BUF_POOL *pool)
+{
+    if (pool == NULL)
+        return;
+    freelist_trim(&pool->rbuf, 0);
+    freelist_trim(&pool->wbuf, 0);
+    CRYPTO_THREAD_lock_free(pool->lock);
+    OPENSSL_free(pool);
+}
+
+/*
+ * Keep up to |size| free buffers of each kind in the pool of |ctx|, creating
+ * the pool on first use.
+ */
+int ssl_buf_pool_set_size(SSL_CTX *ctx, size_t size)
+{
+    SSL_BUF_POOL *pool = ctx->buf_pool;
+
+    if (pool == NULL) {
+        if (size == 0)
+            return 1;
+        if ((pool = OPENSSL_zalloc(sizeof(*pool))) == NULL
+                || (pool->lock = CRYPTO_THREAD_lock_new()) == NULL) {
+            OPENSSL_free(pool);
+            SSLerr(SSL_F_SSL_BUF_POOL_SET_SIZE, ERR_R_MALLOC_FAILURE);
+            return 0;
+        }
+        ctx->buf_pool = pool;
+    }
+
+    CRYPTO_THREAD_write_lock(pool->lock);
+    pool->max_len = size;
+    freelist_trim(&pool->rbuf, size);
+    freelist_trim(&pool->wbuf, size);
+    if (size == 0)
+        pool->rbuf.chunklen = pool->wbuf.chunklen = 0;
+    CRYPTO_THREAD_unlock(pool->lock);
+
+    /* Connections only hold on to buffers while they have data in flight */
+    if (size > 0)
+        ctx->mode |= SSL_MODE_RELEASE_BUFFERS;
+    return 1;
+}
+
+long ssl_buf_pool_get_stat(SSL_CTX *ctx, int cmd)
+{
+    SSL_BUF_POOL *pool = ctx->buf_pool;
+    size_t ret = 0;
+
+    if (pool == NULL)
+        return 0;
+
+    CRYPTO_THREAD_read_lock(pool->lock);
+    switch (cmd) {
+    case SSL_CTRL_BUFFER_POOL_HITS:
+        ret = pool->hits;
+        break;
+    case SSL_CTRL_BUFFER_POOL_MISSES:
+        ret = pool->misses;
+        break;
+    case SSL_CTRL_BUFFER_POOL_IN_USE:
+        ret = pool->in_use;
+        break;
+    case SSL_CTRL_BUFFER_POOL_HIGH_WATER:
+        ret = pool->high_water;
+        break;
+    }
+    CRYPTO_THREAD_unlock(pool->lock);
+    return (long)ret;
+}
+
 int ssl3_setup_read_buffer(SSL *s)
 {
     unsigned char *p;
     size_t len, align = 0, headerlen;
     SSL3_BUFFER *b;
+    int dflt;
 
     b = RECORD_LAYER_get_rbuf(&s->rlayer);
 
@@ -58,9 +250,10 @@ int ssl3_setup_read_buffer(SSL *s)
         if (ssl_allow_compression(s))
             len += SSL3_RT_MAX_COMPRESSED_OVERHEAD;
 #endif
-        if (b->default_len > len)
+        dflt = b->default_len <= len;
+        if (!dflt)
             len = b->default_len;
-        if ((p = OPENSSL_malloc(len)) == NULL) {
+        if ((p = freelist_extract(s, 1, len, dflt, &b->pooled)) == NULL) {
             /*
              * We've got a malloc failure, and we're still initialising buffers.
              * We assume we're so doomed that we won't even be able to send an
@@ -84,10 +277,11 @@ int ssl3_setup_write_buffer(SSL *s, size_t numwpipes, size_t len)
     size_t align = 0, headerlen;
     SSL3_BUFFER *wb;
     size_t currpipe;
+    int pooled, dflt = len == 0;
 
     s->rlayer.numwpipes = numwpipes;
 
-    if (len == 0) {
+    if (dflt) {
         if (SSL_IS_DTLS(s))
             headerlen = DTLS1_RT_HEADER_LENGTH + 1;
         else
@@ -111,13 +305,11 @@ int ssl3_setup_write_buffer(SSL *s, size_t numwpipes, size_t len)
     for (currpipe = 0; currpipe < numwpipes; currpipe++) {
         SSL3_BUFFER *thiswb = &wb[currpipe];
 
-        if (thiswb->buf != NULL && thiswb->len != len) {
-            OPENSSL_free(thiswb->buf);
-            thiswb->buf = NULL;         /* force reallocation */
-        }
+        if (thiswb->buf != NULL && thiswb->len != len)
+            freelist_insert(s, thiswb, 0); /* force reallocation */
 
         if (thiswb->buf == NULL) {
-            p = OPENSSL_malloc(len);
+            p = freelist_extract(s, 0, len, dflt, &pooled);
             if (p == NULL) {
                 s->rlayer.numwpipes = currpipe;
                 /*
@@ -132,6 +324,7 @@ int ssl3_setup_write_buffer(SSL *s, size_t numwpipes, size_t len)
             memset(thiswb, 0, sizeof(SSL3_BUFFER));
             thiswb->buf = p;
             thiswb->len = len;
+            thiswb->pooled = pooled;
         }
     }
 
@@ -160,8 +353,7 @@ int ssl3_release_write_buffer(SSL *s)
     while (pipes > 0) {
         wb = &RECORD_LAYER_get_wbuf(&s->rlayer)[pipes - 1];
 
-        OPENSSL_free(wb->buf);
-        wb->buf = NULL;
+        freelist_insert(s, wb, 0);
         pipes--;
     }
     s->rlayer.numwpipes = 0;
@@ -173,7 +365,6 @@ int ssl3_release_read_buffer(SSL *s)
     SSL3_BUFFER *b;
 
     b = RECORD_LAYER_get_rbuf(&s->rlayer);
-    OPENSSL_free(b->buf);
-    b->buf = NULL;
+    freelist_insert(s, b, 1);
     return 1;
 }
@@ -491,6 +491,12 @@ int ssl3_get_record(SSL *s)
         return 1;
     }
 
+#ifndef OPENSSL_NO_KTLS
+    /* The kernel has already decrypted and authenticated the record */
+    if (BIO_get_ktls_recv(s->rbio))
+        goto skip_decryption;
+#endif
+
     /*
      * If in encrypt-then-mac mode calculate mac from encrypted record. All
      * the details below are public so no timing details can leak.
@@ -678,6 +684,9 @@ int ssl3_get_record(SSL *s)
         return -1;
     }
 
+#ifndef OPENSSL_NO_KTLS
+ skip_decryption:
+#endif
     for (j = 0; j < num_recs; j++) {
         thisrr = &rr[j];
 
@@ -1862,6 +1871,17 @@ int dtls1_get_record(SSL *s)
     /* check if we have the header */
     if ((RECORD_LAYER_get_rstate(&s->rlayer) != SSL_ST_READ_BODY) ||
         (RECORD_LAYER_get_packet_length(&s->rlayer) < DTLS1_RT_HEADER_LENGTH)) {
+        /*
+         * A batching datagram BIO holds on to what we wrote until it is
+         * flushed.  Send it now if we may have to wait for the peer.
+         * Reads take the datagrams of a batching BIO from the batch it
+         * received last, without a system call, until it is used up.
+         */
+        if (SSL3_BUFFER_get_left(&s->rlayer.rbuf) == 0
+                && BIO_pending(s->rbio) == 0
+                && BIO_dgram_get_batch(s->wbio) > 0)
+            (void)BIO_flush(s->wbio);
+
         rret = ssl3_read_n(s, DTLS1_RT_HEADER_LENGTH,
                            SSL3_BUFFER_get_len(&s->rlayer.rbuf), 0, 1, &n);
         /* read timeout is handled by dtls1_read_bytes */
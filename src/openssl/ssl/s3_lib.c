@@ -4703,6 +4703,9 @@ EVP_PKEY *ssl_generate_pkey_group(SSL *s, uint16_t id)
     const TLS_GROUP_INFO *ginf = tls1_group_id_lookup(id);
     uint16_t gtype;
 
+    if ((pkey = ssl_keyshare_pool_get(s, id)) != NULL)
+        return pkey;
+
     if (ginf == NULL) {
         SSLfatal(s, SSL_AD_INTERNAL_ERROR, SSL_F_SSL_GENERATE_PKEY_GROUP,
                  ERR_R_INTERNAL_ERROR);
@@ -4779,6 +4782,212 @@ EVP_PKEY *ssl_generate_param_group(uint16_t id)
 }
 #endif
 
+/*
+ * Ephemeral keys generated ahead of time, for the groups that handshakes on
+ * an SSL_CTX have asked for.  Handshakes take a key from the pool instead of
+ * generating one while the peer waits; SSL_CTX_fill_keyshare_pool() puts new
+ * ones in, typically from a thread of the application that has nothing more
+ * urgent to do.  Every key is handed out once.
+ */
+static SSL_KEYSHARE_GROUP *keyshare_pool_find(SSL_KEYSHARE_POOL *pool,
+                                              uint16_t id)
+{
+    size_t i;
+
+    for (i = 0; i < pool->num_groups; i++)
+        if (pool->groups[i].group_id == id)
+            return &pool->groups[i];
+    return NULL;
+}
+
+static void keyshare_pool_trim(SSL_KEYSHARE_GROUP *grp, size_t max_len)
+{
+    while (grp->len > max_len)
+        EVP_PKEY_free(grp->keys[--grp->len]);
+}
+
+/*
+ * Take a key for group |id| from the pool of |s|, or return NULL if there is
+ * none.  The group is added to the pool the first time it is asked for.
+ */
+EVP_PKEY *ssl_keyshare_pool_get(SSL *s, uint16_t id)
+{
+    SSL_KEYSHARE_POOL *pool;
+    SSL_KEYSHARE_GROUP *grp;
+    EVP_PKEY **keys;
+    EVP_PKEY *pkey = NULL;
+
+    /* session_ctx does not change under SSL_set_SSL_CTX() */
+    if (s->session_ctx == NULL
+            || (pool = s->session_ctx->keyshare_pool) == NULL)
+        return NULL;
+
+    CRYPTO_THREAD_write_lock(pool->lock);
+    if ((grp = keyshare_pool_find(pool, id)) != NULL && grp->len > 0) {
+        pkey = grp->keys[--grp->len];
+        pool->hits++;
+    } else {
+        pool->misses++;
+        if (grp == NULL && pool->max_len > 0
+                && pool->num_groups < OSSL_NELEM(pool->groups)
+                && (keys = OPENSSL_malloc(pool->max_len
+                                          * sizeof(*keys))) != NULL) {
+            grp = &pool->groups[pool->num_groups++];
+            grp->group_id = id;
+            grp->keys = keys;
+        }
+    }
+    CRYPTO_THREAD_unlock(pool->lock);
+    return pkey;
+}
+
+/*
+ * Keys are generated this many at a time, which lets X25519 compute their
+ * public halves side by side.
+ */
+#define KEYSHARE_POOL_BATCH     8
+
+int SSL_CTX_fill_keyshare_pool(SSL_CTX *ctx, int max)
+{
+    SSL_KEYSHARE_POOL *pool = ctx->keyshare_pool;
+    SSL_KEYSHARE_GROUP *grp;
+    EVP_PKEY *params, *keys[KEYSHARE_POOL_BATCH];
+    EVP_PKEY_CTX *pctx = NULL;
+    uint16_t id = 0;
+    size_t i, need;
+    int num = 0;
+
+    if (pool == NULL)
+        return 0;
+
+    while (max <= 0 || num < max) {
+        /* Top up the group that is furthest from full */
+        CRYPTO_THREAD_read_lock(pool->lock);
+        for (i = 0, need = 0; i < pool->num_groups; i++) {
+            if (pool->max_len - pool->groups[i].len > need) {
+                need = pool->max_len - pool->groups[i].len;
+                id = pool->groups[i].group_id;
+            }
+        }
+        CRYPTO_THREAD_unlock(pool->lock);
+        if (need == 0)
+            break;
+        if (need > KEYSHARE_POOL_BATCH)
+            need = KEYSHARE_POOL_BATCH;
+        if (max > 0 && need > (size_t)(max - num))
+            need = max - num;
+
+#ifndef OPENSSL_NO_EC
+        params = ssl_generate_param_group(id);
+#else
+        params = NULL;
+#endif
+        if (params != NULL)
+            pctx = EVP_PKEY_CTX_new(params, NULL);
+        EVP_PKEY_free(params);
+        if (pctx == NULL
+                || EVP_PKEY_keygen_init(pctx) <= 0
+                || EVP_PKEY_keygen_multi(pctx, keys, need) <= 0) {
+            EVP_PKEY_CTX_free(pctx);
+            SSLerr(SSL_F_SSL_CTX_FILL_KEYSHARE_POOL, ERR_R_EVP_LIB);
+            return -1;
+        }
+        EVP_PKEY_CTX_free(pctx);
+        pctx = NULL;
+
+        CRYPTO_THREAD_write_lock(pool->lock);
+        grp = keyshare_pool_find(pool, id);
+        for (i = 0; i < need && grp != NULL && grp->len < pool->max_len;
+             i++) {
+            grp->keys[grp->len++] = keys[i];
+            keys[i] = NULL;
+        }
+        CRYPTO_THREAD_unlock(pool->lock);
+        for (i = 0; i < need; i++)
+            EVP_PKEY_free(keys[i]);
+        num += (int)need;
+    }
+    return num;
+}
+
+/*
+ * Keep up to |size| keys for each group in the pool of |ctx|, creating the
+ * pool on first use.
+ */
+int ssl_keyshare_pool_set_size(SSL_CTX *ctx, size_t size)
+{
+    SSL_KEYSHARE_POOL *pool = ctx->keyshare_pool;
+    EVP_PKEY **keys;
+    size_t i;
+    int ret = 1;
+
+    if (pool == NULL) {
+        if (size == 0)
+            return 1;
+        if ((pool = OPENSSL_zalloc(sizeof(*pool))) == NULL
+                || (pool->lock = CRYPTO_THREAD_lock_new()) == NULL) {
+            OPENSSL_free(pool);
+            SSLerr(SSL_F_SSL_KEYSHARE_POOL_SET_SIZE, ERR_R_MALLOC_FAILURE);
+            return 0;
+        }
+        ctx->keyshare_pool = pool;
+    }
+
+    CRYPTO_THREAD_write_lock(pool->lock);
+    for (i = 0; i < pool->num_groups; i++) {
+        keyshare_pool_trim(&pool->groups[i], size);
+        if (size > pool->max_len) {
+            keys = OPENSSL_realloc(pool->groups[i].keys,
+                                   size * sizeof(*keys));
+            if (keys == NULL) {
+                SSLerr(SSL_F_SSL_KEYSHARE_POOL_SET_SIZE, ERR_R_MALLOC_FAILURE);
+                ret = 0;
+                break;
+            }
+            pool->groups[i].keys = keys;
+        }
+    }
+    if (ret)
+        pool->max_len = size;
+    CRYPTO_THREAD_unlock(pool->lock);
+    return ret;
+}
+
+long ssl_keyshare_pool_get_stat(SSL_CTX *ctx, int cmd)
+{
+    SSL_KEYSHARE_POOL *pool = ctx->keyshare_pool;
+    size_t ret = 0;
+
+    if (pool == NULL)
+        return 0;
+
+    CRYPTO_THREAD_read_lock(pool->lock);
+    switch (cmd) {
+    case SSL_CTRL_KEYSHARE_POOL_HITS:
+        ret = pool->hits;
+        break;
+    case SSL_CTRL_KEYSHARE_POOL_MISSES:
+        ret = pool->misses;
+        break;
+    }
+    CRYPTO_THREAD_unlock(pool->lock);
+    return (long)ret;
+}
+
+void ssl_keyshare_pool_free(SSL_KEYSHARE_POOL *pool)
+{
+    size_t i;
+
+    if (pool == NULL)
+        return;
+    for (i = 0; i < pool->num_groups; i++) {
+        keyshare_pool_trim(&pool->groups[i], 0);
+        OPENSSL_free(pool->groups[i].keys);
+    }
+    CRYPTO_THREAD_lock_free(pool->lock);
+    OPENSSL_free(pool);
+}
+
 /* Derive secrets for ECDH/DH */
 int ssl_derive(SSL *s, EVP_PKEY *privkey, EVP_PKEY *pubkey, int gensecret)
 {
@@ -360,6 +360,332 @@ void ssl_cert_set_cert_cb(CERT *c, int (*cb) (SSL *ssl, void *arg), void *arg)
     c->cert_cb_arg = arg;
 }
 
+static unsigned long cert_cache_hash(const SSL_CERT_CACHE_ENTRY *e)
+{
+    return e->hash;
+}
+
+static int cert_cache_cmp(const SSL_CERT_CACHE_ENTRY *a,
+                          const SSL_CERT_CACHE_ENTRY *b)
+{
+    if (a->hash != b->hash)
+        return a->hash < b->hash ? -1 : 1;
+    if (a->derlen != b->derlen)
+        return a->derlen < b->derlen ? -1 : 1;
+    return memcmp(a->der, b->der, a->derlen);
+}
+
+static unsigned long cert_der_hash(const unsigned char *der, size_t len)
+{
+    unsigned long h = 2166136261UL;
+    size_t i;
+
+    for (i = 0; i < len; i++)
+        h = ((h ^ der[i]) * 16777619UL) & 0xffffffffUL;
+    return h;
+}
+
+static void cert_cache_entry_free(SSL_CERT_CACHE_ENTRY *e)
+{
+    if (e == NULL)
+        return;
+    X509_free(e->x);
+    OPENSSL_free(e->der);
+    OPENSSL_free(e);
+}
+
+void ssl_cert_cache_free(SSL_CERT_CACHE *cache)
+{
+    size_t i;
+
+    if (cache == NULL)
+        return;
+    for (i = 0; i < cache->size; i++)
+        cert_cache_entry_free(cache->ring[i]);
+    OPENSSL_free(cache->ring);
+    lh_SSL_CERT_CACHE_ENTRY_free(cache->entries);
+    CRYPTO_THREAD_lock_free(cache->lock);
+    OPENSSL_free(cache);
+}
+
+/*
+ * Replace the peer certificate cache of |ctx| by an empty one holding up to
+ * |size| certificates, or remove it if |size| is zero.
+ */
+int ssl_cert_cache_set_size(SSL_CTX *ctx, size_t size)
+{
+    SSL_CERT_CACHE *cache = NULL;
+
+    if (size > 0) {
+        if ((cache = OPENSSL_zalloc(sizeof(*cache))) == NULL
+            || (cache->ring = OPENSSL_zalloc(size * sizeof(*cache->ring)))
+               == NULL
+            || (cache->entries = lh_SSL_CERT_CACHE_ENTRY_new(cert_cache_hash,
+                                                             cert_cache_cmp))
+               == NULL
+            || (cache->lock = CRYPTO_THREAD_lock_new()) == NULL) {
+            ssl_cert_cache_free(cache);
+            SSLerr(SSL_F_SSL_CERT_CACHE_SET_SIZE, ERR_R_MALLOC_FAILURE);
+            return 0;
+        }
+        cache->size = size;
+    }
+    ssl_cert_cache_free(ctx->peer_cert_cache);
+    ctx->peer_cert_cache = cache;
+    return 1;
+}
+
+/*
+ * Decode a peer certificate of |len| bytes at |*in|, advancing |*in| past
+ * the bytes consumed like d2i_X509() does.  If the SSL_CTX has a peer
+ * certificate cache, a certificate seen before is returned without decoding
+ * it again.  The returned certificate may be shared with other connections.
+ */
+X509 *ssl_cert_decode(SSL *s, const unsigned char **in, size_t len)
+{
+    SSL_CERT_CACHE *cache = s->ctx->peer_cert_cache;
+    SSL_CERT_CACHE_ENTRY tmp, *e, *old;
+    const unsigned char *p = *in;
+    X509 *x;
+
+    if (cache == NULL)
+        return d2i_X509(NULL, in, (long)len);
+
+    tmp.hash = cert_der_hash(p, len);
+    tmp.der = (unsigned char *)p;
+    tmp.derlen = len;
+
+    CRYPTO_THREAD_read_lock(cache->lock);
+    e = lh_SSL_CERT_CACHE_ENTRY_retrieve(cache->entries, &tmp);
+    if (e != NULL) {
+        x = e->x;
+        X509_up_ref(x);
+        CRYPTO_THREAD_unlock(cache->lock);
+        *in = p + len;
+        return x;
+    }
+    CRYPTO_THREAD_unlock(cache->lock);
+
+    x = d2i_X509(NULL, in, (long)len);
+    /* Only cache certificates that span the whole input */
+    if (x == NULL || *in != p + len)
+        return x;
+
+    if ((e = OPENSSL_zalloc(sizeof(*e))) == NULL
+        || (e->der = OPENSSL_memdup(p, len)) == NULL) {
+        /* Caching is best effort */
+        OPENSSL_free(e);
+        return x;
+    }
+    e->hash = tmp.hash;
+    e->derlen = len;
+    X509_up_ref(x);
+    e->x = x;
+
+    CRYPTO_THREAD_write_lock(cache->lock);
+    if (lh_SSL_CERT_CACHE_ENTRY_retrieve(cache->entries, e) != NULL) {
+        /* Another connection cached it first */
+        CRYPTO_THREAD_unlock(cache->lock);
+        cert_cache_entry_free(e);
+        return x;
+    }
+    old = cache->ring[cache->next];
+    if (old != NULL)
+        (void)lh_SSL_CERT_CACHE_ENTRY_delete(cache->entries, old);
+    (void)lh_SSL_CERT_CACHE_ENTRY_insert(cache->entries, e);
+    if (lh_SSL_CERT_CACHE_ENTRY_error(cache->entries)) {
+        cache->ring[cache->next] = NULL;
+        CRYPTO_THREAD_unlock(cache->lock);
+        cert_cache_entry_free(old);
+        cert_cache_entry_free(e);
+        return x;
+    }
+    cache->ring[cache->next] = e;
+    cache->next = (cache->next + 1) % cache->size;
+    CRYPTO_THREAD_unlock(cache->lock);
+    cert_cache_entry_free(old);
+    return x;
+}
+
+#ifndef OPENSSL_NO_COMP
+/* Return the method |ctx| uses for certificate compression |alg|, or NULL */
+COMP_METHOD *ssl_cert_comp_method(const SSL_CTX *ctx, int alg)
+{
+    size_t i;
+
+    for (i = 0; i < ctx->cert_comp.num; i++) {
+        if (ctx->cert_comp.alg[i] == alg)
+            return ctx->cert_comp.meth[i];
+    }
+    return NULL;
+}
+
+static void cert_comp_entry_clear(SSL_CERT_COMP_ENTRY *e)
+{
+    OPENSSL_free(e->raw);
+    OPENSSL_free(e->comp);
+    memset(e, 0, sizeof(*e));
+}
+
+void ssl_cert_comp_cache_free(SSL_CTX *ctx)
+{
+    size_t i;
+
+    for (i = 0; i < SSL_CERT_COMP_CACHE_SIZE; i++)
+        cert_comp_entry_clear(&ctx->cert_comp.cache[i]);
+    ctx->cert_comp.next = 0;
+}
+
+/*
+ * Write the CompressedCertificate message body for the Certificate message
+ * body |raw| to |pkt|, using the algorithm chosen for |s|.  Compressed bodies
+ * are cached in the SSL_CTX so that a server only compresses its chain once.
+ * The uncompressed body is the cache key, so a changed chain, or changed
+ * OCSP or SCT data sent with it, never matches a stale entry.
+ */
+int ssl_cert_comp_output(SSL *s, const unsigned char *raw, size_t rawlen,
+                         WPACKET *pkt)
+{
+    SSL_CTX *ctx = s->ctx;
+    int alg = s->ext.cert_comp_alg;
+    COMP_METHOD *meth = ssl_cert_comp_method(ctx, alg);
+    COMP_CTX *cctx = NULL;
+    SSL_CERT_COMP_ENTRY *e, tmp, old;
+    unsigned char *comp = NULL;
+    size_t i, maxlen;
+    int len, ret = 0;
+
+    if (meth == NULL || rawlen > 0xffffff) {
+        SSLfatal(s, SSL_AD_INTERNAL_ERROR, SSL_F_SSL_CERT_COMP_OUTPUT,
+                 ERR_R_INTERNAL_ERROR);
+        return 0;
+    }
+
+    CRYPTO_THREAD_read_lock(ctx->lock);
+    for (i = 0; i < SSL_CERT_COMP_CACHE_SIZE; i++) {
+        e = &ctx->cert_comp.cache[i];
+        if (e->alg != alg || e->rawlen != rawlen
+                || memcmp(e->raw, raw, rawlen) != 0)
+            continue;
+        ret = WPACKET_put_bytes_u16(pkt, alg)
+              && WPACKET_put_bytes_u24(pkt, rawlen)
+              && WPACKET_sub_memcpy_u24(pkt, e->comp, e->complen);
+        CRYPTO_THREAD_unlock(ctx->lock);
+        if (!ret)
+            SSLfatal(s, SSL_AD_INTERNAL_ERROR, SSL_F_SSL_CERT_COMP_OUTPUT,
+                     ERR_R_INTERNAL_ERROR);
+        return ret;
+    }
+    CRYPTO_THREAD_unlock(ctx->lock);
+
+    /* Enough for any zlib output, even from incompressible input */
+    maxlen = rawlen + rawlen / 8 + 64;
+    if ((comp = OPENSSL_malloc(maxlen)) == NULL
+            || (cctx = COMP_CTX_new(meth)) == NULL) {
+        SSLfatal(s, SSL_AD_INTERNAL_ERROR, SSL_F_SSL_CERT_COMP_OUTPUT,
+                 ERR_R_MALLOC_FAILURE);
+        goto err;
+    }
+    len = COMP_compress_block(cctx, comp, (int)maxlen, (unsigned char *)raw,
+                              (int)rawlen);
+    if (len <= 0) {
+        SSLfatal(s, SSL_AD_INTERNAL_ERROR, SSL_F_SSL_CERT_COMP_OUTPUT,
+                 SSL_R_COMPRESSION_FAILURE);
+        goto err;
+    }
+    if (!WPACKET_put_bytes_u16(pkt, alg)
+            || !WPACKET_put_bytes_u24(pkt, rawlen)
+            || !WPACKET_sub_memcpy_u24(pkt, comp, len)) {
+        SSLfatal(s, SSL_AD_INTERNAL_ERROR, SSL_F_SSL_CERT_COMP_OUTPUT,
+                 ERR_R_INTERNAL_ERROR);
+        goto err;
+    }
+    ret = 1;
+
+    /* Caching is best effort */
+    if ((tmp.raw = OPENSSL_memdup(raw, rawlen)) != NULL) {
+        tmp.alg = alg;
+        tmp.rawlen = rawlen;
+        tmp.comp = comp;
+        tmp.complen = len;
+        comp = NULL;
+
+        CRYPTO_THREAD_write_lock(ctx->lock);
+        e = &ctx->cert_comp.cache[ctx->cert_comp.next];
+        old = *e;
+        *e = tmp;
+        ctx->cert_comp.next = (ctx->cert_comp.next + 1)
+                              % SSL_CERT_COMP_CACHE_SIZE;
+        CRYPTO_THREAD_unlock(ctx->lock);
+        cert_comp_entry_clear(&old);
+    }
+
+ err:
+    OPENSSL_free(comp);
+    COMP_CTX_free(cctx);
+    return ret;
+}
+
+/*
+ * Decompress the CompressedCertificate message body in |pkt| into a newly
+ * allocated Certificate message body of |*outlen| bytes at |*out|.
+ */
+int ssl_cert_comp_expand(SSL *s, PACKET *pkt, unsigned char **out,
+                         size_t *outlen)
+{
+    unsigned int alg;
+    unsigned long rawlen;
+    PACKET comp;
+    COMP_METHOD *meth;
+    COMP_CTX *cctx = NULL;
+    unsigned char *raw = NULL;
+
+    if (!PACKET_get_net_2(pkt, &alg)
+            || !PACKET_get_net_3(pkt, &rawlen)
+            || !PACKET_get_length_prefixed_3(pkt, &comp)
+            || PACKET_remaining(pkt) != 0
+            || PACKET_remaining(&comp) == 0) {
+        SSLfatal(s, SSL_AD_DECODE_ERROR, SSL_F_SSL_CERT_COMP_EXPAND,
+                 SSL_R_LENGTH_MISMATCH);
+        return 0;
+    }
+    /* It must be one of the algorithms we offered */
+    if (!s->ext.cert_comp_sent
+            || (meth = ssl_cert_comp_method(s->ctx, (int)alg)) == NULL) {
+        SSLfatal(s, SSL_AD_ILLEGAL_PARAMETER, SSL_F_SSL_CERT_COMP_EXPAND,
+                 SSL_R_BAD_CERT_COMPRESSION_ALGORITHM);
+        return 0;
+    }
+    if (rawlen == 0 || rawlen > s->max_cert_list) {
+        SSLfatal(s, SSL_AD_BAD_CERTIFICATE, SSL_F_SSL_CERT_COMP_EXPAND,
+                 SSL_R_EXCESSIVE_MESSAGE_SIZE);
+        return 0;
+    }
+
+    if ((raw = OPENSSL_malloc(rawlen)) == NULL
+            || (cctx = COMP_CTX_new(meth)) == NULL) {
+        OPENSSL_free(raw);
+        SSLfatal(s, SSL_AD_INTERNAL_ERROR, SSL_F_SSL_CERT_COMP_EXPAND,
+                 ERR_R_MALLOC_FAILURE);
+        return 0;
+    }
+    if (COMP_expand_block(cctx, raw, (int)rawlen,
+                          (unsigned char *)PACKET_data(&comp),
+                          (int)PACKET_remaining(&comp)) != (int)rawlen) {
+        OPENSSL_free(raw);
+        COMP_CTX_free(cctx);
+        SSLfatal(s, SSL_AD_BAD_CERTIFICATE, SSL_F_SSL_CERT_COMP_EXPAND,
+                 SSL_R_BAD_DECOMPRESSION);
+        return 0;
+    }
+    COMP_CTX_free(cctx);
+
+    *out = raw;
+    *outlen = rawlen;
+    return 1;
+}
+#endif
+
 int ssl_verify_cert_chain(SSL *s, STACK_OF(X509) *sk)
 {
     X509 *x;
@@ -2008,6 +2008,40 @@ int SSL_COMP_add_compression_method(int id, COMP_METHOD *cm)
 }
 #endif
 
+/*
+ * Add certificate compression algorithm |alg| (RFC 8879), implemented by
+ * |meth|, after the ones already added to |ctx|.
+ */
+int SSL_CTX_add_cert_compression_alg(SSL_CTX *ctx, int alg, COMP_METHOD *meth)
+{
+#ifdef OPENSSL_NO_COMP
+    SSLerr(SSL_F_SSL_CTX_ADD_CERT_COMPRESSION_ALG,
+           SSL_R_BAD_CERT_COMPRESSION_ALGORITHM);
+    return 0;
+#else
+    if (alg <= 0 || alg > 0xffff || meth == NULL
+            || COMP_get_type(meth) == NID_undef) {
+        SSLerr(SSL_F_SSL_CTX_ADD_CERT_COMPRESSION_ALG,
+               SSL_R_BAD_CERT_COMPRESSION_ALGORITHM);
+        return 0;
+    }
+    if (ssl_cert_comp_method(ctx, alg) != NULL) {
+        SSLerr(SSL_F_SSL_CTX_ADD_CERT_COMPRESSION_ALG,
+               SSL_R_DUPLICATE_COMPRESSION_ID);
+        return 0;
+    }
+    if (ctx->cert_comp.num == SSL_CERT_COMP_MAX_ALGS) {
+        SSLerr(SSL_F_SSL_CTX_ADD_CERT_COMPRESSION_ALG,
+               SSL_R_TOO_MANY_CERT_COMPRESSION_ALGORITHMS);
+        return 0;
+    }
+    ctx->cert_comp.alg[ctx->cert_comp.num] = alg;
+    ctx->cert_comp.meth[ctx->cert_comp.num] = meth;
+    ctx->cert_comp.num++;
+    return 1;
+#endif
+}
+
 const char *SSL_COMP_get_name(const COMP_METHOD *comp)
 {
 #ifndef OPENSSL_NO_COMP
@@ -22,6 +22,10 @@
 #include <openssl/ct.h>
 #include "internal/cryptlib.h"
 #include "internal/refcount.h"
+#include "internal/ktls.h"
+#if defined(OPENSSL_SYS_UNIX) && !defined(OPENSSL_NO_POSIX_IO)
+# include <unistd.h>
+#endif
 
 const char SSL_version_str[] = OPENSSL_VERSION_TEXT;
 
@@ -1182,13 +1186,15 @@ void SSL_free(SSL *s)
     /* Free up if allocated */
 
     OPENSSL_free(s->ext.hostname);
-    SSL_CTX_free(s->session_ctx);
 #ifndef OPENSSL_NO_EC
     OPENSSL_free(s->ext.ecpointformats);
     OPENSSL_free(s->ext.peer_ecpointformats);
     OPENSSL_free(s->ext.supportedgroups);
     OPENSSL_free(s->ext.peer_supportedgroups);
 #endif                          /* OPENSSL_NO_EC */
+#ifndef OPENSSL_NO_COMP
+    OPENSSL_free(s->ext.peer_cert_comp_algs);
+#endif
     sk_X509_EXTENSION_pop_free(s->ext.ocsp.exts, X509_EXTENSION_free);
 #ifndef OPENSSL_NO_OCSP
     sk_OCSP_RESPID_pop_free(s->ext.ocsp.ids, OCSP_RESPID_free);
@@ -1212,8 +1218,10 @@ void SSL_free(SSL *s)
     if (s->method != NULL)
         s->method->ssl_free(s);
 
+    /* The record buffers go back to the buffer pool of session_ctx */
     RECORD_LAYER_release(&s->rlayer);
 
+    SSL_CTX_free(s->session_ctx);
     SSL_CTX_free(s->ctx);
 
     ASYNC_WAIT_CTX_free(s->waitctx);
@@ -1511,6 +1519,11 @@ int SSL_has_pending(const SSL *s)
     if (RECORD_LAYER_processed_read_pending(&s->rlayer))
         return 1;
 
+    /* Datagrams that a batching read BIO already took off the socket */
+    if (SSL_IS_DTLS(s) && BIO_dgram_get_batch(s->rbio) > 0
+            && BIO_pending(s->rbio) > 0)
+        return 1;
+
     return RECORD_LAYER_read_pending(&s->rlayer);
 }
 
@@ -1913,6 +1926,45 @@ int SSL_peek_ex(SSL *s, void *buf, size_t num, size_t *readbytes)
     return ret;
 }
 
+int SSL_read_view(SSL *s, const unsigned char **data, size_t *len)
+{
+    unsigned char c;
+    size_t readbytes;
+
+    if (SSL_IS_DTLS(s)) {
+        SSLerr(SSL_F_SSL_READ_VIEW, ERR_R_SHOULD_NOT_HAVE_BEEN_CALLED);
+        return 0;
+    }
+
+    /*
+     * Let the record layer do all the usual work (handshake, non-application
+     * records, empty records) until application data is available, without
+     * consuming it.
+     */
+    if (!SSL_peek_ex(s, &c, 1, &readbytes))
+        return 0;
+
+    if (!ssl3_read_view(s, data, len)) {
+        SSLerr(SSL_F_SSL_READ_VIEW, ERR_R_INTERNAL_ERROR);
+        return 0;
+    }
+    return 1;
+}
+
+int SSL_release_view(SSL *s, size_t len)
+{
+    if (SSL_IS_DTLS(s)) {
+        SSLerr(SSL_F_SSL_RELEASE_VIEW, ERR_R_SHOULD_NOT_HAVE_BEEN_CALLED);
+        return 0;
+    }
+
+    if (!ssl3_release_view(s, len)) {
+        SSLerr(SSL_F_SSL_RELEASE_VIEW, SSL_R_BAD_LENGTH);
+        return 0;
+    }
+    return 1;
+}
+
 int ssl_write_internal(SSL *s, const void *buf, size_t num, size_t *written)
 {
     if (s->handshake_func == NULL) {
@@ -1984,6 +2036,104 @@ int SSL_write_ex(SSL *s, const void *buf, size_t num, size_t *written)
     return ret;
 }
 
+ossl_ssize_t SSL_sendfile(SSL *s, int fd, off_t offset, size_t size, int flags)
+{
+    if (s->handshake_func == NULL) {
+        SSLerr(SSL_F_SSL_SENDFILE, SSL_R_UNINITIALIZED);
+        return -1;
+    }
+
+    if (s->shutdown & SSL_SENT_SHUTDOWN) {
+        s->rwstate = SSL_NOTHING;
+        SSLerr(SSL_F_SSL_SENDFILE, SSL_R_PROTOCOL_IS_SHUTDOWN);
+        return -1;
+    }
+
+    if (size > OSSL_SSIZE_MAX)
+        size = OSSL_SSIZE_MAX;
+
+#ifndef OPENSSL_NO_KTLS
+    if (BIO_get_ktls_send(s->wbio)) {
+        ossl_ssize_t ret;
+        int sock;
+
+        /* Records queued by an earlier write have to go out first */
+        if (RECORD_LAYER_write_pending(&s->rlayer)) {
+            SSLerr(SSL_F_SSL_SENDFILE, SSL_R_BAD_WRITE_RETRY);
+            return -1;
+        }
+        if (BIO_get_fd(s->wbio, &sock) < 0) {
+            SSLerr(SSL_F_SSL_SENDFILE, SSL_R_UNINITIALIZED);
+            return -1;
+        }
+
+        s->rwstate = SSL_WRITING;
+        BIO_clear_retry_flags(s->wbio);
+        clear_sys_error();
+        ret = ktls_sendfile(sock, fd, offset, size, flags);
+        if (ret < 0) {
+            if (BIO_sock_should_retry(-1)) {
+                BIO_set_retry_write(s->wbio);
+            } else {
+                SYSerr(SYS_F_SENDFILE, get_last_sys_error());
+                SSLerr(SSL_F_SSL_SENDFILE, ERR_R_SYS_LIB);
+            }
+            return -1;
+        }
+        s->rwstate = SSL_NOTHING;
+        return ret;
+    }
+#endif
+
+#if defined(OPENSSL_SYS_UNIX) && !defined(OPENSSL_NO_POSIX_IO)
+    /*
+     * Without kernel TLS the file contents have to come into user space
+     * anyway, so read them a record at a time and write them the usual way.
+     */
+    {
+        size_t chunk = ssl_get_max_send_fragment(s), total = 0, written;
+        uint32_t mode = s->mode;
+        unsigned char *buf;
+        ssize_t n;
+        int ret = 1;
+
+        if ((buf = OPENSSL_malloc(chunk)) == NULL) {
+            SSLerr(SSL_F_SSL_SENDFILE, ERR_R_MALLOC_FAILURE);
+            return -1;
+        }
+
+        /* A retried write may be handed a different copy of the same data */
+        s->mode |= SSL_MODE_ACCEPT_MOVING_WRITE_BUFFER;
+        while (total < size) {
+            n = pread(fd, buf, size - total < chunk ? size - total : chunk,
+                      offset + (off_t)total);
+            if (n < 0) {
+                SYSerr(SYS_F_FREAD, get_last_sys_error());
+                SSLerr(SSL_F_SSL_SENDFILE, ERR_R_SYS_LIB);
+                ret = -1;
+                break;
+            }
+            if (n == 0)
+                break;
+            ret = ssl_write_internal(s, buf, (size_t)n, &written);
+            if (ret <= 0)
+                break;
+            total += written;
+        }
+        s->mode = (s->mode & ~SSL_MODE_ACCEPT_MOVING_WRITE_BUFFER)
+                  | (mode & SSL_MODE_ACCEPT_MOVING_WRITE_BUFFER);
+        OPENSSL_free(buf);
+
+        if (total > 0)
+            return (ossl_ssize_t)total;
+        return ret <= 0 ? -1 : 0;
+    }
+#else
+    SSLerr(SSL_F_SSL_SENDFILE, ERR_R_SHOULD_NOT_HAVE_BEEN_CALLED);
+    return -1;
+#endif
+}
+
 int SSL_write_early_data(SSL *s, const void *buf, size_t num, size_t *written)
 {
     int ret, early_data_state;
@@ -2375,6 +2525,26 @@ long SSL_CTX_ctrl(SSL_CTX *ctx, int cmd, long larg, void *parg)
             return 0;
         ctx->max_pipelines = larg;
         return 1;
+    case SSL_CTRL_SET_PEER_CERT_CACHE_SIZE:
+        if (larg < 0)
+            return 0;
+        return ssl_cert_cache_set_size(ctx, (size_t)larg);
+    case SSL_CTRL_SET_BUFFER_POOL_SIZE:
+        if (larg < 0)
+            return 0;
+        return ssl_buf_pool_set_size(ctx, (size_t)larg);
+    case SSL_CTRL_BUFFER_POOL_HITS:
+    case SSL_CTRL_BUFFER_POOL_MISSES:
+    case SSL_CTRL_BUFFER_POOL_IN_USE:
+    case SSL_CTRL_BUFFER_POOL_HIGH_WATER:
+        return ssl_buf_pool_get_stat(ctx, cmd);
+    case SSL_CTRL_SET_KEYSHARE_POOL_SIZE:
+        if (larg < 0)
+            return 0;
+        return ssl_keyshare_pool_set_size(ctx, (size_t)larg);
+    case SSL_CTRL_KEYSHARE_POOL_HITS:
+    case SSL_CTRL_KEYSHARE_POOL_MISSES:
+        return ssl_keyshare_pool_get_stat(ctx, cmd);
     case SSL_CTRL_CERT_FLAGS:
         return (ctx->cert->cert_flags |= larg);
     case SSL_CTRL_CLEAR_CERT_FLAGS:
@@ -3200,6 +3370,12 @@ void SSL_CTX_free(SSL_CTX *a)
     sk_X509_NAME_pop_free(a->ca_names, X509_NAME_free);
     sk_X509_NAME_pop_free(a->client_ca_names, X509_NAME_free);
     sk_X509_pop_free(a->extra_certs, X509_free);
+    ssl_cert_cache_free(a->peer_cert_cache);
+#ifndef OPENSSL_NO_COMP
+    ssl_cert_comp_cache_free(a);
+#endif
+    ssl_buf_pool_free(a->buf_pool);
+    ssl_keyshare_pool_free(a->keyshare_pool);
     a->comp_methods = NULL;
 #ifndef OPENSSL_NO_SRTP
     sk_SRTP_PROTECTION_PROFILE_free(a->srtp_profiles);
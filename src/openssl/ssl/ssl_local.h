@@ -724,6 +724,7 @@ typedef enum tlsext_index_en {
     TLSEXT_IDX_cryptopro_bug,
     TLSEXT_IDX_early_data,
     TLSEXT_IDX_certificate_authorities,
+    TLSEXT_IDX_compress_certificate,
     TLSEXT_IDX_padding,
     TLSEXT_IDX_psk,
     /* Dummy index - must always be the last entry */
@@ -734,6 +735,87 @@ DEFINE_LHASH_OF(SSL_SESSION);
 /* Needed in ssl_cert.c */
 DEFINE_LHASH_OF(X509_NAME);
 
+/*
+ * Cache of decoded peer certificates, keyed by their DER encoding.  Entries
+ * are evicted in insertion order once |size| certificates are cached.
+ */
+typedef struct ssl_cert_cache_entry_st {
+    unsigned long hash;
+    unsigned char *der;
+    size_t derlen;
+    X509 *x;
+} SSL_CERT_CACHE_ENTRY;
+
+DEFINE_LHASH_OF(SSL_CERT_CACHE_ENTRY);
+
+typedef struct ssl_cert_cache_st {
+    LHASH_OF(SSL_CERT_CACHE_ENTRY) *entries;
+    SSL_CERT_CACHE_ENTRY **ring;
+    size_t size;
+    size_t next;
+    CRYPTO_RWLOCK *lock;
+} SSL_CERT_CACHE;
+
+/* Free record buffers shared between connections, see ssl3_buffer.c */
+typedef struct ssl_buf_freelist_st {
+    /* size of the buffers on the list */
+    size_t chunklen;
+    /* number of buffers on the list */
+    size_t len;
+    struct ssl_buf_freelist_entry_st *head;
+} SSL_BUF_FREELIST;
+
+typedef struct ssl_buf_pool_st {
+    SSL_BUF_FREELIST rbuf;
+    SSL_BUF_FREELIST wbuf;
+    /* maximum number of buffers kept on each list */
+    size_t max_len;
+    /* statistics */
+    size_t hits;
+    size_t misses;
+    size_t in_use;
+    size_t high_water;
+    CRYPTO_RWLOCK *lock;
+} SSL_BUF_POOL;
+
+/* Groups an SSL_CTX keeps ready-made ephemeral keys for, see s3_lib.c */
+# define SSL_KEYSHARE_POOL_GROUPS    8
+
+typedef struct ssl_keyshare_group_st {
+    uint16_t group_id;
+    /* number of keys in |keys|, which has room for max_len of them */
+    size_t len;
+    EVP_PKEY **keys;
+} SSL_KEYSHARE_GROUP;
+
+typedef struct ssl_keyshare_pool_st {
+    SSL_KEYSHARE_GROUP groups[SSL_KEYSHARE_POOL_GROUPS];
+    size_t num_groups;
+    /* maximum number of keys kept for each group */
+    size_t max_len;
+    /* statistics */
+    size_t hits;
+    size_t misses;
+    CRYPTO_RWLOCK *lock;
+} SSL_KEYSHARE_POOL;
+
+/* Certificate compression (RFC 8879) algorithms an SSL_CTX can offer */
+# define SSL_CERT_COMP_MAX_ALGS      4
+/* Compressed certificate chains an SSL_CTX keeps, see ssl_cert.c */
+# define SSL_CERT_COMP_CACHE_SIZE    SSL_PKEY_NUM
+
+/*
+ * A compressed Certificate message body, keyed by the algorithm and the
+ * uncompressed body it was made from.
+ */
+typedef struct ssl_cert_comp_entry_st {
+    int alg;
+    unsigned char *raw;
+    size_t rawlen;
+    unsigned char *comp;
+    size_t complen;
+} SSL_CERT_COMP_ENTRY;
+
 # define TLSEXT_KEYNAME_LENGTH  16
 # define TLSEXT_TICK_KEY_LENGTH 32
 
@@ -920,6 +1002,26 @@ struct ssl_ctx_st {
     /* The default read buffer length to use (0 means not set) */
     size_t default_read_buf_len;
 
+    /* Decoded peer certificates shared between connections, may be NULL */
+    SSL_CERT_CACHE *peer_cert_cache;
+
+    /* Record buffers shared between connections, may be NULL */
+    SSL_BUF_POOL *buf_pool;
+    /* Pre-generated ephemeral keys, if enabled */
+    SSL_KEYSHARE_POOL *keyshare_pool;
+
+# ifndef OPENSSL_NO_COMP
+    /* Certificate compression algorithms, in order of preference */
+    struct {
+        int alg[SSL_CERT_COMP_MAX_ALGS];
+        COMP_METHOD *meth[SSL_CERT_COMP_MAX_ALGS];
+        size_t num;
+        /* Compressed server certificate chains, protected by |lock| */
+        SSL_CERT_COMP_ENTRY cache[SSL_CERT_COMP_CACHE_SIZE];
+        size_t next;
+    } cert_comp;
+# endif
+
 # ifndef OPENSSL_NO_ENGINE
     /*
      * Engine to pass requests for client certs to
@@ -1316,6 +1418,16 @@ struct ssl_st {
          /* peer's list */
         uint16_t *peer_supportedgroups;
 
+# ifndef OPENSSL_NO_COMP
+        /* Certificate compression algorithms offered by the client */
+        size_t peer_cert_comp_algs_len;
+        uint16_t *peer_cert_comp_algs;
+        /* Algorithm the server compresses its Certificate with, or 0 */
+        int cert_comp_alg;
+        /* Whether the client offered certificate compression */
+        int cert_comp_sent;
+# endif
+
         /* TLS Session Ticket extension override */
         TLS_SESSION_TICKET_EXT *session_ticket;
         /* TLS Session Ticket extension callback */
@@ -2308,6 +2420,24 @@ __owur int ssl_cert_set_current(CERT *c, long arg);
 void ssl_cert_set_cert_cb(CERT *c, int (*cb) (SSL *ssl, void *arg), void *arg);
 
 __owur int ssl_verify_cert_chain(SSL *s, STACK_OF(X509) *sk);
+__owur int ssl_cert_cache_set_size(SSL_CTX *ctx, size_t size);
+void ssl_cert_cache_free(SSL_CERT_CACHE *cache);
+__owur int ssl_buf_pool_set_size(SSL_CTX *ctx, size_t size);
+long ssl_buf_pool_get_stat(SSL_CTX *ctx, int cmd);
+void ssl_buf_pool_free(SSL_BUF_POOL *pool);
+__owur EVP_PKEY *ssl_keyshare_pool_get(SSL *s, uint16_t id);
+__owur int ssl_keyshare_pool_set_size(SSL_CTX *ctx, size_t size);
+long ssl_keyshare_pool_get_stat(SSL_CTX *ctx, int cmd);
+void ssl_keyshare_pool_free(SSL_KEYSHARE_POOL *pool);
+__owur X509 *ssl_cert_decode(SSL *s, const unsigned char **in, size_t len);
+# ifndef OPENSSL_NO_COMP
+__owur COMP_METHOD *ssl_cert_comp_method(const SSL_CTX *ctx, int alg);
+__owur int ssl_cert_comp_output(SSL *s, const unsigned char *raw,
+                                size_t rawlen, WPACKET *pkt);
+__owur int ssl_cert_comp_expand(SSL *s, PACKET *pkt, unsigned char **out,
+                                size_t *outlen);
+void ssl_cert_comp_cache_free(SSL_CTX *ctx);
+# endif
 __owur int ssl_build_cert_chain(SSL *s, SSL_CTX *ctx, int flags);
 __owur int ssl_cert_set_cert_store(CERT *c, X509_STORE *store, int chain,
                                    int ref);
@@ -46,6 +46,9 @@ static int init_etm(SSL *s, unsigned int context);
 static int init_ems(SSL *s, unsigned int context);
 static int final_ems(SSL *s, unsigned int context, int sent);
 static int init_psk_kex_modes(SSL *s, unsigned int context);
+#ifndef OPENSSL_NO_COMP
+static int init_compress_certificate(SSL *s, unsigned int context);
+#endif
 #ifndef OPENSSL_NO_EC
 static int final_key_share(SSL *s, unsigned int context, int sent);
 #endif
@@ -373,6 +376,18 @@ static const EXTENSION_DEFINITION ext_defs[] = {
         tls_construct_certificate_authorities,
         tls_construct_certificate_authorities, NULL,
     },
+#ifndef OPENSSL_NO_COMP
+    {
+        TLSEXT_TYPE_compress_certificate,
+        SSL_EXT_CLIENT_HELLO | SSL_EXT_TLS_IMPLEMENTATION_ONLY
+        | SSL_EXT_TLS1_3_ONLY,
+        init_compress_certificate,
+        tls_parse_ctos_compress_certificate, NULL,
+        NULL, tls_construct_ctos_compress_certificate, NULL
+    },
+#else
+    INVALID_EXTENSION,
+#endif
     {
         /* Must be immediately before pre_shared_key */
         TLSEXT_TYPE_padding,
@@ -1192,6 +1207,17 @@ static int final_ems(SSL *s, unsigned int context, int sent)
     return 1;
 }
 
+#ifndef OPENSSL_NO_COMP
+static int init_compress_certificate(SSL *s, unsigned int context)
+{
+    OPENSSL_free(s->ext.peer_cert_comp_algs);
+    s->ext.peer_cert_comp_algs = NULL;
+    s->ext.peer_cert_comp_algs_len = 0;
+    s->ext.cert_comp_alg = 0;
+    return 1;
+}
+#endif
+
 static int init_certificate_authorities(SSL *s, unsigned int context)
 {
     sk_X509_NAME_pop_free(s->s3->tmp.peer_ca_names, X509_NAME_free);
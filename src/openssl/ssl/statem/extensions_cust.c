@@ -524,6 +524,9 @@ int SSL_extension_supported(unsigned int ext_type)
     case TLSEXT_TYPE_cookie:
     case TLSEXT_TYPE_early_data:
     case TLSEXT_TYPE_certificate_authorities:
+#ifndef OPENSSL_NO_COMP
+    case TLSEXT_TYPE_compress_certificate:
+#endif
     case TLSEXT_TYPE_psk:
     case TLSEXT_TYPE_post_handshake_auth:
         return 1;
@@ -1303,6 +1303,35 @@ int tls_parse_ctos_post_handshake_auth(SSL *s, PACKET *pkt, unsigned int context
     return 1;
 }
 
+#ifndef OPENSSL_NO_COMP
+int tls_parse_ctos_compress_certificate(SSL *s, PACKET *pkt,
+                                        unsigned int context, X509 *x,
+                                        size_t chainidx)
+{
+    PACKET algs;
+
+    /* Each algorithm is 2 bytes and we must have at least 1. */
+    if (!PACKET_as_length_prefixed_1(pkt, &algs)
+            || PACKET_remaining(&algs) == 0
+            || (PACKET_remaining(&algs) % 2) != 0) {
+        SSLfatal(s, SSL_AD_DECODE_ERROR,
+                 SSL_F_TLS_PARSE_CTOS_COMPRESS_CERTIFICATE,
+                 SSL_R_BAD_EXTENSION);
+        return 0;
+    }
+
+    if (!tls1_save_u16(&algs, &s->ext.peer_cert_comp_algs,
+                       &s->ext.peer_cert_comp_algs_len)) {
+        SSLfatal(s, SSL_AD_INTERNAL_ERROR,
+                 SSL_F_TLS_PARSE_CTOS_COMPRESS_CERTIFICATE,
+                 ERR_R_INTERNAL_ERROR);
+        return 0;
+    }
+
+    return 1;
+}
+#endif
+
 /*
  * Add the server's renegotiation binding
  */
@@ -1723,7 +1752,9 @@ EXT_RETURN tls_construct_stoc_key_share(SSL *s, WPACKET *pkt,
         return EXT_RETURN_FAIL;
     }
 
-    skey = ssl_generate_pkey(ckey);
+    skey = ssl_keyshare_pool_get(s, s->s3->group_id);
+    if (skey == NULL)
+        skey = ssl_generate_pkey(ckey);
     if (skey == NULL) {
         SSLfatal(s, SSL_AD_INTERNAL_ERROR, SSL_F_TLS_CONSTRUCT_STOC_KEY_SHARE,
                  ERR_R_MALLOC_FAILURE);
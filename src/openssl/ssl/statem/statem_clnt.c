@@ -73,6 +73,19 @@ static int key_exchange_expected(SSL *s)
     return 0;
 }
 
+/*
+ * Is |mt| a CompressedCertificate message we can accept in place of a
+ * Certificate message?
+ */
+static int tls13_compressed_certificate_expected(SSL *s, int mt)
+{
+#ifndef OPENSSL_NO_COMP
+    return mt == SSL3_MT_COMPRESSED_CERTIFICATE && s->ext.cert_comp_sent;
+#else
+    return 0;
+#endif
+}
+
 /*
  * ossl_statem_client_read_transition() encapsulates the logic for the allowed
  * handshake state transitions when a TLS1.3 client is reading messages from the
@@ -125,7 +138,8 @@ static int ossl_statem_client13_read_transition(SSL *s, int mt)
                 st->hand_state = TLS_ST_CR_CERT_REQ;
                 return 1;
             }
-            if (mt == SSL3_MT_CERTIFICATE) {
+            if (mt == SSL3_MT_CERTIFICATE
+                    || tls13_compressed_certificate_expected(s, mt)) {
                 st->hand_state = TLS_ST_CR_CERT;
                 return 1;
             }
@@ -133,7 +147,8 @@ static int ossl_statem_client13_read_transition(SSL *s, int mt)
         break;
 
     case TLS_ST_CR_CERT_REQ:
-        if (mt == SSL3_MT_CERTIFICATE) {
+        if (mt == SSL3_MT_CERTIFICATE
+                || tls13_compressed_certificate_expected(s, mt)) {
             st->hand_state = TLS_ST_CR_CERT;
             return 1;
         }
@@ -1823,6 +1838,11 @@ MSG_PROCESS_RETURN tls_process_server_certificate(SSL *s, PACKET *pkt)
     size_t chainidx, certidx;
     unsigned int context = 0;
     const SSL_CERT_LOOKUP *clu;
+#ifndef OPENSSL_NO_COMP
+    PACKET rawpkt;
+    unsigned char *raw = NULL;
+    size_t rawlen;
+#endif
 
     if ((sk = sk_X509_new_null()) == NULL) {
         SSLfatal(s, SSL_AD_INTERNAL_ERROR, SSL_F_TLS_PROCESS_SERVER_CERTIFICATE,
@@ -1830,6 +1850,23 @@ MSG_PROCESS_RETURN tls_process_server_certificate(SSL *s, PACKET *pkt)
         goto err;
     }
 
+#ifndef OPENSSL_NO_COMP
+    /* Process a CompressedCertificate as the Certificate it contains */
+    if (s->s3->tmp.message_type == SSL3_MT_COMPRESSED_CERTIFICATE) {
+        if (!ssl_cert_comp_expand(s, pkt, &raw, &rawlen)) {
+            /* SSLfatal() already called */
+            goto err;
+        }
+        if (!PACKET_buf_init(&rawpkt, raw, rawlen)) {
+            SSLfatal(s, SSL_AD_INTERNAL_ERROR,
+                     SSL_F_TLS_PROCESS_SERVER_CERTIFICATE,
+                     ERR_R_INTERNAL_ERROR);
+            goto err;
+        }
+        pkt = &rawpkt;
+    }
+#endif
+
     if ((SSL_IS_TLS13(s) && !PACKET_get_1(pkt, &context))
             || context != 0
             || !PACKET_get_net_3(pkt, &cert_list_len)
@@ -1849,7 +1886,7 @@ MSG_PROCESS_RETURN tls_process_server_certificate(SSL *s, PACKET *pkt)
         }
 
         certstart = certbytes;
-        x = d2i_X509(NULL, (const unsigned char **)&certbytes, cert_len);
+        x = ssl_cert_decode(s, &certbytes, cert_len);
         if (x == NULL) {
             SSLfatal(s, SSL_AD_BAD_CERTIFICATE,
                      SSL_F_TLS_PROCESS_SERVER_CERTIFICATE, ERR_R_ASN1_LIB);
@@ -1982,6 +2019,9 @@ MSG_PROCESS_RETURN tls_process_server_certificate(SSL *s, PACKET *pkt)
  err:
     X509_free(x);
     sk_X509_pop_free(sk, X509_free);
+#ifndef OPENSSL_NO_COMP
+    OPENSSL_free(raw);
+#endif
     return ret;
 }
 
@@ -42,6 +42,9 @@ ASN1_SEQUENCE(GOST_KX_MESSAGE) = {
 IMPLEMENT_ASN1_FUNCTIONS(GOST_KX_MESSAGE)
 
 static int tls_construct_encrypted_extensions(SSL *s, WPACKET *pkt);
+#ifndef OPENSSL_NO_COMP
+static int tls_choose_cert_comp_alg(SSL *s);
+#endif
 
 /*
  * ossl_statem_server13_read_transition() encapsulates the logic for the allowed
@@ -1055,6 +1058,10 @@ int ossl_statem_server_construct_message(SSL *s, WPACKET *pkt,
     case TLS_ST_SW_CERT:
         *confunc = tls_construct_server_certificate;
         *mt = SSL3_MT_CERTIFICATE;
+#ifndef OPENSSL_NO_COMP
+        if (tls_choose_cert_comp_alg(s))
+            *mt = SSL3_MT_COMPRESSED_CERTIFICATE;
+#endif
         break;
 
     case TLS_ST_SW_CERT_VRFY:
@@ -3629,7 +3636,7 @@ MSG_PROCESS_RETURN tls_process_client_certificate(SSL *s, PACKET *pkt)
         }
 
         certstart = certbytes;
-        x = d2i_X509(NULL, (const unsigned char **)&certbytes, l);
+        x = ssl_cert_decode(s, &certbytes, l);
         if (x == NULL) {
             SSLfatal(s, SSL_AD_DECODE_ERROR,
                      SSL_F_TLS_PROCESS_CLIENT_CERTIFICATE, ERR_R_ASN1_LIB);
@@ -3780,6 +3787,78 @@ MSG_PROCESS_RETURN tls_process_client_certificate(SSL *s, PACKET *pkt)
     return ret;
 }
 
+#ifndef OPENSSL_NO_COMP
+/*
+ * Pick the certificate compression algorithm for the server Certificate
+ * message: our most preferred one that the client offered, if any.  This is
+ * done just before the message is sent since the SSL_CTX may have been
+ * switched after the ClientHello was parsed.
+ */
+static int tls_choose_cert_comp_alg(SSL *s)
+{
+    size_t i, j;
+
+    s->ext.cert_comp_alg = 0;
+    if (!SSL_IS_TLS13(s))
+        return 0;
+    for (i = 0; i < s->ctx->cert_comp.num; i++) {
+        for (j = 0; j < s->ext.peer_cert_comp_algs_len; j++) {
+            if (s->ext.peer_cert_comp_algs[j] == s->ctx->cert_comp.alg[i]) {
+                s->ext.cert_comp_alg = s->ctx->cert_comp.alg[i];
+                return 1;
+            }
+        }
+    }
+    return 0;
+}
+
+static int tls_construct_compressed_certificate(SSL *s, WPACKET *pkt,
+                                                CERT_PKEY *cpk)
+{
+    BUF_MEM *buf;
+    WPACKET tmppkt;
+    size_t rawlen;
+    int ret = 0;
+
+    if ((buf = BUF_MEM_new()) == NULL || !WPACKET_init(&tmppkt, buf)) {
+        BUF_MEM_free(buf);
+        SSLfatal(s, SSL_AD_INTERNAL_ERROR,
+                 SSL_F_TLS_CONSTRUCT_COMPRESSED_CERTIFICATE,
+                 ERR_R_MALLOC_FAILURE);
+        return 0;
+    }
+    /* Build the uncompressed Certificate message body first */
+    if (!WPACKET_put_bytes_u8(&tmppkt, 0)) {
+        SSLfatal(s, SSL_AD_INTERNAL_ERROR,
+                 SSL_F_TLS_CONSTRUCT_COMPRESSED_CERTIFICATE,
+                 ERR_R_INTERNAL_ERROR);
+        goto err;
+    }
+    if (!ssl3_output_cert_chain(s, &tmppkt, cpk)) {
+        /* SSLfatal() already called */
+        goto err;
+    }
+    if (!WPACKET_get_total_written(&tmppkt, &rawlen)
+            || !WPACKET_finish(&tmppkt)) {
+        SSLfatal(s, SSL_AD_INTERNAL_ERROR,
+                 SSL_F_TLS_CONSTRUCT_COMPRESSED_CERTIFICATE,
+                 ERR_R_INTERNAL_ERROR);
+        goto err;
+    }
+    if (!ssl_cert_comp_output(s, (unsigned char *)buf->data, rawlen, pkt)) {
+        /* SSLfatal() already called */
+        goto err;
+    }
+    ret = 1;
+
+ err:
+    if (!ret)
+        WPACKET_cleanup(&tmppkt);
+    BUF_MEM_free(buf);
+    return ret;
+}
+#endif
+
 int tls_construct_server_certificate(SSL *s, WPACKET *pkt)
 {
     CERT_PKEY *cpk = s->s3->tmp.cert;
@@ -3790,6 +3869,11 @@ int tls_construct_server_certificate(SSL *s, WPACKET *pkt)
         return 0;
     }
 
+#ifndef OPENSSL_NO_COMP
+    if (s->ext.cert_comp_alg != 0)
+        return tls_construct_compressed_certificate(s, pkt, cpk);
+#endif
+
     /*
      * In TLSv1.3 the certificate chain is always preceded by a 0 length context
      * for the server Certificate message
@@ -14,6 +14,8 @@
 #include <openssl/evp.h>
 #include <openssl/kdf.h>
 #include <openssl/rand.h>
+#include "internal/ktls.h"
+#include "internal/bio.h"
 
 /* seed1 through seed5 are concatenated */
 static int tls1_PRF(SSL *s,
@@ -78,6 +80,83 @@ static int tls1_generate_key_block(SSL *s, unsigned char *km, size_t num)
     return ret;
 }
 
+#ifndef OPENSSL_NO_KTLS
+/*
+ * Try to hand one direction of the record layer to the kernel.  Failure is
+ * not an error: the record layer simply carries on in user space.
+ */
+static void tls1_ktls_start(SSL *s, int which, const EVP_CIPHER *c,
+                            const unsigned char *key,
+                            const unsigned char *iv)
+{
+    struct tls_crypto_info_all info;
+    unsigned char *rec_seq;
+    BIO *bio;
+
+    if ((s->options & SSL_OP_ENABLE_KTLS) == 0
+            || SSL_IS_DTLS(s)
+            || s->version != TLS1_2_VERSION
+            || EVP_CIPHER_mode(c) != EVP_CIPH_GCM_MODE
+            || ssl_get_max_send_fragment(s) != SSL3_RT_MAX_PLAIN_LENGTH)
+        return;
+#ifndef OPENSSL_NO_COMP
+    if (s->compress != NULL || s->expand != NULL)
+        return;
+#endif
+
+    if (which & SSL3_CC_WRITE) {
+        bio = s->wbio;
+        rec_seq = s->rlayer.write_sequence;
+        /* Everything written under the old state must reach the socket */
+        if (bio == NULL || BIO_flush(bio) <= 0)
+            return;
+    } else {
+        bio = s->rbio;
+        rec_seq = s->rlayer.read_sequence;
+        /* Bytes already read from the socket can't be given back */
+        if (bio == NULL || RECORD_LAYER_read_pending(&s->rlayer))
+            return;
+    }
+
+    memset(&info, 0, sizeof(info));
+    switch (EVP_CIPHER_key_length(c)) {
+    case TLS_CIPHER_AES_GCM_128_KEY_SIZE:
+        info.u.gcm128.info.version = TLS_1_2_VERSION;
+        info.u.gcm128.info.cipher_type = TLS_CIPHER_AES_GCM_128;
+        memcpy(info.u.gcm128.key, key, TLS_CIPHER_AES_GCM_128_KEY_SIZE);
+        memcpy(info.u.gcm128.salt, iv, TLS_CIPHER_AES_GCM_128_SALT_SIZE);
+        memcpy(info.u.gcm128.rec_seq, rec_seq,
+               TLS_CIPHER_AES_GCM_128_REC_SEQ_SIZE);
+        if (RAND_bytes(info.u.gcm128.iv, TLS_CIPHER_AES_GCM_128_IV_SIZE) <= 0)
+            goto end;
+        info.tls_crypto_info_len = sizeof(info.u.gcm128);
+        break;
+    case TLS_CIPHER_AES_GCM_256_KEY_SIZE:
+        info.u.gcm256.info.version = TLS_1_2_VERSION;
+        info.u.gcm256.info.cipher_type = TLS_CIPHER_AES_GCM_256;
+        memcpy(info.u.gcm256.key, key, TLS_CIPHER_AES_GCM_256_KEY_SIZE);
+        memcpy(info.u.gcm256.salt, iv, TLS_CIPHER_AES_GCM_256_SALT_SIZE);
+        memcpy(info.u.gcm256.rec_seq, rec_seq,
+               TLS_CIPHER_AES_GCM_256_REC_SEQ_SIZE);
+        if (RAND_bytes(info.u.gcm256.iv, TLS_CIPHER_AES_GCM_256_IV_SIZE) <= 0)
+            goto end;
+        info.tls_crypto_info_len = sizeof(info.u.gcm256);
+        break;
+    default:
+        return;
+    }
+
+    /*
+     * The kernel can't be given new keys, so once it owns the connection
+     * renegotiation has to be refused.
+     */
+    if (BIO_set_ktls(bio, &info, which & SSL3_CC_WRITE))
+        s->options |= SSL_OP_NO_RENEGOTIATION;
+ end:
+    OPENSSL_cleanse(&info, sizeof(info));
+}
+#endif
+
 int tls1_change_cipher_state(SSL *s, int which)
 {
     unsigned char *p, *mac_secret;
@@ -314,6 +393,10 @@ int tls1_change_cipher_state(SSL *s, int which)
     }
     s->statem.enc_write_state = ENC_WRITE_STATE_VALID;
 
+#ifndef OPENSSL_NO_KTLS
+    tls1_ktls_start(s, which, c, key, iv);
+#endif
+
 #ifdef SSL_DEBUG
     printf("which = %04X\nkey=", which);
     {
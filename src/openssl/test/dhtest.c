@@ -679,6 +679,78 @@ static int rfc7919_test(void)
     DH_free(b);
     return ret;
 }
+
+static const struct {
+    int nid;
+    int length;
+} rfc7919_groups[] = {
+    { NID_ffdhe2048, 225 },
+    { NID_ffdhe3072, 275 },
+    { NID_ffdhe4096, 325 },
+    { NID_ffdhe6144, 375 },
+    { NID_ffdhe8192, 400 }
+};
+
+/*
+ * Public keys in the RFC 7919 groups, which use a fixed-base table for
+ * private keys up to the group's exponent length, must match g^x computed
+ * the ordinary way: for generated keys, for private keys at the edges of
+ * the table and for longer ones that cannot use it.
+ */
+static int rfc7919_keygen_test(int idx)
+{
+    DH *dh = NULL;
+    BN_CTX *ctx = NULL;
+    BIGNUM *x = NULL, *y = NULL;
+    const BIGNUM *p, *g, *pub_key, *priv_key;
+    int len = rfc7919_groups[idx].length;
+    int bits[] = { 1, 2, 64, 0, 0, 0, 0 };
+    int i, ret = 0;
+
+    bits[3] = len - 1;
+    bits[4] = len;
+    bits[5] = len + 1;
+    bits[6] = 2 * len;
+
+    if (!TEST_ptr(ctx = BN_CTX_new())
+            || !TEST_ptr(y = BN_new()))
+        goto err;
+
+    for (i = -3; i < (int)OSSL_NELEM(bits); i++) {
+        if (!TEST_ptr(dh = DH_new_by_nid(rfc7919_groups[idx].nid)))
+            goto err;
+        if (i >= 0) {
+            /* x = 2^bits - 1 */
+            if (!TEST_ptr(x = BN_new())
+                    || !TEST_true(BN_set_bit(x, bits[i]))
+                    || !TEST_true(BN_sub_word(x, 1))
+                    || !TEST_true(DH_set0_key(dh, NULL, x))) {
+                BN_free(x);
+                goto err;
+            }
+        }
+        DH_get0_pqg(dh, &p, NULL, &g);
+        if (!TEST_true(DH_generate_key(dh)))
+            goto err;
+        DH_get0_key(dh, &pub_key, &priv_key);
+        if (!TEST_true(BN_mod_exp(y, g, priv_key, p, ctx))
+                || !TEST_BN_eq(y, pub_key)) {
+            TEST_info("private key of %d bits", BN_num_bits(priv_key));
+            goto err;
+        }
+        if (i < 0 && !TEST_int_eq(BN_num_bits(priv_key), len))
+            goto err;
+        DH_free(dh);
+        dh = NULL;
+    }
+
+    ret = 1;
+ err:
+    DH_free(dh);
+    BN_free(y);
+    BN_CTX_free(ctx);
+    return ret;
+}
 #endif
 
 
@@ -690,6 +762,7 @@ int setup_tests(void)
     ADD_TEST(dh_test);
     ADD_TEST(rfc5114_test);
     ADD_TEST(rfc7919_test);
+    ADD_ALL_TESTS(rfc7919_keygen_test, OSSL_NELEM(rfc7919_groups));
 #endif
     return 1;
 }
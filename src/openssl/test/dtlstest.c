@@ -15,6 +15,7 @@
 
 #include "ssltestlib.h"
 #include "testutil.h"
+#include "internal/sockets.h"
 
 static char *cert = NULL;
 static char *privkey = NULL;
@@ -328,6 +329,217 @@ static int test_dtls_duplicate_records(void)
     return testresult;
 }
 
+#if !defined(OPENSSL_NO_SOCK) && !defined(OPENSSL_NO_DGRAM)
+/*
+ * Create two UDP sockets on the loopback interface, and datagram BIOs for
+ * them that send to each other.  The BIOs close the sockets.
+ */
+static int create_dgram_bios(BIO **cbio, BIO **sbio)
+{
+    BIO_ADDRINFO *res = NULL;
+    BIO_ADDR *caddr = NULL, *saddr = NULL;
+    union BIO_sock_info_u info;
+    struct timeval tv;
+    int cfd = INVALID_SOCKET, sfd = INVALID_SOCKET, ret = 0;
+
+    *cbio = *sbio = NULL;
+    tv.tv_sec = 5;
+    tv.tv_usec = 0;
+
+    if (!TEST_true(BIO_lookup_ex("127.0.0.1", "0", BIO_LOOKUP_SERVER,
+                                 AF_INET, SOCK_DGRAM, 0, &res))
+            || !TEST_int_ne(cfd = BIO_socket(AF_INET, SOCK_DGRAM, 0, 0),
+                            INVALID_SOCKET)
+            || !TEST_int_ne(sfd = BIO_socket(AF_INET, SOCK_DGRAM, 0, 0),
+                            INVALID_SOCKET)
+            || !TEST_true(BIO_bind(cfd, BIO_ADDRINFO_address(res), 0))
+            || !TEST_true(BIO_bind(sfd, BIO_ADDRINFO_address(res), 0))
+            || !TEST_ptr(caddr = BIO_ADDR_new())
+            || !TEST_ptr(saddr = BIO_ADDR_new()))
+        goto err;
+    info.addr = caddr;
+    if (!TEST_true(BIO_sock_info(cfd, BIO_SOCK_INFO_ADDRESS, &info)))
+        goto err;
+    info.addr = saddr;
+    if (!TEST_true(BIO_sock_info(sfd, BIO_SOCK_INFO_ADDRESS, &info))
+            || !TEST_ptr(*cbio = BIO_new_dgram(cfd, BIO_CLOSE)))
+        goto err;
+    cfd = INVALID_SOCKET;
+    if (!TEST_ptr(*sbio = BIO_new_dgram(sfd, BIO_CLOSE)))
+        goto err;
+    sfd = INVALID_SOCKET;
+    if (!TEST_true(BIO_dgram_set_peer(*cbio, saddr))
+            || !TEST_true(BIO_dgram_set_peer(*sbio, caddr))
+            || !TEST_int_ge(BIO_ctrl(*cbio, BIO_CTRL_DGRAM_SET_RECV_TIMEOUT,
+                                     0, &tv), 0)
+            || !TEST_int_ge(BIO_ctrl(*sbio, BIO_CTRL_DGRAM_SET_RECV_TIMEOUT,
+                                     0, &tv), 0))
+        goto err;
+    ret = 1;
+
+ err:
+    if (!ret) {
+        BIO_free(*cbio);
+        BIO_free(*sbio);
+        *cbio = *sbio = NULL;
+    }
+    if (cfd != INVALID_SOCKET)
+        BIO_closesocket(cfd);
+    if (sfd != INVALID_SOCKET)
+        BIO_closesocket(sfd);
+    BIO_ADDR_free(caddr);
+    BIO_ADDR_free(saddr);
+    BIO_ADDRINFO_free(res);
+    return ret;
+}
+
+#define BATCH_DGRAMS    11
+
+/* Datagram |i| of the batch test is this long */
+static int batch_dgram_len(int i)
+{
+    if (i < 6)
+        return 100;
+    if (i == 6)
+        return 40;
+    return 300 + i;
+}
+
+/* Test BIO_dgram_set_batch() on its own */
+static int test_dgram_batch(void)
+{
+    BIO *cbio = NULL, *sbio = NULL;
+    unsigned char buf[1024], exp[1024];
+    int i, len, testresult = 0;
+
+    if (!TEST_true(create_dgram_bios(&cbio, &sbio)))
+        goto end;
+    if (BIO_dgram_set_batch(cbio, 8) != 1) {
+        TEST_info("Datagram batching not supported, skipping test");
+        testresult = 1;
+        goto end;
+    }
+    if (!TEST_int_eq(BIO_dgram_get_batch(cbio), 8)
+            || !TEST_false(BIO_dgram_set_batch(cbio, BIO_DGRAM_MAX_BATCH + 1))
+            || !TEST_true(BIO_dgram_set_batch(sbio, 4)))
+        goto end;
+
+    /* Nothing leaves before the queue is full or flushed */
+    for (i = 0; i < BATCH_DGRAMS; i++) {
+        memset(buf, i, sizeof(buf));
+        if (!TEST_int_eq(BIO_write(cbio, buf, batch_dgram_len(i)),
+                         batch_dgram_len(i)))
+            goto end;
+    }
+    if (!TEST_int_eq(BIO_wpending(cbio), 0)
+            || !TEST_int_eq(BIO_flush(cbio), 1))
+        goto end;
+
+    /* Every datagram comes out on its own, in order */
+    for (i = 0; i < BATCH_DGRAMS; i++) {
+        memset(exp, i, sizeof(exp));
+        if (!TEST_int_gt(len = BIO_read(sbio, buf, sizeof(buf)), 0)
+                || !TEST_mem_eq(buf, len, exp, batch_dgram_len(i)))
+            goto end;
+        if (i == 0 && !TEST_int_eq(BIO_pending(sbio), 3 * 100))
+            goto end;
+    }
+    if (!TEST_int_eq(BIO_pending(sbio), 0))
+        goto end;
+
+    /* The reply goes back to where the last datagram came from */
+    if (!TEST_true(BIO_dgram_set_batch(sbio, 0))
+            || !TEST_int_eq(BIO_write(sbio, "reply", 5), 5)
+            || !TEST_int_eq(BIO_read(cbio, buf, sizeof(buf)), 5))
+        goto end;
+
+    testresult = 1;
+ end:
+    BIO_free(cbio);
+    BIO_free(sbio);
+    return testresult;
+}
+
+/*
+ * Test a DTLS connection over batching datagram BIOs.  Records written
+ * without a flush must go out once the writer waits for the peer.
+ */
+static int test_dtls_batch(void)
+{
+    SSL_CTX *sctx = NULL, *cctx = NULL;
+    SSL *serverssl = NULL, *clientssl = NULL;
+    BIO *cbio = NULL, *sbio = NULL;
+    char msg[20], buf[20];
+    size_t written, readbytes;
+    int i, testresult = 0;
+
+    if (!TEST_true(create_dgram_bios(&cbio, &sbio)))
+        goto end;
+    if (BIO_dgram_set_batch(cbio, 8) != 1) {
+        TEST_info("Datagram batching not supported, skipping test");
+        testresult = 1;
+        goto end;
+    }
+    if (!TEST_true(BIO_dgram_set_batch(sbio, 8))
+            || !TEST_true(BIO_socket_nbio(BIO_get_fd(cbio, NULL), 1))
+            || !TEST_true(BIO_socket_nbio(BIO_get_fd(sbio, NULL), 1))
+            || !TEST_true(create_ssl_ctx_pair(DTLS_server_method(),
+                                              DTLS_client_method(),
+                                              DTLS1_VERSION, DTLS_MAX_VERSION,
+                                              &sctx, &cctx, cert, privkey))
+            || !TEST_ptr(serverssl = SSL_new(sctx))
+            || !TEST_ptr(clientssl = SSL_new(cctx)))
+        goto end;
+    SSL_set_bio(serverssl, sbio, sbio);
+    SSL_set_bio(clientssl, cbio, cbio);
+    sbio = cbio = NULL;
+    DTLS_set_timer_cb(clientssl, timer_cb);
+    DTLS_set_timer_cb(serverssl, timer_cb);
+
+    if (!TEST_true(create_ssl_connection(serverssl, clientssl,
+                                         SSL_ERROR_NONE)))
+        goto end;
+
+    for (i = 0; i < 5; i++) {
+        BIO_snprintf(msg, sizeof(msg), "message %d", i);
+        if (!TEST_true(SSL_write_ex(serverssl, msg, strlen(msg), &written)))
+            goto end;
+    }
+
+    /* The server's SSL_read() flushes before it finds nothing to read */
+    if (!TEST_false(SSL_read_ex(serverssl, buf, sizeof(buf), &readbytes))
+            || !TEST_int_eq(SSL_get_error(serverssl, 0), SSL_ERROR_WANT_READ))
+        goto end;
+
+    for (i = 0; i < 5; i++) {
+        BIO_snprintf(msg, sizeof(msg), "message %d", i);
+        if (!TEST_true(SSL_read_ex(clientssl, buf, sizeof(buf), &readbytes))
+                || !TEST_mem_eq(buf, readbytes, msg, strlen(msg)))
+            goto end;
+        /*
+         * The first read took the whole burst off the socket in one go, the
+         * remaining records are read from the batch
+         */
+        if (i == 0 && !TEST_int_lt(recv(SSL_get_fd(clientssl), buf, 1,
+                                        MSG_PEEK), 0))
+            goto end;
+        if (i < 4 && !TEST_true(SSL_has_pending(clientssl)))
+            goto end;
+    }
+
+    testresult = 1;
+ end:
+    SSL_free(serverssl);
+    SSL_free(clientssl);
+    BIO_free(sbio);
+    BIO_free(cbio);
+    SSL_CTX_free(sctx);
+    SSL_CTX_free(cctx);
+
+    return testresult;
+}
+#endif
+
 int setup_tests(void)
 {
     if (!TEST_ptr(cert = test_get_argument(0))
@@ -338,6 +550,10 @@ int setup_tests(void)
     ADD_ALL_TESTS(test_dtls_drop_records, TOTAL_RECORDS);
     ADD_TEST(test_cookie);
     ADD_TEST(test_dtls_duplicate_records);
+#if !defined(OPENSSL_NO_SOCK) && !defined(OPENSSL_NO_DGRAM)
+    ADD_TEST(test_dgram_batch);
+    ADD_TEST(test_dtls_batch);
+#endif
 
     return 1;
 }
@@ -313,6 +313,166 @@ static int test_builtin(int n)
     OPENSSL_free(sig);
     return ret;
 }
+
+# define BATCH_KEYS  4
+# define BATCH_SIGS  24
+
+/* The curves of the keys of a batch, the last one has keys on two curves */
+static const int batch_nids[][BATCH_KEYS] = {
+    { NID_X9_62_prime256v1, NID_X9_62_prime256v1, NID_X9_62_prime256v1,
+      NID_X9_62_prime256v1 },
+    { NID_secp384r1, NID_secp384r1, NID_secp384r1, NID_secp384r1 },
+# ifndef OPENSSL_NO_EC2M
+    { NID_sect233k1, NID_sect233k1, NID_sect233k1, NID_sect233k1 },
+# endif
+    { NID_X9_62_prime256v1, NID_X9_62_prime256v1, NID_X9_62_prime256v1,
+      NID_secp384r1 }
+};
+
+/*
+ * A batch with some bad signatures in it must give for each signature the
+ * same result as verifying it on its own.
+ */
+static int test_verify_batch(int n)
+{
+    EC_KEY *keys[BATCH_KEYS] = { NULL };
+    EC_KEY *eckey[BATCH_SIGS];
+    ECDSA_SIG *sigs[BATCH_SIGS] = { NULL };
+    const ECDSA_SIG *csigs[BATCH_SIGS];
+    unsigned char tbs[BATCH_SIGS][64];
+    const unsigned char *dgst[BATCH_SIGS];
+    int dgst_len[BATCH_SIGS], status[BATCH_SIGS];
+    BIGNUM *r = NULL, *s = NULL;
+    int i, ret = 0;
+
+    for (i = 0; i < BATCH_KEYS; i++)
+        if (!TEST_ptr(keys[i] = EC_KEY_new_by_curve_name(batch_nids[n][i]))
+                || !TEST_true(EC_KEY_generate_key(keys[i])))
+            goto err;
+    if (!TEST_true(RAND_bytes(&tbs[0][0], sizeof(tbs))))
+        goto err;
+    for (i = 0; i < BATCH_SIGS; i++) {
+        eckey[i] = keys[i % BATCH_KEYS];
+        dgst[i] = tbs[i];
+        dgst_len[i] = i == 2 ? 64 : 32;
+        if (!TEST_ptr(sigs[i] = ECDSA_do_sign(dgst[i], dgst_len[i], eckey[i])))
+            goto err;
+        csigs[i] = sigs[i];
+    }
+
+    if (!TEST_int_eq(ECDSA_do_verify_batch(dgst, dgst_len, csigs, eckey,
+                                           BATCH_SIGS, status), 1))
+        goto err;
+    for (i = 0; i < BATCH_SIGS; i++)
+        if (!TEST_int_eq(status[i], 1))
+            goto err;
+
+    /* A changed digest, an out of range s and the wrong key */
+    tbs[5][0] ^= 1;
+    if (!TEST_ptr(r = BN_new())
+            || !TEST_ptr(s = BN_new())
+            || !TEST_ptr(BN_copy(r, ECDSA_SIG_get0_r(sigs[9])))
+            || !TEST_true(ECDSA_SIG_set0(sigs[9], r, s)))
+        goto err;
+    r = s = NULL;
+    eckey[13] = keys[(13 + 1) % BATCH_KEYS];
+    if (!TEST_int_eq(ECDSA_do_verify_batch(dgst, dgst_len, csigs, eckey,
+                                           BATCH_SIGS, status), 0))
+        goto err;
+    for (i = 0; i < BATCH_SIGS; i++) {
+        if (!TEST_int_eq(status[i], i != 5 && i != 9 && i != 13)
+                || !TEST_int_eq(ECDSA_do_verify(dgst[i], dgst_len[i], csigs[i],
+                                                eckey[i]), status[i]))
+            goto err;
+    }
+
+    if (!TEST_int_eq(ECDSA_do_verify_batch(NULL, NULL, NULL, NULL, 0, NULL), 1))
+        goto err;
+
+    ret = 1;
+ err:
+    BN_free(r);
+    BN_free(s);
+    for (i = 0; i < BATCH_KEYS; i++)
+        EC_KEY_free(keys[i]);
+    for (i = 0; i < BATCH_SIGS; i++)
+        ECDSA_SIG_free(sigs[i]);
+    return ret;
+}
+
+static const int precompute_nids[] = {
+    NID_X9_62_prime256v1, NID_secp384r1,
+# ifndef OPENSSL_NO_EC2M
+    NID_sect233k1,
+# endif
+};
+
+/*
+ * Verifications must give the same results before and after the table of
+ * the public key is built, and after the public key is replaced.
+ */
+static int test_pub_precompute(int n)
+{
+    EC_KEY *eckey = NULL, *other = NULL;
+    ECDSA_SIG *sig = NULL, *other_sig = NULL;
+    unsigned char tbs[32], *pub = NULL;
+    size_t publen;
+    int i, ret = 0;
+
+    if (!TEST_true(RAND_bytes(tbs, sizeof(tbs)))
+            || !TEST_ptr(eckey = EC_KEY_new_by_curve_name(precompute_nids[n]))
+            || !TEST_true(EC_KEY_generate_key(eckey))
+            || !TEST_ptr(other = EC_KEY_new_by_curve_name(precompute_nids[n]))
+            || !TEST_true(EC_KEY_generate_key(other))
+            || !TEST_ptr(sig = ECDSA_do_sign(tbs, sizeof(tbs), eckey))
+            || !TEST_ptr(other_sig = ECDSA_do_sign(tbs, sizeof(tbs), other))
+            || !TEST_size_t_gt(publen = EC_KEY_key2buf(eckey,
+                                                POINT_CONVERSION_UNCOMPRESSED,
+                                                &pub, NULL), 0)
+            || !TEST_false(EC_KEY_set_pub_precompute(eckey, -1))
+            || !TEST_true(EC_KEY_set_pub_precompute(eckey, 3))
+            || !TEST_true(EC_KEY_precompute_mult(eckey, NULL)))
+        goto err;
+
+    for (i = 0; i < 6; i++) {
+        if (!TEST_int_eq(ECDSA_do_verify(tbs, sizeof(tbs), sig, eckey), 1)
+                || !TEST_int_eq(ECDSA_do_verify(tbs, sizeof(tbs), other_sig,
+                                                eckey), 0)) {
+            TEST_info("verification %d", i);
+            goto err;
+        }
+    }
+
+    /* Replaced through EC_KEY_set_public_key() */
+    if (!TEST_true(EC_KEY_set_public_key(eckey,
+                                         EC_KEY_get0_public_key(other))))
+        goto err;
+    for (i = 0; i < 6; i++) {
+        if (!TEST_int_eq(ECDSA_do_verify(tbs, sizeof(tbs), other_sig, eckey), 1)
+                || !TEST_int_eq(ECDSA_do_verify(tbs, sizeof(tbs), sig, eckey),
+                                0))
+            goto err;
+    }
+
+    /* Replaced in place, with the table of the old key still there */
+    if (!TEST_true(EC_KEY_set_pub_precompute(other, 1))
+            || !TEST_int_eq(ECDSA_do_verify(tbs, sizeof(tbs), other_sig,
+                                            other), 1)
+            || !TEST_true(EC_KEY_oct2key(other, pub, publen, NULL))
+            || !TEST_int_eq(ECDSA_do_verify(tbs, sizeof(tbs), sig, other), 1)
+            || !TEST_int_eq(ECDSA_do_verify(tbs, sizeof(tbs), other_sig,
+                                            other), 0))
+        goto err;
+
+    ret = 1;
+ err:
+    OPENSSL_free(pub);
+    ECDSA_SIG_free(sig);
+    ECDSA_SIG_free(other_sig);
+    EC_KEY_free(eckey);
+    EC_KEY_free(other);
+    return ret;
+}
 #endif
 
 int setup_tests(void)
@@ -327,6 +487,8 @@ int setup_tests(void)
         return 0;
     ADD_ALL_TESTS(test_builtin, crv_len);
     ADD_ALL_TESTS(x9_62_tests, OSSL_NELEM(ecdsa_cavs_kats));
+    ADD_ALL_TESTS(test_verify_batch, OSSL_NELEM(batch_nids));
+    ADD_ALL_TESTS(test_pub_precompute, OSSL_NELEM(precompute_nids));
 #endif
     return 1;
 }
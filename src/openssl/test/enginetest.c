@@ -348,6 +348,62 @@ static int test_redirect(void)
     OPENSSL_free(tmp);
     return to_return;
 }
+
+static int test_digests(ENGINE *e, const EVP_MD **digest,
+                        const int **nids, int nid)
+{
+    static const int dnid = NID_sha256;
+
+    if (digest == NULL) {
+        *nids = &dnid;
+        return 1;
+    }
+    *digest = nid == NID_sha256 ? EVP_sha256() : NULL;
+    return *digest != NULL;
+}
+
+static int test_digest_select(void)
+{
+    ENGINE *e = NULL, *got = NULL;
+    int i, to_return = 0;
+
+    if (!TEST_ptr_null(ENGINE_get_digest_engine(NID_sha256))
+            || !TEST_ptr(e = ENGINE_new())
+            || !TEST_true(ENGINE_set_id(e, "Test digest engine"))
+            || !TEST_true(ENGINE_set_name(e, "Test digest engine"))
+            || !TEST_true(ENGINE_set_digests(e, test_digests))
+            || !TEST_true(ENGINE_register_digests(e)))
+        goto err;
+
+    /* Repeated lookups keep returning the same functional reference */
+    for (i = 0; i < 3; i++) {
+        if (!TEST_ptr_eq(got = ENGINE_get_digest_engine(NID_sha256), e))
+            goto err;
+        ENGINE_finish(got);
+        got = NULL;
+    }
+    if (!TEST_ptr_null(ENGINE_get_digest_engine(NID_sha1)))
+        goto err;
+
+    /* Changes to the table are seen straight away */
+    ENGINE_unregister_digests(e);
+    if (!TEST_ptr_null(ENGINE_get_digest_engine(NID_sha256))
+            || !TEST_true(ENGINE_set_default_digests(e))
+            || !TEST_ptr_eq(got = ENGINE_get_digest_engine(NID_sha256), e))
+        goto err;
+    ENGINE_finish(got);
+    got = NULL;
+    ENGINE_unregister_digests(e);
+    if (!TEST_ptr_null(ENGINE_get_digest_engine(NID_sha256)))
+        goto err;
+
+    to_return = 1;
+
+ err:
+    ENGINE_finish(got);
+    ENGINE_free(e);
+    return to_return;
+}
 #endif
 
 int global_init(void)
@@ -366,6 +422,7 @@ int setup_tests(void)
 #else
     ADD_TEST(test_engines);
     ADD_TEST(test_redirect);
+    ADD_TEST(test_digest_select);
 #endif
     return 1;
 }
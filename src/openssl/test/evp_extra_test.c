@@ -14,6 +14,7 @@
 #include <openssl/crypto.h>
 #include <openssl/err.h>
 #include <openssl/evp.h>
+#include <openssl/rand.h>
 #include <openssl/rsa.h>
 #include <openssl/x509.h>
 #include <openssl/pem.h>
@@ -1134,6 +1135,119 @@ static int test_decrypt_null_chunks(void)
     EVP_CIPHER_CTX_free(ctx);
     return ret;
 }
+
+/*
+ * Texts longer than the chunks that the cipher and the MAC take turns on must
+ * give the ChaCha20 keystream and Poly1305 tag computed separately, both in
+ * the TLS record mode (|tls| set) and with ordinary updates.
+ */
+static int test_chacha20_poly1305_long(int tls)
+{
+    static const unsigned char zeros[64] = { 0 };
+    unsigned char key[32], nonce[12], iv[16], aad[EVP_AEAD_TLS1_AAD_LEN];
+    unsigned char polykey[64], lens[16], tag[16];
+    unsigned char *pt = NULL, *ct = NULL, *buf = NULL;
+    size_t len = tls ? 15003 : 10007, taglen = sizeof(tag), i;
+    EVP_CIPHER_CTX *ctx = NULL;
+    EVP_MD_CTX *mctx = NULL;
+    EVP_PKEY *mkey = NULL;
+    int outl, tmp, ret = 0;
+
+    for (i = 0; i < sizeof(key); i++)
+        key[i] = (unsigned char)(i + 1);
+    for (i = 0; i < sizeof(nonce); i++)
+        nonce[i] = (unsigned char)(0xa0 + i);
+    /* In TLS mode the nonce is XORed with a zero sequence number */
+    memset(aad, 0, sizeof(aad));
+    aad[8] = 23;
+    aad[9] = 3;
+    aad[10] = 3;
+    aad[11] = (unsigned char)(len >> 8);
+    aad[12] = (unsigned char)len;
+
+    if (!TEST_ptr(pt = OPENSSL_malloc(len))
+            || !TEST_ptr(ct = OPENSSL_malloc(len))
+            || !TEST_ptr(buf = OPENSSL_malloc(len + 16))
+            || !TEST_ptr(ctx = EVP_CIPHER_CTX_new()))
+        goto err;
+    for (i = 0; i < len; i++)
+        pt[i] = (unsigned char)(i * 13 + (i >> 9));
+
+    /* The expected ciphertext and tag, from ChaCha20 and Poly1305 alone */
+    memset(iv, 0, sizeof(iv));
+    memcpy(iv + 4, nonce, sizeof(nonce));
+    if (!TEST_true(EVP_EncryptInit_ex(ctx, EVP_chacha20(), NULL, key, iv))
+            || !TEST_true(EVP_EncryptUpdate(ctx, polykey, &outl, zeros, 64)))
+        goto err;
+    iv[0] = 1;
+    if (!TEST_true(EVP_EncryptInit_ex(ctx, EVP_chacha20(), NULL, key, iv))
+            || !TEST_true(EVP_EncryptUpdate(ctx, ct, &outl, pt, (int)len)))
+        goto err;
+    memset(lens, 0, sizeof(lens));
+    lens[0] = sizeof(aad);
+    lens[8] = (unsigned char)len;
+    lens[9] = (unsigned char)(len >> 8);
+    if (!TEST_ptr(mkey = EVP_PKEY_new_raw_private_key(EVP_PKEY_POLY1305, NULL,
+                                                      polykey, 32))
+            || !TEST_ptr(mctx = EVP_MD_CTX_new())
+            || !TEST_true(EVP_DigestSignInit(mctx, NULL, NULL, NULL, mkey))
+            || !TEST_true(EVP_DigestSignUpdate(mctx, aad, sizeof(aad)))
+            || !TEST_true(EVP_DigestSignUpdate(mctx, zeros,
+                                               16 - sizeof(aad) % 16))
+            || !TEST_true(EVP_DigestSignUpdate(mctx, ct, len))
+            || !TEST_true(EVP_DigestSignUpdate(mctx, zeros, 16 - len % 16))
+            || !TEST_true(EVP_DigestSignUpdate(mctx, lens, sizeof(lens)))
+            || !TEST_true(EVP_DigestSignFinal(mctx, tag, &taglen)))
+        goto err;
+
+    if (!TEST_true(EVP_EncryptInit_ex(ctx, EVP_chacha20_poly1305(), NULL, key,
+                                      nonce)))
+        goto err;
+    if (tls) {
+        memcpy(buf, pt, len);
+        if (!TEST_int_eq(EVP_CIPHER_CTX_ctrl(ctx, EVP_CTRL_AEAD_TLS1_AAD,
+                                             sizeof(aad), aad), 16)
+                || !TEST_int_eq(EVP_Cipher(ctx, buf, buf, len + 16),
+                                (int)len + 16))
+            goto err;
+    } else {
+        if (!TEST_true(EVP_EncryptUpdate(ctx, NULL, &outl, aad, sizeof(aad)))
+                || !TEST_true(EVP_EncryptUpdate(ctx, buf, &outl, pt, (int)len))
+                || !TEST_true(EVP_EncryptFinal_ex(ctx, buf + outl, &tmp))
+                || !TEST_true(EVP_CIPHER_CTX_ctrl(ctx, EVP_CTRL_AEAD_GET_TAG,
+                                                  16, buf + len)))
+            goto err;
+    }
+    if (!TEST_mem_eq(buf, len, ct, len)
+            || !TEST_mem_eq(buf + len, 16, tag, 16))
+        goto err;
+
+    /* Decrypt again in pieces that do not line up with anything */
+    if (!TEST_true(EVP_DecryptInit_ex(ctx, EVP_chacha20_poly1305(), NULL, key,
+                                      nonce))
+            || !TEST_true(EVP_DecryptUpdate(ctx, NULL, &outl, aad,
+                                            sizeof(aad))))
+        goto err;
+    for (i = 0; i < len; i += 1001)
+        if (!TEST_true(EVP_DecryptUpdate(ctx, buf + i, &outl, ct + i,
+                                         (int)(len - i < 1001 ? len - i
+                                                              : 1001))))
+            goto err;
+    if (!TEST_true(EVP_CIPHER_CTX_ctrl(ctx, EVP_CTRL_AEAD_SET_TAG, 16, tag))
+            || !TEST_true(EVP_DecryptFinal_ex(ctx, buf + len, &tmp))
+            || !TEST_mem_eq(buf, len, pt, len))
+        goto err;
+
+    ret = 1;
+ err:
+    EVP_CIPHER_CTX_free(ctx);
+    EVP_MD_CTX_free(mctx);
+    EVP_PKEY_free(mkey);
+    OPENSSL_free(pt);
+    OPENSSL_free(ct);
+    OPENSSL_free(buf);
+    return ret;
+}
 #endif /* !defined(OPENSSL_NO_CHACHA) && !defined(OPENSSL_NO_POLY1305) */
 
 #ifndef OPENSSL_NO_DH
@@ -1173,6 +1287,440 @@ static int test_EVP_PKEY_set1_DH(void)
 }
 #endif
 
+/* Name lookups must see names added and removed after earlier lookups */
+static int test_EVP_get_cipherbyname_update(void)
+{
+    const EVP_CIPHER *aes = EVP_aes_128_cbc();
+    int ret = 0;
+
+    if (!TEST_ptr_eq(EVP_get_cipherbyname("AES-128-CBC"), aes)
+            || !TEST_ptr_eq(EVP_get_cipherbyname("aes128"), aes)
+            || !TEST_ptr_eq(EVP_get_digestbyname("sha256"), EVP_sha256())
+            || !TEST_ptr_null(EVP_get_cipherbyname("test-cipher-alias")))
+        return 0;
+
+    if (!TEST_true(EVP_add_cipher_alias(SN_aes_128_cbc, "test-cipher-alias"))
+            || !TEST_ptr_eq(EVP_get_cipherbyname("TEST-cipher-alias"), aes)
+            || !TEST_str_eq(OBJ_NAME_get("test-cipher-alias",
+                                         OBJ_NAME_TYPE_CIPHER_METH
+                                         | OBJ_NAME_ALIAS),
+                            SN_aes_128_cbc)
+            || !TEST_ptr_null(EVP_get_digestbyname("test-cipher-alias")))
+        goto err;
+
+    ret = 1;
+ err:
+    if (!TEST_true(OBJ_NAME_remove("test-cipher-alias",
+                                   OBJ_NAME_TYPE_CIPHER_METH))
+            || !TEST_ptr_null(EVP_get_cipherbyname("test-cipher-alias")))
+        ret = 0;
+    return ret;
+}
+
+static const EVP_MD *(*digest_multi_mds[])(void) = {
+    EVP_sha1, EVP_sha224, EVP_sha256, EVP_sha512
+};
+
+#define DIGEST_MULTI_NUM    45
+
+/*
+ * Messages of many lengths, including the padding edge cases and a long one
+ * that is finished after all the others, must hash as they do one at a time.
+ */
+static int test_EVP_Digest_multi(int idx)
+{
+    const EVP_MD *md = digest_multi_mds[idx]();
+    static const size_t edges[] = { 0, 1, 55, 56, 63, 64, 65, 119, 120, 128 };
+    const void *data[DIGEST_MULTI_NUM];
+    size_t count[DIGEST_MULTI_NUM];
+    unsigned char *buf = NULL, *out = NULL;
+    unsigned char expected[EVP_MAX_MD_SIZE];
+    size_t i, mdsize = EVP_MD_size(md), buflen = 100000;
+    int ret = 0;
+
+    if (!TEST_ptr(buf = OPENSSL_malloc(buflen))
+            || !TEST_ptr(out = OPENSSL_malloc(DIGEST_MULTI_NUM * mdsize)))
+        goto err;
+    for (i = 0; i < buflen; i++)
+        buf[i] = (unsigned char)(i * 7 + (i >> 8));
+
+    for (i = 0; i < DIGEST_MULTI_NUM; i++) {
+        data[i] = buf + i;
+        if (i < OSSL_NELEM(edges))
+            count[i] = edges[i];
+        else
+            count[i] = (i * 997) % 3000;
+    }
+    count[DIGEST_MULTI_NUM / 2] = buflen - DIGEST_MULTI_NUM;
+
+    if (!TEST_true(EVP_Digest_multi(data, count, DIGEST_MULTI_NUM, out, md,
+                                    NULL)))
+        goto err;
+    for (i = 0; i < DIGEST_MULTI_NUM; i++) {
+        if (!TEST_true(EVP_Digest(data[i], count[i], expected, NULL, md, NULL))
+                || !TEST_mem_eq(out + i * mdsize, mdsize, expected, mdsize)) {
+            TEST_info("message %d of %d bytes", (int)i, (int)count[i]);
+            goto err;
+        }
+    }
+
+    /* A single message and no messages at all */
+    if (!TEST_true(EVP_Digest_multi(data + 3, count + 3, 1, out, md, NULL))
+            || !TEST_true(EVP_Digest(data[3], count[3], expected, NULL, md,
+                                     NULL))
+            || !TEST_mem_eq(out, mdsize, expected, mdsize)
+            || !TEST_true(EVP_Digest_multi(NULL, NULL, 0, NULL, md, NULL)))
+        goto err;
+
+    ret = 1;
+ err:
+    OPENSSL_free(buf);
+    OPENSSL_free(out);
+    return ret;
+}
+
+#ifndef OPENSSL_NO_EC
+# define VERIFY_MULTI_NUM    100
+# define VERIFY_MULTI_KEYS   4
+
+/*
+ * A mix of Ed25519 signatures, more than fit in one batch, and RSA ones with
+ * some bad signatures in between must give for each signature the same
+ * result as verifying it on its own, before and after the table of the
+ * public key of a hot key is built.
+ */
+static int test_EVP_DigestVerify_multi(void)
+{
+    EVP_PKEY *vkeys[VERIFY_MULTI_KEYS] = { NULL };
+    EVP_PKEY_CTX *kctx = NULL;
+    EVP_MD_CTX *ctx = NULL;
+    EVP_PKEY *pkey[VERIFY_MULTI_NUM];
+    unsigned char msg[VERIFY_MULTI_NUM][48], *sigs = NULL;
+    const unsigned char *sig[VERIFY_MULTI_NUM], *tbs[VERIFY_MULTI_NUM];
+    size_t siglen[VERIFY_MULTI_NUM], tbslen[VERIFY_MULTI_NUM];
+    int status[VERIFY_MULTI_NUM];
+    int i, pass, ret = 0;
+
+    if (!TEST_ptr(vkeys[0] = load_example_rsa_key())
+            || !TEST_ptr(kctx = EVP_PKEY_CTX_new_id(EVP_PKEY_ED25519, NULL))
+            || !TEST_int_gt(EVP_PKEY_keygen_init(kctx), 0))
+        goto err;
+    for (i = 1; i < VERIFY_MULTI_KEYS; i++)
+        if (!TEST_int_gt(EVP_PKEY_keygen(kctx, &vkeys[i]), 0))
+            goto err;
+    if (!TEST_false(EVP_PKEY_set_pub_precompute(vkeys[1], -1))
+            || !TEST_true(EVP_PKEY_set_pub_precompute(vkeys[1], 2))
+            || !TEST_true(RAND_bytes(&msg[0][0], sizeof(msg)))
+            || !TEST_ptr(sigs = OPENSSL_malloc(VERIFY_MULTI_NUM * 128))
+            || !TEST_ptr(ctx = EVP_MD_CTX_new()))
+        goto err;
+
+    for (i = 0; i < VERIFY_MULTI_NUM; i++) {
+        pkey[i] = vkeys[i % 10 == 0 ? 0 : 1 + i % (VERIFY_MULTI_KEYS - 1)];
+        sig[i] = sigs + i * 128;
+        siglen[i] = 128;
+        tbs[i] = msg[i];
+        tbslen[i] = i % sizeof(msg[0]);
+        if (!TEST_int_gt(EVP_DigestSignInit(ctx, NULL, NULL, NULL, pkey[i]), 0)
+                || !TEST_int_gt(EVP_DigestSign(ctx, sigs + i * 128, &siglen[i],
+                                               tbs[i], tbslen[i]), 0)
+                || !TEST_true(EVP_MD_CTX_reset(ctx)))
+            goto err;
+    }
+
+    if (!TEST_int_eq(EVP_DigestVerify_multi(pkey, sig, siglen, tbs, tbslen,
+                                            VERIFY_MULTI_NUM, status), 1))
+        goto err;
+    for (i = 0; i < VERIFY_MULTI_NUM; i++)
+        if (!TEST_int_eq(status[i], 1))
+            goto err;
+
+    /*
+     * A changed message, a changed s, an out of range R, a short signature
+     * and the wrong key, of both the hot key and the others.
+     */
+    msg[5][0] ^= 1;
+    msg[6][0] ^= 1;
+    sigs[17 * 128 + 40] ^= 1;
+    sigs[18 * 128 + 40] ^= 1;
+    memset(sigs + 33 * 128, 0xff, 32);
+    siglen[41]--;
+    pkey[51] = vkeys[2];
+    pkey[52] = vkeys[1];
+    sigs[80 * 128] ^= 1;
+    for (pass = 0; pass < 2; pass++) {
+        if (!TEST_int_eq(EVP_DigestVerify_multi(pkey, sig, siglen, tbs, tbslen,
+                                                VERIFY_MULTI_NUM, status), 0))
+            goto err;
+        for (i = 0; i < VERIFY_MULTI_NUM; i++) {
+            int expected = i != 5 && i != 6 && i != 17 && i != 18 && i != 33
+                           && i != 41 && i != 51 && i != 52 && i != 80;
+
+            if (!TEST_int_eq(status[i], expected)
+                    || !TEST_int_gt(EVP_DigestVerifyInit(ctx, NULL, NULL, NULL,
+                                                         pkey[i]), 0)
+                    || !TEST_int_eq(EVP_DigestVerify(ctx, sig[i], siglen[i],
+                                                     tbs[i], tbslen[i]) == 1,
+                                    expected)
+                    || !TEST_true(EVP_MD_CTX_reset(ctx))) {
+                TEST_info("signature %d, pass %d", i, pass);
+                goto err;
+            }
+        }
+    }
+
+    if (!TEST_int_eq(EVP_DigestVerify_multi(NULL, NULL, NULL, NULL, NULL, 0,
+                                            NULL), 1))
+        goto err;
+
+    ret = 1;
+ err:
+    for (i = 0; i < VERIFY_MULTI_KEYS; i++)
+        EVP_PKEY_free(vkeys[i]);
+    EVP_PKEY_CTX_free(kctx);
+    EVP_MD_CTX_free(ctx);
+    OPENSSL_free(sigs);
+    return ret;
+}
+
+# define DERIVE_MULTI_X25519 19
+# define DERIVE_MULTI_NUM    (DERIVE_MULTI_X25519 + 2)
+
+/*
+ * Keys made by EVP_PKEY_keygen_multi() must have the right public halves, and
+ * deriving a batch of X25519 secrets, one of them with a peer of small order,
+ * along with two P-256 ones must give the same results as one at a time.
+ */
+static int test_EVP_PKEY_derive_multi(void)
+{
+    static const unsigned char zeros[X25519_KEYLEN] = { 0 };
+    EVP_PKEY *xkeys[DERIVE_MULTI_NUM] = { NULL };
+    EVP_PKEY *peers[DERIVE_MULTI_NUM] = { NULL };
+    EVP_PKEY_CTX *ctx[DERIVE_MULTI_NUM] = { NULL };
+    EVP_PKEY_CTX *kctx = NULL;
+    EVP_PKEY *pkey = NULL, *bad = NULL;
+    unsigned char out[DERIVE_MULTI_NUM][64], *key[DERIVE_MULTI_NUM];
+    unsigned char priv[X25519_KEYLEN], pub[X25519_KEYLEN], buf[64];
+    size_t keylen[DERIVE_MULTI_NUM], len;
+    int i, ret = 0;
+
+    if (!TEST_ptr(kctx = EVP_PKEY_CTX_new_id(EVP_PKEY_X25519, NULL))
+            || !TEST_int_gt(EVP_PKEY_keygen_init(kctx), 0)
+            || !TEST_int_gt(EVP_PKEY_keygen_multi(kctx, xkeys,
+                                                  DERIVE_MULTI_X25519), 0)
+            || !TEST_int_gt(EVP_PKEY_keygen_multi(kctx, peers,
+                                                  DERIVE_MULTI_X25519), 0))
+        goto err;
+    EVP_PKEY_CTX_free(kctx);
+    if (!TEST_ptr(kctx = EVP_PKEY_CTX_new_id(EVP_PKEY_EC, NULL))
+            || !TEST_int_gt(EVP_PKEY_keygen_init(kctx), 0)
+            || !TEST_int_gt(EVP_PKEY_CTX_set_ec_paramgen_curve_nid(
+                                kctx, NID_X9_62_prime256v1), 0)
+            || !TEST_int_gt(EVP_PKEY_keygen_multi(kctx,
+                                                  xkeys + DERIVE_MULTI_X25519,
+                                                  2), 0)
+            || !TEST_int_gt(EVP_PKEY_keygen_multi(kctx,
+                                                  peers + DERIVE_MULTI_X25519,
+                                                  2), 0))
+        goto err;
+
+    for (i = 0; i < DERIVE_MULTI_X25519; i++) {
+        len = sizeof(priv);
+        if (!TEST_true(EVP_PKEY_get_raw_private_key(xkeys[i], priv, &len))
+                || !TEST_ptr(pkey = EVP_PKEY_new_raw_private_key(
+                                 EVP_PKEY_X25519, NULL, priv, len))
+                || !TEST_true(EVP_PKEY_get_raw_public_key(pkey, pub, &len))
+                || !TEST_true(EVP_PKEY_get_raw_public_key(xkeys[i], buf, &len))
+                || !TEST_mem_eq(pub, sizeof(pub), buf, len))
+            goto err;
+        EVP_PKEY_free(pkey);
+        pkey = NULL;
+    }
+
+    if (!TEST_ptr(bad = EVP_PKEY_new_raw_public_key(EVP_PKEY_X25519, NULL,
+                                                    zeros, sizeof(zeros))))
+        goto err;
+    for (i = 0; i < DERIVE_MULTI_NUM; i++) {
+        key[i] = out[i];
+        keylen[i] = sizeof(out[i]);
+        if (!TEST_ptr(ctx[i] = EVP_PKEY_CTX_new(xkeys[i], NULL))
+                || !TEST_int_gt(EVP_PKEY_derive_init(ctx[i]), 0)
+                || !TEST_int_gt(EVP_PKEY_derive_set_peer(ctx[i], i == 7
+                                                         ? bad : peers[i]), 0))
+            goto err;
+    }
+
+    if (!TEST_int_eq(EVP_PKEY_derive_multi(ctx, key, keylen,
+                                           DERIVE_MULTI_NUM), 0))
+        goto err;
+    for (i = 0; i < DERIVE_MULTI_NUM; i++) {
+        len = sizeof(buf);
+        if (i == 7) {
+            if (!TEST_size_t_eq(keylen[i], 0)
+                    || !TEST_int_le(EVP_PKEY_derive(ctx[i], buf, &len), 0))
+                goto err;
+            continue;
+        }
+        if (!TEST_int_gt(EVP_PKEY_derive(ctx[i], buf, &len), 0)
+                || !TEST_mem_eq(out[i], keylen[i], buf, len)) {
+            TEST_info("secret %d", i);
+            goto err;
+        }
+    }
+    if (!TEST_int_eq(EVP_PKEY_derive_multi(ctx, key, keylen, 7), 1)
+            || !TEST_int_eq(EVP_PKEY_derive_multi(NULL, NULL, NULL, 0), 1))
+        goto err;
+
+    ret = 1;
+ err:
+    for (i = 0; i < DERIVE_MULTI_NUM; i++) {
+        EVP_PKEY_free(xkeys[i]);
+        EVP_PKEY_free(peers[i]);
+        EVP_PKEY_CTX_free(ctx[i]);
+    }
+    EVP_PKEY_CTX_free(kctx);
+    EVP_PKEY_free(pkey);
+    EVP_PKEY_free(bad);
+    return ret;
+}
+#endif
+
+static const EVP_CIPHER *(*aead_multi_ciphers[])(void) = {
+    EVP_aes_128_gcm, EVP_aes_256_gcm
+};
+
+#define AEAD_MULTI_NUM      40
+
+/*
+ * Seal a batch of messages with a mix of lengths, IV lengths and tag lengths,
+ * check each against the result of sealing it on its own, then open them all
+ * again, once intact and once with a tag altered.
+ */
+static int test_EVP_CTRL_AEAD_MULTI(int idx)
+{
+    const EVP_CIPHER *cipher = aead_multi_ciphers[idx]();
+    static const size_t edges[] = {
+        0, 1, 15, 16, 17, 64, 255, 256, 512, 1023, 1024, 1025, 2031, 5000
+    };
+    EVP_CTRL_AEAD_MULTI_PARAM msg[AEAD_MULTI_NUM];
+    unsigned char key[32], iv[AEAD_MULTI_NUM][16];
+    unsigned char tag[AEAD_MULTI_NUM][16], expected[16];
+    unsigned char *buf = NULL, *ct = NULL, *pt = NULL, *exp = NULL;
+    size_t i, off, buflen = 0;
+    EVP_CIPHER_CTX *ctx = NULL;
+    int outl, tmp, ret = 0;
+
+    for (i = 0; i < sizeof(key); i++)
+        key[i] = (unsigned char)(0x40 + i);
+    for (i = 0; i < AEAD_MULTI_NUM; i++) {
+        msg[i].ivlen = i % 9 == 4 ? 8 : i % 9 == 7 ? 16 : 12;
+        msg[i].aadlen = i % 23;
+        msg[i].len = i < OSSL_NELEM(edges) ? edges[i] : (i * 331) % 1500;
+        msg[i].taglen = i % 5 == 3 ? 12 : 16;
+        buflen += msg[i].len;
+    }
+
+    if (!TEST_ptr(buf = OPENSSL_malloc(buflen + 64))
+            || !TEST_ptr(ct = OPENSSL_malloc(buflen))
+            || !TEST_ptr(pt = OPENSSL_malloc(buflen))
+            || !TEST_ptr(exp = OPENSSL_malloc(buflen))
+            || !TEST_ptr(ctx = EVP_CIPHER_CTX_new()))
+        goto err;
+    for (i = 0; i < buflen + 64; i++)
+        buf[i] = (unsigned char)(i * 11 + (i >> 7));
+    for (i = 0, off = 0; i < AEAD_MULTI_NUM; off += msg[i++].len) {
+        memset(iv[i], (int)i, sizeof(iv[i]));
+        iv[i][0] ^= 0x5a;
+        msg[i].iv = iv[i];
+        msg[i].aad = buf + buflen + (i % 41);
+        msg[i].inp = buf + off;
+        msg[i].out = ct + off;
+        msg[i].tag = tag[i];
+        msg[i].verified = -1;
+    }
+
+    if (!TEST_true(EVP_EncryptInit_ex(ctx, cipher, NULL, key, NULL))
+            || !TEST_int_eq(EVP_CIPHER_CTX_ctrl(ctx, EVP_CTRL_AEAD_MULTI,
+                                                AEAD_MULTI_NUM, msg), 1))
+        goto err;
+
+    for (i = 0, off = 0; i < AEAD_MULTI_NUM; off += msg[i++].len) {
+        if (!TEST_int_eq(msg[i].verified, 1)
+                || !TEST_true(EVP_EncryptInit_ex(ctx, NULL, NULL, NULL, NULL))
+                || !TEST_true(EVP_CIPHER_CTX_ctrl(ctx, EVP_CTRL_AEAD_SET_IVLEN,
+                                                  (int)msg[i].ivlen, NULL))
+                || !TEST_true(EVP_EncryptInit_ex(ctx, NULL, NULL, NULL,
+                                                 msg[i].iv))
+                || !TEST_true(EVP_EncryptUpdate(ctx, NULL, &outl, msg[i].aad,
+                                                (int)msg[i].aadlen))
+                || !TEST_true(EVP_EncryptUpdate(ctx, exp + off, &outl,
+                                                msg[i].inp, (int)msg[i].len))
+                || !TEST_true(EVP_EncryptFinal_ex(ctx, exp + off, &tmp))
+                || !TEST_true(EVP_CIPHER_CTX_ctrl(ctx, EVP_CTRL_AEAD_GET_TAG,
+                                                  16, expected))
+                || !TEST_mem_eq(ct + off, msg[i].len, exp + off, msg[i].len)
+                || !TEST_mem_eq(tag[i], msg[i].taglen, expected,
+                                msg[i].taglen)) {
+            TEST_info("message %d of %d bytes", (int)i, (int)msg[i].len);
+            goto err;
+        }
+    }
+
+    /* Open them all again, in place */
+    memcpy(pt, ct, buflen);
+    for (i = 0, off = 0; i < AEAD_MULTI_NUM; off += msg[i++].len) {
+        msg[i].inp = msg[i].out = pt + off;
+        msg[i].verified = -1;
+    }
+    if (!TEST_true(EVP_DecryptInit_ex(ctx, cipher, NULL, key, NULL))
+            || !TEST_int_eq(EVP_CIPHER_CTX_ctrl(ctx, EVP_CTRL_AEAD_MULTI,
+                                                AEAD_MULTI_NUM, msg), 1)
+            || !TEST_mem_eq(pt, buflen, buf, buflen))
+        goto err;
+    for (i = 0; i < AEAD_MULTI_NUM; i++)
+        if (!TEST_int_eq(msg[i].verified, 1))
+            goto err;
+
+    /*
+     * A bad tag fails its own message only and leaves its ciphertext in
+     * place, whether the message is batched (1) or not (4 has an 8 byte IV,
+     * 20 is 620 bytes long)
+     */
+    memcpy(pt, ct, buflen);
+    tag[1][msg[1].taglen - 1] ^= 0x80;
+    tag[4][0] ^= 1;
+    tag[20][0] ^= 1;
+    if (!TEST_int_eq(EVP_CIPHER_CTX_ctrl(ctx, EVP_CTRL_AEAD_MULTI,
+                                         AEAD_MULTI_NUM, msg), 0))
+        goto err;
+    for (i = 0, off = 0; i < AEAD_MULTI_NUM; off += msg[i++].len) {
+        int bad = i == 1 || i == 4 || i == 20;
+
+        if (!TEST_int_eq(msg[i].verified, !bad)
+                || !TEST_mem_eq(pt + off, msg[i].len,
+                                bad ? ct + off : buf + off, msg[i].len)) {
+            TEST_info("message %d of %d bytes", (int)i, (int)msg[i].len);
+            goto err;
+        }
+    }
+
+    /* Nothing to do, and a tag that is too long */
+    msg[0].taglen = 17;
+    if (!TEST_int_eq(EVP_CIPHER_CTX_ctrl(ctx, EVP_CTRL_AEAD_MULTI, 0, NULL), 1)
+            || !TEST_int_eq(EVP_CIPHER_CTX_ctrl(ctx, EVP_CTRL_AEAD_MULTI, 1,
+                                                msg), 0))
+        goto err;
+
+    ret = 1;
+ err:
+    EVP_CIPHER_CTX_free(ctx);
+    OPENSSL_free(buf);
+    OPENSSL_free(ct);
+    OPENSSL_free(pt);
+    OPENSSL_free(exp);
+    return ret;
+}
+
 int setup_tests(void)
 {
     ADD_TEST(test_EVP_DigestSignInit);
@@ -1204,10 +1752,18 @@ int setup_tests(void)
 #endif
 #if !defined(OPENSSL_NO_CHACHA) && !defined(OPENSSL_NO_POLY1305)
     ADD_TEST(test_decrypt_null_chunks);
+    ADD_ALL_TESTS(test_chacha20_poly1305_long, 2);
 #endif
 #ifndef OPENSSL_NO_DH
     ADD_TEST(test_EVP_PKEY_set1_DH);
 #endif
+    ADD_TEST(test_EVP_get_cipherbyname_update);
+    ADD_ALL_TESTS(test_EVP_Digest_multi, OSSL_NELEM(digest_multi_mds));
+#ifndef OPENSSL_NO_EC
+    ADD_TEST(test_EVP_DigestVerify_multi);
+    ADD_TEST(test_EVP_PKEY_derive_multi);
+#endif
+    ADD_ALL_TESTS(test_EVP_CTRL_AEAD_MULTI, OSSL_NELEM(aead_multi_ciphers));
 
     return 1;
 }
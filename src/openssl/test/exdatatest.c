@@ -258,8 +258,57 @@ static int test_exdata(void)
       return 0;
 }
 
+static int cnt_new, cnt_free;
+
+static void cntnew(void *parent, void *ptr, CRYPTO_EX_DATA *ad,
+                   int idx, long argl, void *argp)
+{
+    cnt_new++;
+}
+
+static void cntfree(void *parent, void *ptr, CRYPTO_EX_DATA *ad,
+                    int idx, long argl, void *argp)
+{
+    cnt_free++;
+}
+
+static int test_exdata_free_index(void)
+{
+    CRYPTO_EX_DATA ad;
+    int idx;
+
+    /* No index registered for this class yet */
+    if (!TEST_true(CRYPTO_new_ex_data(CRYPTO_EX_INDEX_UI_METHOD, NULL, &ad))
+            || !TEST_ptr_null(ad.sk))
+        return 0;
+    CRYPTO_free_ex_data(CRYPTO_EX_INDEX_UI_METHOD, NULL, &ad);
+
+    if (!TEST_int_gt(idx = CRYPTO_get_ex_new_index(CRYPTO_EX_INDEX_UI_METHOD,
+                                                   0, NULL, cntnew, NULL,
+                                                   cntfree), 0)
+            || !TEST_true(CRYPTO_new_ex_data(CRYPTO_EX_INDEX_UI_METHOD, NULL,
+                                             &ad)))
+        return 0;
+    CRYPTO_free_ex_data(CRYPTO_EX_INDEX_UI_METHOD, NULL, &ad);
+    if (!TEST_int_eq(cnt_new, 1) || !TEST_int_eq(cnt_free, 1))
+        return 0;
+
+    /* Once the index is freed its callbacks are no longer called */
+    if (!TEST_true(CRYPTO_free_ex_index(CRYPTO_EX_INDEX_UI_METHOD, idx))
+            || !TEST_true(CRYPTO_new_ex_data(CRYPTO_EX_INDEX_UI_METHOD, NULL,
+                                             &ad)))
+        return 0;
+    CRYPTO_free_ex_data(CRYPTO_EX_INDEX_UI_METHOD, NULL, &ad);
+    if (!TEST_int_eq(cnt_new, 1) || !TEST_int_eq(cnt_free, 1))
+        return 0;
+
+    /* Bad classes are still rejected */
+    return TEST_false(CRYPTO_new_ex_data(CRYPTO_EX_INDEX__COUNT, NULL, &ad));
+}
+
 int setup_tests(void)
 {
     ADD_TEST(test_exdata);
+    ADD_TEST(test_exdata_free_index);
     return 1;
 }
@@ -0,0 +1,212 @@
+/*
+ * Copyright 2020 The OpenSSL Project Authors. All Rights Reserved.
+ *
+ * Licensed under the OpenSSL license (the "License").  You may not use
+ * this file except in compliance with the License.  You can obtain a copy
+ * in the file LICENSE in the source distribution or at
+ * https://www.openssl.org/source/license.html
+ */
+
+#include <string.h>
+#include "../ssl/ssl_local.h"
+#include "testutil.h"
+
+#define NUM_ITEMS   300
+
+static void prio_to_be(uint64_t prio, unsigned char *prio64be)
+{
+    l2n8(prio, prio64be);
+}
+
+static uint64_t prio_from_be(const unsigned char *prio64be)
+{
+    uint64_t prio;
+
+    n2l8(prio64be, prio);
+    return prio;
+}
+
+static int insert_prio(pqueue *pq, uint64_t prio)
+{
+    unsigned char buf[8];
+    pitem *item;
+
+    prio_to_be(prio, buf);
+    if (!TEST_ptr(item = pitem_new(buf, NULL)))
+        return 0;
+    if (pqueue_insert(pq, item) == NULL) {
+        pitem_free(item);
+        return 0;
+    }
+    return 1;
+}
+
+static int find_prio(pqueue *pq, uint64_t prio)
+{
+    unsigned char buf[8];
+    pitem *item;
+
+    prio_to_be(prio, buf);
+    item = pqueue_find(pq, buf);
+    return item != NULL && prio_from_be(item->priority) == prio;
+}
+
+/* Check that |pq| holds exactly the priorities flagged in |present| */
+static int check_queue(pqueue *pq, const unsigned char *present, size_t n)
+{
+    piterator iter = pqueue_iterator(pq);
+    pitem *item;
+    uint64_t prio, prev = 0;
+    size_t i, count = 0;
+    int first = 1;
+
+    while ((item = pqueue_next(&iter)) != NULL) {
+        prio = prio_from_be(item->priority);
+        if (!TEST_true(first || prio > prev)
+                || !TEST_size_t_lt(prio, n)
+                || !TEST_true(present[prio]))
+            return 0;
+        first = 0;
+        prev = prio;
+        count++;
+    }
+    for (i = 0; i < n; i++)
+        if (!TEST_int_eq(find_prio(pq, i), present[i]))
+            return 0;
+    return TEST_size_t_eq(pqueue_size(pq), count);
+}
+
+static void empty_queue(pqueue *pq)
+{
+    pitem *item;
+
+    while ((item = pqueue_pop(pq)) != NULL)
+        pitem_free(item);
+}
+
+/*
+ * Insert and pop priorities in an order chosen by |idx|, checking the queue
+ * contents after every step.
+ */
+static int test_pqueue_order(int idx)
+{
+    pqueue *pq = pqueue_new();
+    unsigned char present[NUM_ITEMS];
+    uint64_t prio;
+    pitem *item;
+    size_t i;
+    int testresult = 0;
+
+    memset(present, 0, sizeof(present));
+    if (!TEST_ptr(pq))
+        goto end;
+
+    for (i = 0; i < NUM_ITEMS; i++) {
+        switch (idx) {
+        case 0:
+            /* In order */
+            prio = i;
+            break;
+        case 1:
+            /* Descending, every item far behind the newest */
+            prio = NUM_ITEMS - 1 - i;
+            break;
+        default:
+            /* Pseudo-random order, wider than the window */
+            prio = (i * 113 + 7) % NUM_ITEMS;
+            break;
+        }
+        if (!TEST_true(insert_prio(pq, prio))
+                || !TEST_false(insert_prio(pq, prio)))
+            goto end;
+        present[prio] = 1;
+
+        /* Take an item off every now and then */
+        if (i % 7 == 6) {
+            if (!TEST_ptr(item = pqueue_pop(pq)))
+                goto end;
+            present[prio_from_be(item->priority)] = 0;
+            pitem_free(item);
+        }
+        if (!check_queue(pq, present, NUM_ITEMS))
+            goto end;
+    }
+
+    for (i = 0; (item = pqueue_pop(pq)) != NULL; i++) {
+        while (!present[i])
+            i++;
+        prio = prio_from_be(item->priority);
+        pitem_free(item);
+        if (!TEST_size_t_eq(prio, i))
+            goto end;
+        present[i] = 0;
+    }
+    if (!TEST_size_t_eq(pqueue_size(pq), 0)
+            || !TEST_ptr_null(pqueue_peek(pq)))
+        goto end;
+
+    testresult = 1;
+ end:
+    if (pq != NULL)
+        empty_queue(pq);
+    pqueue_free(pq);
+    return testresult;
+}
+
+/* Priorities are full 64-bit values, including large gaps between them */
+static int test_pqueue_sparse(void)
+{
+    static const uint64_t prios[] = {
+        0x0001000000000005ULL, 0x0001000000000003ULL, 0x0000ffffffffffffULL,
+        0x0002000000000000ULL, 0x0001000000000004ULL, 0xffffffffffffffffULL,
+        0x0000000000000000ULL, 0x0001000000000040ULL
+    };
+    static const uint64_t sorted[] = {
+        0x0000000000000000ULL, 0x0000ffffffffffffULL, 0x0001000000000003ULL,
+        0x0001000000000004ULL, 0x0001000000000005ULL, 0x0001000000000040ULL,
+        0x0002000000000000ULL, 0xffffffffffffffffULL
+    };
+    pqueue *pq = pqueue_new();
+    unsigned char buf[8];
+    pitem *item;
+    size_t i;
+    int testresult = 0;
+
+    if (!TEST_ptr(pq))
+        goto end;
+    for (i = 0; i < OSSL_NELEM(prios); i++)
+        if (!TEST_true(insert_prio(pq, prios[i])))
+            goto end;
+    for (i = 0; i < OSSL_NELEM(prios); i++)
+        if (!TEST_true(find_prio(pq, prios[i]))
+                || !TEST_false(insert_prio(pq, prios[i])))
+            goto end;
+    prio_to_be(0x0001000000000006ULL, buf);
+    if (!TEST_ptr_null(pqueue_find(pq, buf))
+            || !TEST_size_t_eq(pqueue_size(pq), OSSL_NELEM(prios)))
+        goto end;
+    for (i = 0; i < OSSL_NELEM(sorted); i++) {
+        if (!TEST_ptr(item = pqueue_pop(pq)))
+            goto end;
+        prio_to_be(sorted[i], buf);
+        if (!TEST_mem_eq(item->priority, 8, buf, 8)) {
+            pitem_free(item);
+            goto end;
+        }
+        pitem_free(item);
+    }
+
+    testresult = 1;
+ end:
+    if (pq != NULL)
+        empty_queue(pq);
+    pqueue_free(pq);
+    return testresult;
+}
+
+int setup_tests(void)
+{
+    ADD_ALL_TESTS(test_pqueue_order, 3);
+    ADD_TEST(test_pqueue_sparse);
+    return 1;
+}
@@ -0,0 +1,28 @@
+#! /usr/bin/env perl
+# Copyright 2020 The OpenSSL Project Authors. All Rights Reserved.
+#
+# Licensed under the OpenSSL license (the "License").  You may not use
+# this file except in compliance with the License.  You can obtain a copy
+# in the file LICENSE in the source distribution or at
+# https://www.openssl.org/source/license.html
+
+
+use strict;
+use warnings;
+
+use OpenSSL::Test qw/:DEFAULT srctop_file/;
+
+setup("test_x509_hash_file");
+
+plan tests => 2;
+
+ok(run(app(["openssl", "hashfile", "-out", "roots.hcf",
+            srctop_file("test", "certs", "root-cert.pem")])),
+   "create hashed certificate file");
+
+ok(run(test(["x509_hash_file_test", "roots.hcf",
+             srctop_file("test", "certs", "root-cert.pem"),
+             srctop_file("test", "certs", "ca-cert.pem"),
+             srctop_file("test", "certs", "ee-cert.pem"),
+             "written.hcf"])),
+   "hashed certificate file lookups");
@@ -36,7 +36,7 @@ sub verify {
     run(app([@args]));
 }
 
-plan tests => 3;
+plan tests => 4;
 
 indir "60-test_x509_store" => sub {
     for (("root-cert")) {
@@ -50,4 +50,10 @@ indir "60-test_x509_store" => sub {
 
     # Failure because root cert not present in CApath
     ok(!verify("ca-root2", "any", curdir(), [], "-show_chain"));
+
+    # In-memory index of the hashed directory
+    ok(run(test(["x509_dir_index_test", curdir(),
+                 srctop_file("test", "certs", "root-cert.pem"),
+                 srctop_file("test", "certs", "ca-cert.pem")])),
+       "hashed directory index");
 }, create => 1, cleanup => 1;
@@ -4697,6 +4697,644 @@ static int test_ssl_clear(int idx)
     return testresult;
 }
 
+/*
+ * Test that a client with a peer certificate cache shares the decoded server
+ * certificate between connections.
+ * Test 0: TLSv1.2
+ * Test 1: TLSv1.3
+ */
+static int test_peer_cert_cache(int idx)
+{
+    SSL_CTX *cctx = NULL, *sctx = NULL;
+    SSL *clientssl = NULL, *serverssl = NULL;
+    X509 *first = NULL, *second = NULL, *third = NULL;
+    int testresult = 0;
+
+#ifdef OPENSSL_NO_TLS1_2
+    if (idx == 0)
+        return 1;
+#endif
+#ifdef OPENSSL_NO_TLS1_3
+    if (idx == 1)
+        return 1;
+#endif
+
+    if (!TEST_true(create_ssl_ctx_pair(TLS_server_method(), TLS_client_method(),
+                                       TLS1_VERSION, TLS_MAX_VERSION,
+                                       &sctx, &cctx, cert, privkey))
+            || !TEST_true(SSL_CTX_set_max_proto_version(cctx, idx == 0
+                                                        ? TLS1_2_VERSION
+                                                        : TLS1_3_VERSION))
+            || !TEST_true(SSL_CTX_set_peer_cert_cache_size(cctx, 4))
+            || !TEST_true(create_ssl_objects(sctx, cctx, &serverssl,
+                                             &clientssl, NULL, NULL))
+            || !TEST_true(create_ssl_connection(serverssl, clientssl,
+                                                SSL_ERROR_NONE))
+            || !TEST_ptr(first = SSL_get_peer_certificate(clientssl)))
+        goto end;
+
+    shutdown_ssl_connection(serverssl, clientssl);
+    serverssl = clientssl = NULL;
+
+    if (!TEST_true(create_ssl_objects(sctx, cctx, &serverssl, &clientssl,
+                                      NULL, NULL))
+            || !TEST_true(create_ssl_connection(serverssl, clientssl,
+                                                SSL_ERROR_NONE))
+            || !TEST_false(SSL_session_reused(clientssl))
+            || !TEST_ptr(second = SSL_get_peer_certificate(clientssl))
+            || !TEST_ptr_eq(first, second))
+        goto end;
+
+    /*
+     * Disabling the cache drops the shared certificate, the next connection
+     * decodes a copy of its own
+     */
+    shutdown_ssl_connection(serverssl, clientssl);
+    serverssl = clientssl = NULL;
+    if (!TEST_true(SSL_CTX_set_peer_cert_cache_size(cctx, 0))
+            || !TEST_true(create_ssl_objects(sctx, cctx, &serverssl,
+                                             &clientssl, NULL, NULL))
+            || !TEST_true(create_ssl_connection(serverssl, clientssl,
+                                                SSL_ERROR_NONE))
+            || !TEST_ptr(third = SSL_get_peer_certificate(clientssl))
+            || !TEST_ptr_ne(first, third)
+            || !TEST_int_eq(X509_cmp(first, third), 0))
+        goto end;
+
+    testresult = 1;
+
+ end:
+    X509_free(first);
+    X509_free(second);
+    X509_free(third);
+    SSL_free(serverssl);
+    SSL_free(clientssl);
+    SSL_CTX_free(sctx);
+    SSL_CTX_free(cctx);
+
+    return testresult;
+}
+
+#if !defined(OPENSSL_NO_SOCK) && !defined(OPENSSL_NO_TLS1_2) \
+    && defined(OPENSSL_SYS_UNIX) && !defined(OPENSSL_NO_POSIX_IO)
+# define SENDFILE_OFF   100
+# define SENDFILE_SZ    (4 * SSL3_RT_MAX_PLAIN_LENGTH + 1000)
+
+/*
+ * Test SSL_sendfile() over a TCP connection.  With kernel TLS requested the
+ * kernel has to take over sending, the test is skipped if it can't.
+ * Test 0: AES128-GCM-SHA256 with kernel TLS
+ * Test 1: AES256-GCM-SHA384 with kernel TLS
+ * Test 2: AES128-GCM-SHA256 without kernel TLS, using the fallback
+ */
+static int test_sendfile(int idx)
+{
+    SSL_CTX *cctx = NULL, *sctx = NULL;
+    SSL *clientssl = NULL, *serverssl = NULL;
+    unsigned char *in = NULL, *out = NULL;
+    size_t i, sent = 0, recvd = 0, readbytes;
+    ossl_ssize_t ret;
+    int cfd, sfd, testresult = 0;
+    FILE *f = NULL;
+
+    if (!TEST_ptr(in = OPENSSL_malloc(SENDFILE_OFF + SENDFILE_SZ))
+            || !TEST_ptr(out = OPENSSL_malloc(SENDFILE_SZ))
+            || !TEST_ptr(f = tmpfile()))
+        goto end;
+    for (i = 0; i < SENDFILE_OFF + SENDFILE_SZ; i++)
+        in[i] = (unsigned char)(i * 31);
+    if (!TEST_size_t_eq(fwrite(in, 1, SENDFILE_OFF + SENDFILE_SZ, f),
+                        SENDFILE_OFF + SENDFILE_SZ)
+            || !TEST_int_eq(fflush(f), 0))
+        goto end;
+
+    if (!TEST_true(create_ssl_ctx_pair(TLS_server_method(), TLS_client_method(),
+                                       TLS1_2_VERSION, TLS1_2_VERSION,
+                                       &sctx, &cctx, cert, privkey))
+            || !TEST_true(SSL_CTX_set_cipher_list(cctx, idx == 1
+                                                  ? "AES256-GCM-SHA384"
+                                                  : "AES128-GCM-SHA256")))
+        goto end;
+    if (idx < 2) {
+        SSL_CTX_set_options(cctx, SSL_OP_ENABLE_KTLS);
+        SSL_CTX_set_options(sctx, SSL_OP_ENABLE_KTLS);
+    }
+
+    if (!TEST_true(create_test_sockets(&cfd, &sfd))
+            || !TEST_true(create_ssl_objects2(sctx, cctx, &serverssl,
+                                              &clientssl, sfd, cfd))
+            || !TEST_true(create_ssl_connection(serverssl, clientssl,
+                                                SSL_ERROR_NONE)))
+        goto end;
+
+    if (idx == 2) {
+        if (!TEST_false(BIO_get_ktls_send(SSL_get_wbio(clientssl))))
+            goto end;
+    } else if (!BIO_get_ktls_send(SSL_get_wbio(clientssl))) {
+        testresult = TEST_skip("kernel TLS is not available");
+        goto end;
+    }
+
+    while (recvd < SENDFILE_SZ) {
+        if (sent < SENDFILE_SZ) {
+            ret = SSL_sendfile(clientssl, fileno(f), SENDFILE_OFF + sent,
+                               SENDFILE_SZ - sent, 0);
+            if (ret > 0)
+                sent += ret;
+            else if (!TEST_int_eq(SSL_get_error(clientssl, (int)ret),
+                                  SSL_ERROR_WANT_WRITE))
+                goto end;
+        }
+        if (SSL_read_ex(serverssl, out + recvd, SENDFILE_SZ - recvd,
+                        &readbytes))
+            recvd += readbytes;
+        else if (!TEST_int_eq(SSL_get_error(serverssl, 0),
+                              SSL_ERROR_WANT_READ))
+            goto end;
+    }
+
+    if (!TEST_size_t_eq(sent, SENDFILE_SZ)
+            || !TEST_mem_eq(in + SENDFILE_OFF, SENDFILE_SZ, out, recvd))
+        goto end;
+
+    /* The connection keeps working in the other direction too */
+    if (!TEST_int_eq(SSL_write(serverssl, in, 100), 100))
+        goto end;
+    do {
+        ret = SSL_read(clientssl, out, SENDFILE_SZ);
+    } while (ret <= 0 && SSL_get_error(clientssl, (int)ret)
+                         == SSL_ERROR_WANT_READ);
+    if (!TEST_mem_eq(in, 100, out, ret))
+        goto end;
+
+    testresult = 1;
+
+ end:
+    SSL_free(serverssl);
+    SSL_free(clientssl);
+    SSL_CTX_free(sctx);
+    SSL_CTX_free(cctx);
+    if (f != NULL)
+        fclose(f);
+    OPENSSL_free(in);
+    OPENSSL_free(out);
+
+    return testresult;
+}
+#endif
+
+static int bio_writes;
+
+static long count_writes_cb(BIO *b, int oper, const char *argp, size_t len,
+                            int argi, long argl, int ret, size_t *processed)
+{
+    if (oper == BIO_CB_WRITE)
+        bio_writes++;
+    return ret;
+}
+
+#define BATCH_WRITE_SZ (10 * SSL3_RT_MAX_PLAIN_LENGTH + 100)
+
+/*
+ * Test that a large write with an AEAD cipher is sealed several records at a
+ * time and reaches the BIO in a few writes rather than one per record.
+ * Test 0: TLSv1.2 AES-GCM
+ * Test 1: TLSv1.2 ChaCha20-Poly1305
+ * Test 2: TLSv1.3
+ */
+static int test_write_batch(int idx)
+{
+    SSL_CTX *cctx = NULL, *sctx = NULL;
+    SSL *clientssl = NULL, *serverssl = NULL;
+    unsigned char *in = NULL, *out = NULL;
+    size_t i, written, readbytes, recvd = 0;
+    int testresult = 0;
+
+#ifdef OPENSSL_NO_TLS1_2
+    if (idx < 2)
+        return 1;
+#endif
+#ifdef OPENSSL_NO_CHACHA
+    if (idx == 1)
+        return 1;
+#endif
+#ifdef OPENSSL_NO_TLS1_3
+    if (idx == 2)
+        return 1;
+#endif
+
+    if (!TEST_ptr(in = OPENSSL_malloc(BATCH_WRITE_SZ))
+            || !TEST_ptr(out = OPENSSL_malloc(BATCH_WRITE_SZ)))
+        goto end;
+    for (i = 0; i < BATCH_WRITE_SZ; i++)
+        in[i] = (unsigned char)(i * 7);
+
+    if (!TEST_true(create_ssl_ctx_pair(TLS_server_method(), TLS_client_method(),
+                                       TLS1_VERSION, TLS_MAX_VERSION,
+                                       &sctx, &cctx, cert, privkey)))
+        goto end;
+    if (idx < 2
+            && (!TEST_true(SSL_CTX_set_max_proto_version(cctx, TLS1_2_VERSION))
+                || !TEST_true(SSL_CTX_set_cipher_list(cctx, idx == 0
+                                  ? "ECDHE-RSA-AES128-GCM-SHA256"
+                                  : "ECDHE-RSA-CHACHA20-POLY1305"))))
+        goto end;
+    if (idx == 2
+            && !TEST_true(SSL_CTX_set_min_proto_version(cctx, TLS1_3_VERSION)))
+        goto end;
+
+    if (!TEST_true(create_ssl_objects(sctx, cctx, &serverssl, &clientssl,
+                                      NULL, NULL))
+            || !TEST_true(create_ssl_connection(serverssl, clientssl,
+                                                SSL_ERROR_NONE)))
+        goto end;
+
+    bio_writes = 0;
+    BIO_set_callback_ex(SSL_get_wbio(clientssl), count_writes_cb);
+    if (!TEST_true(SSL_write_ex(clientssl, in, BATCH_WRITE_SZ, &written))
+            || !TEST_size_t_eq(written, BATCH_WRITE_SZ))
+        goto end;
+    BIO_set_callback_ex(SSL_get_wbio(clientssl), NULL);
+
+    /* 8 records, then the 2 remaining full ones, then the tail */
+    if (!TEST_int_eq(bio_writes, 3))
+        goto end;
+
+    while (recvd < BATCH_WRITE_SZ) {
+        if (!TEST_true(SSL_read_ex(serverssl, out + recvd,
+                                   BATCH_WRITE_SZ - recvd, &readbytes)))
+            goto end;
+        recvd += readbytes;
+    }
+    if (!TEST_mem_eq(in, BATCH_WRITE_SZ, out, recvd))
+        goto end;
+
+    testresult = 1;
+
+ end:
+    SSL_free(serverssl);
+    SSL_free(clientssl);
+    SSL_CTX_free(sctx);
+    SSL_CTX_free(cctx);
+    OPENSSL_free(in);
+    OPENSSL_free(out);
+
+    return testresult;
+}
+
+/*
+ * Test SSL_read_view() and SSL_release_view()
+ * Test 0: Default mode
+ * Test 1: SSL_MODE_RELEASE_BUFFERS on the reading side
+ */
+static int test_read_view(int idx)
+{
+    SSL_CTX *cctx = NULL, *sctx = NULL;
+    SSL *clientssl = NULL, *serverssl = NULL;
+    const char *msg1 = "Hello", *msg2 = "World!";
+    const unsigned char *data;
+    unsigned char buf[20];
+    size_t len, written, readbytes;
+    int testresult = 0;
+
+    if (!TEST_true(create_ssl_ctx_pair(TLS_server_method(), TLS_client_method(),
+                                       TLS1_VERSION, TLS_MAX_VERSION,
+                                       &sctx, &cctx, cert, privkey)))
+        goto end;
+    if (idx == 1)
+        SSL_CTX_set_mode(sctx, SSL_MODE_RELEASE_BUFFERS);
+
+    if (!TEST_true(create_ssl_objects(sctx, cctx, &serverssl, &clientssl,
+                                      NULL, NULL))
+            || !TEST_true(create_ssl_connection(serverssl, clientssl,
+                                                SSL_ERROR_NONE)))
+        goto end;
+
+    /* Nothing to read yet */
+    if (!TEST_false(SSL_read_view(serverssl, &data, &len))
+            || !TEST_int_eq(SSL_get_error(serverssl, 0), SSL_ERROR_WANT_READ)
+            || !TEST_false(SSL_release_view(serverssl, 0)))
+        goto end;
+
+    if (!TEST_true(SSL_write_ex(clientssl, msg1, strlen(msg1), &written))
+            || !TEST_true(SSL_write_ex(clientssl, msg2, strlen(msg2),
+                                       &written)))
+        goto end;
+
+    /* The view covers the first record only and can be released piecemeal */
+    if (!TEST_true(SSL_read_view(serverssl, &data, &len))
+            || !TEST_mem_eq(data, len, msg1, strlen(msg1))
+            || !TEST_size_t_eq(SSL_pending(serverssl), strlen(msg1))
+            || !TEST_true(SSL_release_view(serverssl, 2))
+            || !TEST_true(SSL_read_view(serverssl, &data, &len))
+            || !TEST_mem_eq(data, len, msg1 + 2, strlen(msg1) - 2)
+            || !TEST_false(SSL_release_view(serverssl, len + 1))
+            || !TEST_true(SSL_release_view(serverssl, len)))
+        goto end;
+    ERR_clear_error();
+
+    /* A view and a copying read see the same stream */
+    if (!TEST_true(SSL_read_view(serverssl, &data, &len))
+            || !TEST_mem_eq(data, len, msg2, strlen(msg2))
+            || !TEST_true(SSL_release_view(serverssl, 1))
+            || !TEST_true(SSL_read_ex(serverssl, buf, sizeof(buf), &readbytes))
+            || !TEST_mem_eq(buf, readbytes, msg2 + 1, strlen(msg2) - 1))
+        goto end;
+
+    if (!TEST_false(SSL_read_view(serverssl, &data, &len))
+            || !TEST_int_eq(SSL_get_error(serverssl, 0), SSL_ERROR_WANT_READ))
+        goto end;
+
+    testresult = 1;
+
+ end:
+    SSL_free(serverssl);
+    SSL_free(clientssl);
+    SSL_CTX_free(sctx);
+    SSL_CTX_free(cctx);
+
+    return testresult;
+}
+
+/*
+ * Test that idle connections give their record buffers back to the
+ * SSL_CTX buffer pool and that they are reused
+ */
+static int test_buffer_pool(void)
+{
+    SSL_CTX *cctx = NULL, *sctx = NULL;
+    SSL *clientssl = NULL, *serverssl = NULL;
+    SSL *clientssl2 = NULL, *serverssl2 = NULL;
+    const char *msg = "Hello";
+    unsigned char buf[20];
+    size_t written, readbytes;
+    long hits, misses;
+    int testresult = 0;
+
+    if (!TEST_true(create_ssl_ctx_pair(TLS_server_method(), TLS_client_method(),
+                                       TLS1_VERSION, TLS_MAX_VERSION,
+                                       &sctx, &cctx, cert, privkey)))
+        goto end;
+
+    if (!TEST_long_eq(SSL_CTX_buffer_pool_hits(sctx), 0)
+            || !TEST_long_eq(SSL_CTX_set_buffer_pool_size(sctx, 4), 1)
+            || !TEST_true(SSL_CTX_get_mode(sctx) & SSL_MODE_RELEASE_BUFFERS))
+        goto end;
+
+    if (!TEST_true(create_ssl_objects(sctx, cctx, &serverssl, &clientssl,
+                                      NULL, NULL))
+            || !TEST_true(create_ssl_connection(serverssl, clientssl,
+                                                SSL_ERROR_NONE))
+            || !TEST_true(SSL_write_ex(clientssl, msg, strlen(msg), &written))
+            || !TEST_true(SSL_read_ex(serverssl, buf, sizeof(buf), &readbytes))
+            || !TEST_true(SSL_write_ex(serverssl, buf, readbytes, &written))
+            || !TEST_true(SSL_read_ex(clientssl, buf, sizeof(buf), &readbytes))
+            || !TEST_mem_eq(buf, readbytes, msg, strlen(msg)))
+        goto end;
+
+    /* The idle server holds no buffers, but the pool does */
+    if (!TEST_long_eq(SSL_CTX_buffer_pool_in_use(sctx), 0)
+            || !TEST_long_gt(SSL_CTX_buffer_pool_high_water(sctx), 0)
+            || !TEST_long_gt(SSL_CTX_buffer_pool_hits(sctx), 0))
+        goto end;
+
+    /* A second connection reuses them */
+    hits = SSL_CTX_buffer_pool_hits(sctx);
+    if (!TEST_true(create_ssl_objects(sctx, cctx, &serverssl2, &clientssl2,
+                                      NULL, NULL))
+            || !TEST_true(create_ssl_connection(serverssl2, clientssl2,
+                                                SSL_ERROR_NONE))
+            || !TEST_long_gt(SSL_CTX_buffer_pool_hits(sctx), hits)
+            || !TEST_long_eq(SSL_CTX_buffer_pool_in_use(sctx), 0))
+        goto end;
+
+    /* Buffers still held by a connection are given back when it is freed */
+    if (!TEST_true(SSL_write_ex(clientssl2, msg, strlen(msg), &written))
+            || !TEST_true(SSL_peek_ex(serverssl2, buf, 1, &readbytes))
+            || !TEST_long_eq(SSL_CTX_buffer_pool_in_use(sctx), 1))
+        goto end;
+    SSL_free(serverssl2);
+    SSL_free(clientssl2);
+    serverssl2 = clientssl2 = NULL;
+    if (!TEST_long_eq(SSL_CTX_buffer_pool_in_use(sctx), 0))
+        goto end;
+
+    /* A buffer of another size is not pooled and leaves the pool alone */
+    if (!TEST_true(create_ssl_objects(sctx, cctx, &serverssl2, &clientssl2,
+                                      NULL, NULL)))
+        goto end;
+    SSL_set_default_read_buffer_len(serverssl2, 2 * SSL3_RT_MAX_PACKET_SIZE);
+    if (!TEST_true(create_ssl_connection(serverssl2, clientssl2,
+                                         SSL_ERROR_NONE)))
+        goto end;
+    SSL_free(serverssl2);
+    SSL_free(clientssl2);
+    serverssl2 = clientssl2 = NULL;
+    misses = SSL_CTX_buffer_pool_misses(sctx);
+    if (!TEST_true(create_ssl_objects(sctx, cctx, &serverssl2, &clientssl2,
+                                      NULL, NULL))
+            || !TEST_true(create_ssl_connection(serverssl2, clientssl2,
+                                                SSL_ERROR_NONE))
+            || !TEST_long_eq(SSL_CTX_buffer_pool_misses(sctx), misses)
+            || !TEST_long_eq(SSL_CTX_buffer_pool_in_use(sctx), 0)
+            || !TEST_true(SSL_CTX_set_buffer_pool_size(sctx, 0)))
+        goto end;
+
+    testresult = 1;
+
+ end:
+    SSL_free(serverssl);
+    SSL_free(clientssl);
+    SSL_free(serverssl2);
+    SSL_free(clientssl2);
+    SSL_CTX_free(sctx);
+    SSL_CTX_free(cctx);
+
+    return testresult;
+}
+
+#ifndef OPENSSL_NO_EC
+/*
+ * Test that handshakes take their ephemeral keys from the SSL_CTX keyshare
+ * pool once it has been filled
+ * Test 0: TLSv1.3 key_share
+ * Test 1: TLSv1.2 ECDHE
+ */
+static int test_keyshare_pool(int idx)
+{
+    SSL_CTX *cctx = NULL, *sctx = NULL;
+    SSL *clientssl = NULL, *serverssl = NULL;
+    int testresult = 0;
+    int version = idx == 0 ? TLS1_3_VERSION : TLS1_2_VERSION;
+
+#ifdef OPENSSL_NO_TLS1_3
+    if (idx == 0)
+        return 1;
+#endif
+#ifdef OPENSSL_NO_TLS1_2
+    if (idx == 1)
+        return 1;
+#endif
+
+    if (!TEST_true(create_ssl_ctx_pair(TLS_server_method(), TLS_client_method(),
+                                       version, version,
+                                       &sctx, &cctx, cert, privkey)))
+        goto end;
+
+    /* Without a pool there is nothing to fill */
+    if (!TEST_int_eq(SSL_CTX_fill_keyshare_pool(sctx, 0), 0)
+            || !TEST_long_eq(SSL_CTX_set_keyshare_pool_size(sctx, 2), 1)
+            || !TEST_int_eq(SSL_CTX_fill_keyshare_pool(sctx, 0), 0))
+        goto end;
+
+    /* The first handshake misses and adds its group to the pool */
+    if (!TEST_true(create_ssl_objects(sctx, cctx, &serverssl, &clientssl,
+                                      NULL, NULL))
+            || !TEST_true(create_ssl_connection(serverssl, clientssl,
+                                                SSL_ERROR_NONE))
+            || !TEST_long_eq(SSL_CTX_keyshare_pool_hits(sctx), 0)
+            || !TEST_long_eq(SSL_CTX_keyshare_pool_misses(sctx), 1)
+            || !TEST_int_eq(SSL_CTX_fill_keyshare_pool(sctx, 1), 1)
+            || !TEST_int_eq(SSL_CTX_fill_keyshare_pool(sctx, 0), 1)
+            || !TEST_int_eq(SSL_CTX_fill_keyshare_pool(sctx, 0), 0))
+        goto end;
+    SSL_free(serverssl);
+    SSL_free(clientssl);
+    serverssl = clientssl = NULL;
+
+    /* The next one uses a ready-made key */
+    if (!TEST_true(create_ssl_objects(sctx, cctx, &serverssl, &clientssl,
+                                      NULL, NULL))
+            || !TEST_true(create_ssl_connection(serverssl, clientssl,
+                                                SSL_ERROR_NONE))
+            || !TEST_long_eq(SSL_CTX_keyshare_pool_hits(sctx), 1)
+            || !TEST_long_eq(SSL_CTX_keyshare_pool_misses(sctx), 1)
+            || !TEST_int_eq(SSL_CTX_fill_keyshare_pool(sctx, 0), 1))
+        goto end;
+
+    /* Shrinking the pool frees the keys it no longer has room for */
+    if (!TEST_long_eq(SSL_CTX_set_keyshare_pool_size(sctx, 0), 1)
+            || !TEST_int_eq(SSL_CTX_fill_keyshare_pool(sctx, 0), 0))
+        goto end;
+
+    testresult = 1;
+
+ end:
+    SSL_free(serverssl);
+    SSL_free(clientssl);
+    SSL_CTX_free(sctx);
+    SSL_CTX_free(cctx);
+
+    return testresult;
+}
+#endif
+
+#if !defined(OPENSSL_NO_COMP) && !defined(OPENSSL_NO_TLS1_3)
+static int cert_comp_msgs;
+
+static void cert_comp_msg_cb(int write_p, int version, int content_type,
+                             const void *buf, size_t len, SSL *ssl, void *arg)
+{
+    if (content_type == SSL3_RT_HANDSHAKE && len > 0
+            && ((const unsigned char *)buf)[0] == SSL3_MT_COMPRESSED_CERTIFICATE)
+        cert_comp_msgs++;
+}
+
+/*
+ * Test TLSv1.3 certificate compression
+ * Test 0: Both sides enable zlib, the server certificate is compressed
+ * Test 1: Only the server enables it
+ * Test 2: Only the client enables it
+ */
+static int test_cert_compression(int idx)
+{
+    SSL_CTX *cctx = NULL, *sctx = NULL;
+    SSL *clientssl = NULL, *serverssl = NULL;
+    X509 *peer = NULL;
+    const unsigned char *comp = NULL;
+    int i, testresult = 0;
+
+    if (COMP_get_type(COMP_zlib_oneshot()) == NID_undef) {
+        TEST_info("zlib is not available, skipping test");
+        return 1;
+    }
+
+    if (!TEST_true(create_ssl_ctx_pair(TLS_server_method(), TLS_client_method(),
+                                       TLS1_3_VERSION, TLS_MAX_VERSION,
+                                       &sctx, &cctx, cert, privkey)))
+        goto end;
+
+    if (idx != 2
+            && !TEST_true(SSL_CTX_add_cert_compression_alg(sctx,
+                                                        TLSEXT_comp_cert_zlib,
+                                                        COMP_zlib_oneshot())))
+        goto end;
+    if (idx != 1
+            && !TEST_true(SSL_CTX_add_cert_compression_alg(cctx,
+                                                        TLSEXT_comp_cert_zlib,
+                                                        COMP_zlib_oneshot())))
+        goto end;
+    if (!TEST_false(SSL_CTX_add_cert_compression_alg(cctx, 0,
+                                                     COMP_zlib_oneshot()))
+            || (idx != 1
+                && !TEST_false(SSL_CTX_add_cert_compression_alg(cctx,
+                                                    TLSEXT_comp_cert_zlib,
+                                                    COMP_zlib_oneshot()))))
+        goto end;
+    ERR_clear_error();
+
+    SSL_CTX_set_msg_callback(cctx, cert_comp_msg_cb);
+    cert_comp_msgs = 0;
+
+    /* Two connections, the second one uses the cached compressed chain */
+    for (i = 0; i < 2; i++) {
+        if (!TEST_true(create_ssl_objects(sctx, cctx, &serverssl, &clientssl,
+                                          NULL, NULL))
+                || !TEST_true(create_ssl_connection(serverssl, clientssl,
+                                                    SSL_ERROR_NONE))
+                || !TEST_ptr(peer = SSL_get_peer_certificate(clientssl))
+                || !TEST_int_eq(X509_cmp(peer, SSL_get_certificate(serverssl)),
+                                0))
+            goto end;
+        X509_free(peer);
+        peer = NULL;
+
+        if (idx == 0) {
+            if (i == 0) {
+                comp = sctx->cert_comp.cache[0].comp;
+                if (!TEST_ptr(comp)
+                        || !TEST_size_t_lt(sctx->cert_comp.cache[0].complen,
+                                           sctx->cert_comp.cache[0].rawlen))
+                    goto end;
+            } else if (!TEST_ptr_eq(sctx->cert_comp.cache[0].comp, comp)
+                       || !TEST_ptr_null(sctx->cert_comp.cache[1].comp)) {
+                goto end;
+            }
+        }
+
+        SSL_shutdown(clientssl);
+        SSL_shutdown(serverssl);
+        SSL_free(serverssl);
+        SSL_free(clientssl);
+        serverssl = clientssl = NULL;
+    }
+
+    if (!TEST_int_eq(cert_comp_msgs, idx == 0 ? 2 : 0))
+        goto end;
+
+    testresult = 1;
+
+ end:
+    X509_free(peer);
+    SSL_free(serverssl);
+    SSL_free(clientssl);
+    SSL_CTX_free(sctx);
+    SSL_CTX_free(cctx);
+
+    return testresult;
+}
+#endif
+
 /* Parse CH and retrieve any MFL extension value if present */
 static int get_MFL_from_client_hello(BIO *bio, int *mfl_codemfl_code)
 {
@@ -6577,6 +7215,20 @@ int setup_tests(void)
     ADD_ALL_TESTS(test_key_update_in_write, 2);
 #endif
     ADD_ALL_TESTS(test_ssl_clear, 2);
+    ADD_ALL_TESTS(test_peer_cert_cache, 2);
+#if !defined(OPENSSL_NO_SOCK) && !defined(OPENSSL_NO_TLS1_2) \
+    && defined(OPENSSL_SYS_UNIX) && !defined(OPENSSL_NO_POSIX_IO)
+    ADD_ALL_TESTS(test_sendfile, 3);
+#endif
+    ADD_ALL_TESTS(test_write_batch, 3);
+    ADD_ALL_TESTS(test_read_view, 2);
+    ADD_TEST(test_buffer_pool);
+#ifndef OPENSSL_NO_EC
+    ADD_ALL_TESTS(test_keyshare_pool, 2);
+#endif
+#if !defined(OPENSSL_NO_COMP) && !defined(OPENSSL_NO_TLS1_3)
+    ADD_ALL_TESTS(test_cert_compression, 3);
+#endif
     ADD_ALL_TESTS(test_max_fragment_len_ext, OSSL_NELEM(max_fragment_len_test));
 #if !defined(OPENSSL_NO_SRP) && !defined(OPENSSL_NO_TLS1_2)
     ADD_ALL_TESTS(test_srp, 6);
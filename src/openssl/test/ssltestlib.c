@@ -13,6 +13,7 @@
 #include "ssltestlib.h"
 #include "testutil.h"
 #include "e_os.h"
+#include "internal/sockets.h"
 
 #ifdef OPENSSL_SYS_UNIX
 # include <unistd.h>
@@ -822,6 +823,92 @@ int create_ssl_objects(SSL_CTX *serverctx, SSL_CTX *clientctx, SSL **sssl,
     return 0;
 }
 
+/*
+ * Create a connected pair of non-blocking TCP sockets on the loopback
+ * interface.  Returns 0 if sockets aren't available.
+ */
+int create_test_sockets(int *cfd, int *sfd)
+{
+#ifndef OPENSSL_NO_SOCK
+    BIO_ADDRINFO *res = NULL;
+    union BIO_sock_info_u info;
+    int afd = INVALID_SOCKET, ret = 0;
+
+    *cfd = *sfd = INVALID_SOCKET;
+    info.addr = NULL;
+
+    if (!TEST_true(BIO_lookup_ex("127.0.0.1", "0", BIO_LOOKUP_SERVER,
+                                 AF_INET, SOCK_STREAM, 0, &res))
+            || !TEST_int_ne(afd = BIO_socket(AF_INET, SOCK_STREAM, 0, 0),
+                            INVALID_SOCKET)
+            || !TEST_true(BIO_listen(afd, BIO_ADDRINFO_address(res), 0))
+            || !TEST_ptr(info.addr = BIO_ADDR_new())
+            || !TEST_true(BIO_sock_info(afd, BIO_SOCK_INFO_ADDRESS, &info))
+            || !TEST_int_ne(*cfd = BIO_socket(AF_INET, SOCK_STREAM, 0, 0),
+                            INVALID_SOCKET)
+            || !TEST_true(BIO_connect(*cfd, info.addr, BIO_SOCK_NODELAY))
+            || !TEST_int_ne(*sfd = BIO_accept_ex(afd, NULL, BIO_SOCK_NODELAY),
+                            INVALID_SOCKET)
+            || !TEST_true(BIO_socket_nbio(*cfd, 1))
+            || !TEST_true(BIO_socket_nbio(*sfd, 1)))
+        goto err;
+    ret = 1;
+
+ err:
+    if (!ret) {
+        if (*cfd != INVALID_SOCKET)
+            BIO_closesocket(*cfd);
+        if (*sfd != INVALID_SOCKET)
+            BIO_closesocket(*sfd);
+        *cfd = *sfd = INVALID_SOCKET;
+    }
+    if (afd != INVALID_SOCKET)
+        BIO_closesocket(afd);
+    BIO_ADDR_free(info.addr);
+    BIO_ADDRINFO_free(res);
+    return ret;
+#else
+    return 0;
+#endif
+}
+
+/*
+ * As create_ssl_objects() but attach the SSL objects to socket BIOs on
+ * |sfd| and |cfd|, which are closed when the SSL objects are freed.
+ */
+int create_ssl_objects2(SSL_CTX *serverctx, SSL_CTX *clientctx, SSL **sssl,
+                        SSL **cssl, int sfd, int cfd)
+{
+    SSL *serverssl = NULL, *clientssl = NULL;
+    BIO *s_bio = NULL, *c_bio = NULL;
+
+    if (*sssl != NULL)
+        serverssl = *sssl;
+    else if (!TEST_ptr(serverssl = SSL_new(serverctx)))
+        goto error;
+    if (*cssl != NULL)
+        clientssl = *cssl;
+    else if (!TEST_ptr(clientssl = SSL_new(clientctx)))
+        goto error;
+
+    if (!TEST_ptr(s_bio = BIO_new_socket(sfd, BIO_CLOSE))
+            || !TEST_ptr(c_bio = BIO_new_socket(cfd, BIO_CLOSE)))
+        goto error;
+
+    SSL_set_bio(serverssl, s_bio, s_bio);
+    SSL_set_bio(clientssl, c_bio, c_bio);
+    *sssl = serverssl;
+    *cssl = clientssl;
+    return 1;
+
+ error:
+    SSL_free(serverssl);
+    SSL_free(clientssl);
+    BIO_free(s_bio);
+    BIO_free(c_bio);
+    return 0;
+}
+
 /*
  * Create an SSL connection, but does not ready any post-handshake
  * NewSessionTicket messages.
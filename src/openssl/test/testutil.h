@@ -47,6 +47,12 @@
 /* Adds a simple test case. */
 # define ADD_TEST(test_function) add_test(#test_function, test_function)
 
+/*
+ * A test case returns TEST_SKIP_CODE, normally through TEST_skip(), if it
+ * cannot run in this environment.  It is reported as skipped, not failed.
+ */
+# define TEST_SKIP_CODE 123
+
 /*
  * Simple parameterized tests. Calls test_function(idx) for each 0 <= idx < num.
  */
@@ -274,6 +280,9 @@ void test_error_c90(const char *desc, ...) PRINTF_FORMAT(1, 2);
 void test_info(const char *file, int line, const char *desc, ...)
     PRINTF_FORMAT(3, 4);
 void test_info_c90(const char *desc, ...) PRINTF_FORMAT(1, 2);
+int test_skip(const char *file, int line, const char *desc, ...)
+    PRINTF_FORMAT(3, 4);
+int test_skip_c90(const char *desc, ...) PRINTF_FORMAT(1, 2);
 void test_note(const char *desc, ...) PRINTF_FORMAT(1, 2);
 void test_openssl_errors(void);
 void test_perror(const char *s);
@@ -381,13 +390,17 @@ void test_perror(const char *s);
 /*
  * TEST_error(desc, ...) prints an informative error message in the standard
  * format.  |desc| is a printf format string.
+ * TEST_skip(desc, ...) prints the reason why a test is skipped and returns
+ * TEST_SKIP_CODE.
  */
 # if !defined(__STDC_VERSION__) || __STDC_VERSION__ < 199901L
 #  define TEST_error         test_error_c90
 #  define TEST_info          test_info_c90
+#  define TEST_skip          test_skip_c90
 # else
 #  define TEST_error(...)    test_error(__FILE__, __LINE__, __VA_ARGS__)
 #  define TEST_info(...)     test_info(__FILE__, __LINE__, __VA_ARGS__)
+#  define TEST_skip(...)     test_skip(__FILE__, __LINE__, __VA_ARGS__)
 # endif
 # define TEST_note           test_note
 # define TEST_openssl_errors test_openssl_errors
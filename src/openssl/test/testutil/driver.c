@@ -165,6 +165,8 @@ PRINTF_FORMAT(2, 3) static void test_verdict(int pass, const char *extra, ...)
         test_vprintf_stdout(extra, ap);
         va_end(ap);
     }
+    if (pass == TEST_SKIP_CODE)
+        test_printf_stdout(" # skipped");
     test_printf_stdout("\n");
     test_flush_stdout();
 }
@@ -204,7 +206,7 @@ int run_tests(const char *test_prog_name)
             set_test_title(all_tests[i].test_case_name);
             ret = all_tests[i].test_fn();
 
-            verdict = 1;
+            verdict = ret == TEST_SKIP_CODE ? TEST_SKIP_CODE : 1;
             if (!ret) {
                 verdict = 0;
                 ++num_failed;
@@ -244,7 +246,7 @@ int run_tests(const char *test_prog_name)
                 finalize(ret);
 
                 if (all_tests[i].subtest) {
-                    verdict = 1;
+                    verdict = ret == TEST_SKIP_CODE ? TEST_SKIP_CODE : 1;
                     if (!ret) {
                         verdict = 0;
                         ++num_failed_inner;
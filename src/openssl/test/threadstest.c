@@ -12,6 +12,8 @@
 #endif
 
 #include <openssl/crypto.h>
+#include <openssl/rsa.h>
+#include <openssl/bn.h>
 #include "testutil.h"
 
 #if !defined(OPENSSL_THREADS) || defined(CRYPTO_TDEBUG)
@@ -184,10 +186,93 @@ static int test_thread_local(void)
     return 1;
 }
 
+#ifndef OPENSSL_NO_RSA
+/*
+ * Private key operations on a key shared between threads, each of which
+ * uses its own blinding.
+ */
+static RSA *shared_rsa = NULL;
+static int rsa_thread_ok = 0;
+
+static int rsa_sign_verify(void)
+{
+    static const unsigned char msg[] = "per-thread blinding";
+    unsigned char sig[128], dec[128];
+    int i, len;
+
+    for (i = 0; i < 40; i++) {
+        len = RSA_private_encrypt(sizeof(msg), msg, sig, shared_rsa,
+                                  RSA_PKCS1_PADDING);
+        if (!TEST_int_eq(len, RSA_size(shared_rsa)))
+            return 0;
+        len = RSA_public_decrypt(len, sig, dec, shared_rsa,
+                                 RSA_PKCS1_PADDING);
+        if (!TEST_mem_eq(dec, len, msg, sizeof(msg)))
+            return 0;
+    }
+    return 1;
+}
+
+static void rsa_thread_cb(void)
+{
+    rsa_thread_ok = rsa_sign_verify();
+    OPENSSL_thread_stop();
+}
+
+static int test_rsa_blinding(void)
+{
+    thread_t thread;
+    BIGNUM *e = NULL;
+    RSA *other = NULL;
+    int ret = 0;
+
+    if (!TEST_ptr(e = BN_new())
+            || !TEST_true(BN_set_word(e, RSA_F4))
+            || !TEST_ptr(shared_rsa = RSA_new())
+            || !TEST_true(RSA_generate_key_ex(shared_rsa, 1024, e, NULL)))
+        goto err;
+
+    if (!TEST_true(rsa_sign_verify())
+            || !TEST_true(run_thread(&thread, rsa_thread_cb))
+            || !TEST_true(rsa_sign_verify())
+            || !TEST_true(wait_for_thread(thread))
+            || !TEST_true(rsa_thread_ok))
+        goto err;
+
+    /* A new key, possibly at the same address, must not reuse blindings */
+    RSA_free(shared_rsa);
+    if (!TEST_ptr(shared_rsa = RSA_new())
+            || !TEST_true(RSA_generate_key_ex(shared_rsa, 1024, e, NULL))
+            || !TEST_true(rsa_sign_verify()))
+        goto err;
+
+    /* RSA_blinding_on() doesn't get in the way of per-thread blindings */
+    if (!TEST_ptr(other = RSAPrivateKey_dup(shared_rsa))
+            || !TEST_true(RSA_blinding_on(other, NULL)))
+        goto err;
+    RSA_free(shared_rsa);
+    shared_rsa = other;
+    other = NULL;
+    if (!TEST_true(rsa_sign_verify()))
+        goto err;
+
+    ret = 1;
+ err:
+    RSA_free(shared_rsa);
+    shared_rsa = NULL;
+    RSA_free(other);
+    BN_free(e);
+    return ret;
+}
+#endif
+
 int setup_tests(void)
 {
     ADD_TEST(test_lock);
     ADD_TEST(test_once);
     ADD_TEST(test_thread_local);
+#ifndef OPENSSL_NO_RSA
+    ADD_TEST(test_rsa_blinding);
+#endif
     return 1;
 }
@@ -0,0 +1,419 @@
+/*
+ * Copyright 2020 The OpenSSL Project Authors. All Rights Reserved.
+ *
+ * Licensed under the OpenSSL license (the "License").  You may not use
+ * this file except in compliance with the License.  You can obtain a copy
+ * in the file LICENSE in the source distribution or at
+ * https://www.openssl.org/source/license.html
+ */
+
+#include <string.h>
+#include <openssl/opensslconf.h>
+#include <openssl/async.h>
+#include <openssl/engine.h>
+#include <openssl/err.h>
+#include <openssl/rsa.h>
+#include <openssl/ec.h>
+#include <openssl/bn.h>
+#include <openssl/rand.h>
+#include <openssl/sha.h>
+#include "testutil.h"
+
+#if defined(OPENSSL_SYS_UNIX) && defined(OPENSSL_THREADS) \
+    && !defined(OPENSSL_NO_ENGINE)
+# include <sys/time.h>
+# include <sys/types.h>
+# include <unistd.h>
+
+# define NUM_JOBS    8
+# define MSG_LEN     32
+
+static ENGINE *e;
+
+typedef struct {
+    RSA *rsa;
+    EC_KEY *eckey;
+    EC_KEY *peer;
+    unsigned char msg[MSG_LEN];
+    unsigned char out[512];
+    unsigned int outlen;
+} TPOOL_TEST_ARGS;
+
+static int rsa_sign_job(void *arg)
+{
+    TPOOL_TEST_ARGS *args = *(TPOOL_TEST_ARGS **)arg;
+    int ret;
+
+    ret = RSA_private_encrypt(MSG_LEN, args->msg, args->out, args->rsa,
+                              RSA_PKCS1_PADDING);
+    if (ret <= 0)
+        return 0;
+    args->outlen = ret;
+    return 1;
+}
+
+/* An operation that fails in the worker, the error must reach the job */
+static int rsa_fail_job(void *arg)
+{
+    TPOOL_TEST_ARGS *args = *(TPOOL_TEST_ARGS **)arg;
+
+    ERR_clear_error();
+    if (RSA_private_encrypt(RSA_size(args->rsa) + 1, args->out, args->out,
+                            args->rsa, RSA_PKCS1_PADDING) > 0)
+        return 0;
+    return ERR_GET_LIB(ERR_peek_error()) == ERR_LIB_RSA;
+}
+
+# ifndef OPENSSL_NO_EC
+static int ecdsa_sign_job(void *arg)
+{
+    TPOOL_TEST_ARGS *args = *(TPOOL_TEST_ARGS **)arg;
+
+    return ECDSA_sign(0, args->msg, MSG_LEN, args->out, &args->outlen,
+                      args->eckey);
+}
+
+static int ecdh_job(void *arg)
+{
+    TPOOL_TEST_ARGS *args = *(TPOOL_TEST_ARGS **)arg;
+    int ret;
+
+    ret = ECDH_compute_key(args->out, sizeof(args->out),
+                           EC_KEY_get0_public_key(args->peer), args->eckey,
+                           NULL);
+    if (ret <= 0)
+        return 0;
+    args->outlen = ret;
+    return 1;
+}
+# endif
+
+/*
+ * Start NUM_JOBS jobs running |fn| at the same time and drive them to
+ * completion from this thread, waiting on their wait fds.  Every job must
+ * have been paused while a worker thread did the work.
+ */
+static int run_jobs(int (*fn)(void *), TPOOL_TEST_ARGS *args)
+{
+    ASYNC_JOB *jobs[NUM_JOBS];
+    ASYNC_WAIT_CTX *waitctxs[NUM_JOBS];
+    int rets[NUM_JOBS], running[NUM_JOBS];
+    TPOOL_TEST_ARGS *argp;
+    OSSL_ASYNC_FD fd, maxfd;
+    size_t numfds;
+    fd_set rfds;
+    struct timeval tv;
+    int i, pending = 0, res = 0;
+
+    memset(jobs, 0, sizeof(jobs));
+    memset(waitctxs, 0, sizeof(waitctxs));
+
+    for (i = 0; i < NUM_JOBS; i++) {
+        argp = &args[i];
+        if (!TEST_ptr(waitctxs[i] = ASYNC_WAIT_CTX_new())
+                || !TEST_int_eq(ASYNC_start_job(&jobs[i], waitctxs[i],
+                                                &rets[i], fn, &argp,
+                                                sizeof(argp)),
+                                ASYNC_PAUSE))
+            goto err;
+        running[i] = 1;
+        pending++;
+    }
+
+    while (pending > 0) {
+        FD_ZERO(&rfds);
+        maxfd = 0;
+        for (i = 0; i < NUM_JOBS; i++) {
+            if (!running[i])
+                continue;
+            if (!TEST_true(ASYNC_WAIT_CTX_get_all_fds(waitctxs[i], NULL,
+                                                      &numfds))
+                    || !TEST_size_t_eq(numfds, 1)
+                    || !TEST_true(ASYNC_WAIT_CTX_get_all_fds(waitctxs[i], &fd,
+                                                             &numfds)))
+                goto err;
+            FD_SET(fd, &rfds);
+            if (fd > maxfd)
+                maxfd = fd;
+        }
+        tv.tv_sec = 10;
+        tv.tv_usec = 0;
+        if (!TEST_int_gt(select(maxfd + 1, &rfds, NULL, NULL, &tv), 0))
+            goto err;
+        for (i = 0; i < NUM_JOBS; i++) {
+            if (!running[i])
+                continue;
+            ASYNC_WAIT_CTX_get_all_fds(waitctxs[i], &fd, &numfds);
+            if (!FD_ISSET(fd, &rfds))
+                continue;
+            switch (ASYNC_start_job(&jobs[i], waitctxs[i], &rets[i], fn,
+                                    NULL, 0)) {
+            case ASYNC_FINISH:
+                if (!TEST_int_eq(rets[i], 1))
+                    goto err;
+                running[i] = 0;
+                pending--;
+                break;
+            case ASYNC_PAUSE:
+                break;
+            default:
+                TEST_error("job %d failed", i);
+                goto err;
+            }
+        }
+    }
+    res = 1;
+
+ err:
+    for (i = 0; i < NUM_JOBS; i++)
+        ASYNC_WAIT_CTX_free(waitctxs[i]);
+    return res;
+}
+
+static int test_rsa_offload(void)
+{
+    TPOOL_TEST_ARGS *args = NULL;
+    RSA *rsa = NULL;
+    BIGNUM *bn = NULL;
+    unsigned char dec[512];
+    int i, testresult = 0;
+
+    if (!TEST_ptr(args = OPENSSL_zalloc(NUM_JOBS * sizeof(*args)))
+            || !TEST_ptr(bn = BN_new())
+            || !TEST_true(BN_set_word(bn, RSA_F4))
+            || !TEST_ptr(rsa = RSA_new_method(e))
+            || !TEST_true(RSA_generate_key_ex(rsa, 1024, bn, NULL)))
+        goto end;
+
+    for (i = 0; i < NUM_JOBS; i++) {
+        args[i].rsa = rsa;
+        memset(args[i].msg, 'a' + i, MSG_LEN);
+    }
+    if (!TEST_true(run_jobs(rsa_sign_job, args)))
+        goto end;
+    for (i = 0; i < NUM_JOBS; i++) {
+        if (!TEST_int_eq(RSA_public_decrypt(args[i].outlen, args[i].out, dec,
+                                            rsa, RSA_PKCS1_PADDING),
+                         MSG_LEN)
+                || !TEST_mem_eq(dec, MSG_LEN, args[i].msg, MSG_LEN))
+            goto end;
+    }
+
+    /* Errors raised on a worker thread are seen by the job */
+    if (!TEST_true(run_jobs(rsa_fail_job, args)))
+        goto end;
+
+    /* Outside of a job the operation is done inline */
+    if (!TEST_int_eq(RSA_private_encrypt(MSG_LEN, args[0].msg, args[0].out,
+                                         rsa, RSA_PKCS1_PADDING),
+                     RSA_size(rsa)))
+        goto end;
+
+    testresult = 1;
+
+ end:
+    RSA_free(rsa);
+    BN_free(bn);
+    OPENSSL_free(args);
+    return testresult;
+}
+
+/* A predictable RNG, so that key generation can be repeated */
+static unsigned int fake_rand_counter;
+
+static int fake_rand_bytes(unsigned char *buf, int num)
+{
+    unsigned char in[4], md[SHA256_DIGEST_LENGTH];
+    int n;
+
+    for (; num > 0; num -= n, buf += n) {
+        in[0] = (unsigned char)(fake_rand_counter >> 24);
+        in[1] = (unsigned char)(fake_rand_counter >> 16);
+        in[2] = (unsigned char)(fake_rand_counter >> 8);
+        in[3] = (unsigned char)fake_rand_counter++;
+        SHA256(in, sizeof(in), md);
+        n = num < (int)sizeof(md) ? num : (int)sizeof(md);
+        memcpy(buf, md, n);
+    }
+    return 1;
+}
+
+static int fake_rand_status(void)
+{
+    return 1;
+}
+
+static RAND_METHOD fake_rand = {
+    NULL,
+    fake_rand_bytes,
+    NULL,
+    NULL,
+    fake_rand_bytes,
+    fake_rand_status
+};
+
+static RSA *keygen_seeded(int bits, const BIGNUM *bn)
+{
+    const RAND_METHOD *meth = RAND_get_rand_method();
+    RSA *rsa = NULL;
+
+    fake_rand_counter = 0;
+    if (!TEST_true(RAND_set_rand_method(&fake_rand)))
+        return NULL;
+    if (!TEST_ptr(rsa = RSA_new_method(e))
+            || !TEST_true(RSA_generate_key_ex(rsa, bits, (BIGNUM *)bn, NULL))) {
+        RSA_free(rsa);
+        rsa = NULL;
+    }
+    RAND_set_rand_method(meth);
+    return rsa;
+}
+
+/*
+ * The primes are searched for on the workers, and a given RNG output always
+ * gives the same key
+ */
+static int test_rsa_keygen(void)
+{
+    RSA *rsa1 = NULL, *rsa2 = NULL, *rsa3 = NULL;
+    BIGNUM *bn = NULL;
+    const BIGNUM *n1, *n2, *d1, *d2;
+    int testresult = 0;
+
+    if (!TEST_ptr(bn = BN_new())
+            || !TEST_true(BN_set_word(bn, RSA_F4))
+            || !TEST_ptr(rsa1 = keygen_seeded(1024, bn))
+            || !TEST_ptr(rsa2 = keygen_seeded(1024, bn))
+            || !TEST_int_eq(RSA_check_key(rsa1), 1)
+            || !TEST_int_eq(RSA_bits(rsa1), 1024))
+        goto end;
+    RSA_get0_key(rsa1, &n1, NULL, &d1);
+    RSA_get0_key(rsa2, &n2, NULL, &d2);
+    if (!TEST_BN_eq(n1, n2) || !TEST_BN_eq(d1, d2))
+        goto end;
+
+    /* Without a predictable RNG the keys differ */
+    if (!TEST_ptr(rsa3 = RSA_new_method(e))
+            || !TEST_true(RSA_generate_key_ex(rsa3, 1024, bn, NULL))
+            || !TEST_int_eq(RSA_check_key(rsa3), 1))
+        goto end;
+    RSA_get0_key(rsa3, &n2, NULL, NULL);
+    if (!TEST_BN_ne(n1, n2))
+        goto end;
+
+    /* Keys with more primes are left to the builtin key generation */
+    RSA_free(rsa3);
+    if (!TEST_ptr(rsa3 = RSA_new_method(e))
+            || !TEST_true(RSA_generate_multi_prime_key(rsa3, 1024, 3, bn,
+                                                       NULL))
+            || !TEST_int_eq(RSA_get_multi_prime_extra_count(rsa3), 1)
+            || !TEST_int_eq(RSA_check_key(rsa3), 1)
+            || !TEST_ptr_eq(RSA_get0_engine(rsa3), e))
+        goto end;
+
+    /* Too small keys are refused */
+    RSA_free(rsa3);
+    if (!TEST_ptr(rsa3 = RSA_new_method(e))
+            || !TEST_false(RSA_generate_key_ex(rsa3, 256, bn, NULL)))
+        goto end;
+
+    testresult = 1;
+
+ end:
+    RSA_free(rsa1);
+    RSA_free(rsa2);
+    RSA_free(rsa3);
+    BN_free(bn);
+    return testresult;
+}
+
+# ifndef OPENSSL_NO_EC
+static int test_ec_offload(void)
+{
+    TPOOL_TEST_ARGS *args = NULL;
+    EC_KEY *eckey = NULL, *peer = NULL;
+    EC_GROUP *group = NULL;
+    unsigned char secret[128];
+    int i, secretlen, testresult = 0;
+
+    if (!TEST_ptr(args = OPENSSL_zalloc(NUM_JOBS * sizeof(*args)))
+            || !TEST_ptr(group =
+                         EC_GROUP_new_by_curve_name(NID_X9_62_prime256v1))
+            || !TEST_ptr(eckey = EC_KEY_new_method(e))
+            || !TEST_true(EC_KEY_set_group(eckey, group))
+            || !TEST_true(EC_KEY_generate_key(eckey))
+            || !TEST_ptr(peer = EC_KEY_new_by_curve_name(NID_X9_62_prime256v1))
+            || !TEST_true(EC_KEY_generate_key(peer)))
+        goto end;
+
+    for (i = 0; i < NUM_JOBS; i++) {
+        args[i].eckey = eckey;
+        args[i].peer = peer;
+        memset(args[i].msg, 'a' + i, MSG_LEN);
+    }
+    if (!TEST_true(run_jobs(ecdsa_sign_job, args)))
+        goto end;
+    for (i = 0; i < NUM_JOBS; i++) {
+        if (!TEST_int_eq(ECDSA_verify(0, args[i].msg, MSG_LEN, args[i].out,
+                                      args[i].outlen, eckey), 1))
+            goto end;
+    }
+
+    if (!TEST_true(run_jobs(ecdh_job, args))
+            || !TEST_int_gt(secretlen = ECDH_compute_key(secret,
+                                sizeof(secret), EC_KEY_get0_public_key(eckey),
+                                peer, NULL), 0))
+        goto end;
+    for (i = 0; i < NUM_JOBS; i++) {
+        if (!TEST_mem_eq(args[i].out, args[i].outlen, secret, secretlen))
+            goto end;
+    }
+
+    testresult = 1;
+
+ end:
+    EC_KEY_free(eckey);
+    EC_KEY_free(peer);
+    EC_GROUP_free(group);
+    OPENSSL_free(args);
+    return testresult;
+}
+# endif
+#endif
+
+int setup_tests(void)
+{
+#if defined(OPENSSL_SYS_UNIX) && defined(OPENSSL_THREADS) \
+    && !defined(OPENSSL_NO_ENGINE)
+    if (!ASYNC_is_capable()) {
+        TEST_info("ASYNC is not supported on this platform");
+        return 1;
+    }
+    ENGINE_load_builtin_engines();
+    if ((e = ENGINE_by_id("tpool")) == NULL) {
+        /* Probably a platform env issue, not a test failure. */
+        TEST_info("Can't load tpool engine");
+        return 1;
+    }
+    if (!TEST_true(ENGINE_ctrl_cmd_string(e, "THREADS", "2", 0))
+            || !TEST_true(ENGINE_init(e)))
+        return 0;
+
+    ADD_TEST(test_rsa_offload);
+    ADD_TEST(test_rsa_keygen);
+# ifndef OPENSSL_NO_EC
+    ADD_TEST(test_ec_offload);
+# endif
+#endif
+    return 1;
+}
+
+#if defined(OPENSSL_SYS_UNIX) && defined(OPENSSL_THREADS) \
+    && !defined(OPENSSL_NO_ENGINE)
+void cleanup_tests(void)
+{
+    if (e != NULL)
+        ENGINE_finish(e);
+    ENGINE_free(e);
+}
+#endif
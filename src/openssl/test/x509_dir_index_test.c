@@ -0,0 +1,111 @@
+/*
+ * Copyright 2020 The OpenSSL Project Authors. All Rights Reserved.
+ *
+ * Licensed under the OpenSSL license (the "License").  You may not use
+ * this file except in compliance with the License.  You can obtain a copy
+ * in the file LICENSE in the source distribution or at
+ * https://www.openssl.org/source/license.html
+ */
+
+#include <stdio.h>
+#include <openssl/bio.h>
+#include <openssl/err.h>
+#include <openssl/pem.h>
+#include <openssl/x509_vfy.h>
+
+#include "testutil.h"
+
+static const char *certdir;
+static const char *indexed_f;
+static const char *added_f;
+
+static X509 *load_cert(const char *file)
+{
+    BIO *bio = NULL;
+    X509 *x = NULL;
+
+    if (TEST_ptr(bio = BIO_new_file(file, "r")))
+        x = PEM_read_bio_X509(bio, NULL, NULL, NULL);
+    BIO_free(bio);
+    return x;
+}
+
+static int write_hashed_cert(X509 *x)
+{
+    char path[4096];
+    BIO *bio = NULL;
+    int ret = 0;
+
+    BIO_snprintf(path, sizeof(path), "%s/%08lx.0", certdir,
+                 X509_NAME_hash(X509_get_subject_name(x)));
+    if (TEST_ptr(bio = BIO_new_file(path, "w"))
+        && TEST_true(PEM_write_bio_X509(bio, x)))
+        ret = 1;
+    BIO_free(bio);
+    return ret;
+}
+
+static int lookup_subject(X509_LOOKUP *lookup, X509 *x)
+{
+    X509_OBJECT *obj = X509_OBJECT_new();
+    int ret;
+
+    if (obj == NULL)
+        return -1;
+    ret = X509_LOOKUP_by_subject(lookup, X509_LU_X509,
+                                 X509_get_subject_name(x), obj);
+    /* The returned object is borrowed from the store */
+    if (ret > 0)
+        X509_OBJECT_up_ref_count(obj);
+    X509_OBJECT_free(obj);
+    return ret;
+}
+
+/*
+ * With indexing enabled and automatic refresh disabled, a certificate added
+ * to the directory stays invisible until the index is explicitly rebuilt.
+ */
+static int test_dir_index(void)
+{
+    int ret = 0;
+    X509_STORE *store = NULL;
+    X509_LOOKUP *lookup = NULL;
+    X509 *indexed = NULL, *added = NULL;
+
+    if (!TEST_ptr(indexed = load_cert(indexed_f))
+        || !TEST_ptr(added = load_cert(added_f))
+        || !TEST_ptr(store = X509_STORE_new())
+        || !TEST_ptr(lookup = X509_STORE_add_lookup(store,
+                                                    X509_LOOKUP_hash_dir()))
+        || !TEST_true(X509_LOOKUP_add_dir(lookup, certdir, X509_FILETYPE_PEM))
+        || !TEST_true(X509_LOOKUP_set_dir_index(lookup, -1)))
+        goto err;
+
+    if (!TEST_int_eq(lookup_subject(lookup, indexed), 1)
+        || !TEST_int_eq(lookup_subject(lookup, added), 0)
+        || !write_hashed_cert(added)
+        || !TEST_int_eq(lookup_subject(lookup, added), 0)
+        || !TEST_true(X509_LOOKUP_set_dir_index(lookup, -1))
+        || !TEST_int_eq(lookup_subject(lookup, added), 1))
+        goto err;
+
+    ret = 1;
+ err:
+    X509_STORE_free(store);
+    X509_free(indexed);
+    X509_free(added);
+    return ret;
+}
+
+int setup_tests(void)
+{
+    if (!TEST_ptr(certdir = test_get_argument(0))
+        || !TEST_ptr(indexed_f = test_get_argument(1))
+        || !TEST_ptr(added_f = test_get_argument(2))) {
+        TEST_note("usage: x509_dir_index_test certdir indexed.pem added.pem");
+        return 0;
+    }
+
+    ADD_TEST(test_dir_index);
+    return 1;
+}
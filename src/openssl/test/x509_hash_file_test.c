@@ -0,0 +1,165 @@
+/*
+ * Copyright 2020 The OpenSSL Project Authors. All Rights Reserved.
+ *
+ * Licensed under the OpenSSL license (the "License").  You may not use
+ * this file except in compliance with the License.  You can obtain a copy
+ * in the file LICENSE in the source distribution or at
+ * https://www.openssl.org/source/license.html
+ */
+
+#include <stdio.h>
+#include <openssl/bio.h>
+#include <openssl/err.h>
+#include <openssl/pem.h>
+#include <openssl/x509_vfy.h>
+
+#include "testutil.h"
+
+static const char *hashfile_f;
+static const char *roots_f;
+static const char *ca_f;
+static const char *ee_f;
+static const char *tmp_f;
+
+static X509 *load_cert(const char *file)
+{
+    BIO *bio = NULL;
+    X509 *x = NULL;
+
+    if (TEST_ptr(bio = BIO_new_file(file, "r")))
+        x = PEM_read_bio_X509(bio, NULL, NULL, NULL);
+    BIO_free(bio);
+    return x;
+}
+
+static X509_STORE *new_hash_file_store(const char *file)
+{
+    X509_STORE *store = NULL;
+    X509_LOOKUP *lookup = NULL;
+
+    if (!TEST_ptr(store = X509_STORE_new())
+        || !TEST_ptr(lookup = X509_STORE_add_lookup(store,
+                                                    X509_LOOKUP_hash_file()))
+        || !TEST_true(X509_LOOKUP_load_file(lookup, file,
+                                            X509_FILETYPE_ASN1))) {
+        X509_STORE_free(store);
+        return NULL;
+    }
+    return store;
+}
+
+static int lookup_subject(X509_STORE *store, X509 *x)
+{
+    X509_STORE_CTX *ctx = X509_STORE_CTX_new();
+    X509_OBJECT *obj = NULL;
+    int ret = 0;
+
+    if (ctx != NULL && X509_STORE_CTX_init(ctx, store, NULL, NULL)) {
+        obj = X509_STORE_CTX_get_obj_by_subject(ctx, X509_LU_X509,
+                                                X509_get_subject_name(x));
+        ret = obj != NULL;
+    }
+    X509_OBJECT_free(obj);
+    X509_STORE_CTX_free(ctx);
+    return ret;
+}
+
+/* Verify a chain against a file written by "openssl hashfile" */
+static int test_verify_chain(void)
+{
+    int ret = 0;
+    X509_STORE *store = NULL;
+    X509_STORE_CTX *ctx = NULL;
+    STACK_OF(X509) *untrusted = NULL;
+    X509 *ca = NULL, *ee = NULL;
+
+    if (!TEST_ptr(store = new_hash_file_store(hashfile_f))
+        || !TEST_ptr(ca = load_cert(ca_f))
+        || !TEST_ptr(ee = load_cert(ee_f))
+        || !TEST_ptr(untrusted = sk_X509_new_null())
+        || !TEST_true(sk_X509_push(untrusted, ca))
+        || !TEST_ptr(ctx = X509_STORE_CTX_new())
+        || !TEST_true(X509_STORE_CTX_init(ctx, store, ee, untrusted))
+        || !TEST_int_eq(X509_verify_cert(ctx), 1))
+        goto err;
+    ret = 1;
+ err:
+    X509_STORE_CTX_free(ctx);
+    sk_X509_free(untrusted);
+    X509_free(ca);
+    X509_free(ee);
+    X509_STORE_free(store);
+    return ret;
+}
+
+/* Round trip through X509_hash_file_write_bio() */
+static int test_write_lookup(void)
+{
+    int ret = 0;
+    X509_STORE *store = NULL;
+    STACK_OF(X509) *certs = NULL;
+    BIO *bio = NULL;
+    X509 *root = NULL, *ca = NULL, *ee = NULL;
+
+    if (!TEST_ptr(root = load_cert(roots_f))
+        || !TEST_ptr(ca = load_cert(ca_f))
+        || !TEST_ptr(ee = load_cert(ee_f))
+        || !TEST_ptr(certs = sk_X509_new_null())
+        || !TEST_true(sk_X509_push(certs, ca))
+        || !TEST_true(sk_X509_push(certs, root))
+        || !TEST_ptr(bio = BIO_new_file(tmp_f, "wb"))
+        || !TEST_true(X509_hash_file_write_bio(bio, certs)))
+        goto err;
+    BIO_free(bio);
+    bio = NULL;
+
+    if (!TEST_ptr(store = new_hash_file_store(tmp_f))
+        || !TEST_true(lookup_subject(store, root))
+        || !TEST_true(lookup_subject(store, ca))
+        || !TEST_false(lookup_subject(store, ee)))
+        goto err;
+    ret = 1;
+ err:
+    BIO_free(bio);
+    sk_X509_free(certs);
+    X509_free(root);
+    X509_free(ca);
+    X509_free(ee);
+    X509_STORE_free(store);
+    return ret;
+}
+
+static int test_bad_file(void)
+{
+    X509_STORE *store = NULL;
+    X509_LOOKUP *lookup = NULL;
+    int ret = 0;
+
+    if (TEST_ptr(store = X509_STORE_new())
+        && TEST_ptr(lookup = X509_STORE_add_lookup(store,
+                                                   X509_LOOKUP_hash_file()))
+        && TEST_false(X509_LOOKUP_load_file(lookup, roots_f,
+                                            X509_FILETYPE_ASN1)))
+        ret = 1;
+    ERR_clear_error();
+    X509_STORE_free(store);
+    return ret;
+}
+
+int setup_tests(void)
+{
+    if (!TEST_ptr(hashfile_f = test_get_argument(0))
+        || !TEST_ptr(roots_f = test_get_argument(1))
+        || !TEST_ptr(ca_f = test_get_argument(2))
+        || !TEST_ptr(ee_f = test_get_argument(3))
+        || !TEST_ptr(tmp_f = test_get_argument(4))) {
+        TEST_note("usage: x509_hash_file_test hashfile roots.pem ca.pem"
+                  " ee.pem tmpfile");
+        return 0;
+    }
+
+    ADD_TEST(test_verify_chain);
+    ADD_TEST(test_write_lookup);
+    ADD_TEST(test_bad_file);
+    return 1;
+}